@@ -4,7 +4,7 @@ import { Input } from "components/ui/input";
 import { Slider } from "components/ui/slider";
 import { Checkbox } from "components/ui/checkbox";
 import { Label } from "components/ui/label";
-import { NativeComponent } from "./native";
+import { NativeComponent, post, sharedBlock } from "./native";
 
 export default function App() {
   const [rotationX, setRotationX] = useState(0);
@@ -13,8 +13,10 @@ export default function App() {
 
   const updateRotation = (x: number, y: number, z: number) => {
     if (window.native) {
-      window.native.setRotation(x, y, z);
-      window.native.print(`Rotated to ${x}, ${y}, ${z}`);
+      const rotation = sharedBlock("rotation");
+      if (rotation) rotation.write({ x, y, z });
+      else post("setRotation", x, y, z);
+      post("print", `Rotated to ${x}, ${y}, ${z}`);
     }
   };
 
@@ -34,7 +36,7 @@ export default function App() {
   };
 
   const resetRotation = () => {
-    if (window.native) window.native.print("Reset rotation");
+    if (window.native) post("print", "Reset rotation");
     setRotationX(0);
     setRotationY(0);
     setRotationZ(0);
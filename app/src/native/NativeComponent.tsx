@@ -1,4 +1,5 @@
-import React, { useRef, useEffect, useCallback } from "react";
+import React, { useRef, useEffect } from "react";
+import { trackSlot } from "./slots";
 
 interface NativeComponentProps {
   name: string;
@@ -10,34 +11,12 @@ interface NativeComponentProps {
 export default function NativeComponent({ name, className, style, children }: NativeComponentProps) {
   const ref = useRef<HTMLDivElement>(null);
 
-  const updateSlot = useCallback(() => {
-    if (ref.current && window.native) {
-      const rect = ref.current.getBoundingClientRect();
-      window.native.setComponentSlot(
-        name,
-        rect.left,
-        rect.top,
-        rect.width,
-        rect.height,
-        true
-      );
-    }
-  }, [name]);
-
+  // The slot follows the element through resizes, scrolling and layout
+  // changes, reported only when its rect actually moves
   useEffect(() => {
-    updateSlot();
-
-    window.addEventListener("resize", updateSlot);
-    const interval = setInterval(updateSlot, 100);
-
-    return () => {
-      window.removeEventListener("resize", updateSlot);
-      clearInterval(interval);
-      
-      if (window.native)
-        window.native.setComponentSlot(name, 0, 0, 0, 0, false);
-    };
-  }, [name, updateSlot]);
+    if (!ref.current) return;
+    return trackSlot(name, ref.current);
+  }, [name]);
 
   return (
     <div ref={ref} className={className} style={style}>
@@ -50,4 +29,3 @@ export default function NativeComponent({ name, className, style, children }: Na
     </div>
   );
 }
-
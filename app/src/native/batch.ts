@@ -0,0 +1,156 @@
+// Batched bridge calls. Commands are encoded into one buffer and sent to
+// native with a single window.native.__batch call per animation frame,
+// instead of one JS -> C++ transition each. The wire format is documented
+// on JSBridge::BindToContext.
+//
+// Batched commands run in order with each other, but after any direct
+// window.native calls made during the same frame. In threaded mode,
+// functions native runs on the main thread go in one task after the batch,
+// so they follow the batch's JS-thread functions (those returning a value)
+// even when queued before them.
+
+export type BatchArg = null | undefined | boolean | number | string;
+
+interface BatchHost {
+  __functions?: Record<string, number>;
+  __batch(bytes: Uint8Array): unknown[] | undefined;
+}
+
+const TAG_NULL = 0;
+const TAG_FALSE = 1;
+const TAG_TRUE = 2;
+const TAG_INT32 = 3;
+const TAG_FLOAT64 = 4;
+const TAG_STRING = 5;
+
+let buffer = new ArrayBuffer(4096);
+let view = new DataView(buffer);
+let bytes = new Uint8Array(buffer);
+let offset = 4;
+let count = 0;
+let scheduled = false;
+let waiting: Array<{ index: number; resolve: (value: unknown) => void }> = [];
+
+function reserve(size: number) {
+  if (offset + size <= buffer.byteLength) return;
+
+  let capacity = buffer.byteLength * 2;
+  while (capacity < offset + size) capacity *= 2;
+  const grown = new ArrayBuffer(capacity);
+  new Uint8Array(grown).set(bytes.subarray(0, offset));
+  buffer = grown;
+  view = new DataView(buffer);
+  bytes = new Uint8Array(buffer);
+}
+
+function writeString(value: string) {
+  // UTF-16 code units expand to at most 3 UTF-8 bytes
+  reserve(4 + value.length * 3);
+  const start = offset + 4;
+  let at = start;
+  for (let i = 0; i < value.length; i++) {
+    let code = value.charCodeAt(i);
+    if (code >= 0xd800 && code < 0xdc00 && i + 1 < value.length) {
+      const low = value.charCodeAt(i + 1);
+      if (low >= 0xdc00 && low < 0xe000) {
+        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+        i++;
+      }
+    }
+
+    if (code < 0x80) {
+      bytes[at++] = code;
+    } else if (code < 0x800) {
+      bytes[at++] = 0xc0 | (code >> 6);
+      bytes[at++] = 0x80 | (code & 0x3f);
+    } else if (code < 0x10000) {
+      bytes[at++] = 0xe0 | (code >> 12);
+      bytes[at++] = 0x80 | ((code >> 6) & 0x3f);
+      bytes[at++] = 0x80 | (code & 0x3f);
+    } else {
+      bytes[at++] = 0xf0 | (code >> 18);
+      bytes[at++] = 0x80 | ((code >> 12) & 0x3f);
+      bytes[at++] = 0x80 | ((code >> 6) & 0x3f);
+      bytes[at++] = 0x80 | (code & 0x3f);
+    }
+  }
+  view.setUint32(offset, at - start, true);
+  offset = at;
+}
+
+function writeArg(arg: BatchArg) {
+  // Tag plus the widest fixed payload; strings reserve their own space
+  reserve(9);
+  if (typeof arg === "string") {
+    bytes[offset++] = TAG_STRING;
+    writeString(arg);
+  } else if (typeof arg === "number") {
+    if ((arg | 0) === arg && !(arg === 0 && 1 / arg < 0)) {
+      bytes[offset++] = TAG_INT32;
+      view.setInt32(offset, arg, true);
+      offset += 4;
+    } else {
+      bytes[offset++] = TAG_FLOAT64;
+      view.setFloat64(offset, arg, true);
+      offset += 8;
+    }
+  } else if (typeof arg === "boolean") {
+    bytes[offset++] = arg ? TAG_TRUE : TAG_FALSE;
+  } else {
+    bytes[offset++] = TAG_NULL;
+  }
+}
+
+// Returns the command's index in the batch, or -1 if the function can't be
+// batched.
+function enqueue(name: string, args: BatchArg[]): number {
+  const host = window.native as unknown as BatchHost | undefined;
+  const ids = host && host.__functions;
+  const id = ids ? ids[name] : undefined;
+  if (id === undefined || args.length > 255) return -1;
+
+  reserve(3);
+  view.setUint16(offset, id, true);
+  bytes[offset + 2] = args.length;
+  offset += 3;
+  for (const arg of args) writeArg(arg);
+
+  if (!scheduled) {
+    scheduled = true;
+    requestAnimationFrame(flush);
+  }
+  return count++;
+}
+
+// Queues a call whose result isn't needed.
+export function post(name: string, ...args: BatchArg[]): void {
+  if (enqueue(name, args) < 0 && window.native && window.native[name])
+    window.native[name](...args);
+}
+
+// Queues a call and resolves with its result once the batch has run.
+// Resolves undefined when native runs calls off the JS thread, except for
+// async functions, which settle with their own result.
+export function call(name: string, ...args: BatchArg[]): Promise<unknown> {
+  return new Promise((resolve) => {
+    const index = enqueue(name, args);
+    if (index >= 0) waiting.push({ index, resolve });
+    else resolve(window.native && window.native[name] ? window.native[name](...args) : undefined);
+  });
+}
+
+// Sends everything queued so far. Runs automatically once per frame.
+export function flush(): void {
+  scheduled = false;
+  if (count === 0) return;
+
+  view.setUint32(0, count, true);
+  const host = window.native as unknown as BatchHost;
+  const results = host.__batch(new Uint8Array(buffer, 0, offset));
+
+  const resolved = waiting;
+  waiting = [];
+  offset = 4;
+  count = 0;
+  for (const entry of resolved) entry.resolve(results ? results[entry.index] : undefined);
+}
@@ -0,0 +1,17 @@
+// Generated by JSBridge::WriteTypeScript from the functions registered at
+// startup. Do not edit; regenerate with the bridge-types build target.
+
+export interface NativeFunctions {
+  acquireComponentSlot(name: string): number;
+  updateComponentSlots(slots: Float32Array): boolean;
+  switchRoute(route: string): boolean;
+  setRotation(x: number, y: number, z: number): void;
+  setPrimitive(type: "cube" | "pyramid" | "cylinder" | "cone"): void;
+  setGeometry(vertices: Float32Array, indices: Uint32Array): boolean;
+  print(message: string): void;
+  readAsset(path: string): Promise<Uint8Array>;
+}
+
+export interface SharedBlocks {
+  rotation: { x: number; y: number; z: number; };
+}
@@ -0,0 +1,48 @@
+// Events pushed from native. JSBridge::EmitEvent queues them and they arrive
+// once per update, already coalesced, in a single window.native.__listen
+// callback that is fanned out here to the handlers registered with on().
+
+export interface NativeEvent {
+  type: string;
+  key: string;
+  detail: unknown;
+}
+
+interface EventHost {
+  __listen?(listener: ((events: NativeEvent[]) => void) | null): void;
+}
+
+type Handler = (detail: any, key: string) => void;
+
+const handlers = new Map<string, Set<Handler>>();
+let listening = false;
+
+function dispatch(events: NativeEvent[]) {
+  for (const event of events) {
+    const set = handlers.get(event.type);
+    if (!set) continue;
+    for (const handler of Array.from(set)) handler(event.detail, event.key);
+  }
+}
+
+// Calls the handler for every native event of this type. Returns a function
+// that removes it.
+export function on(type: string, handler: Handler): () => void {
+  const host = window.native as unknown as EventHost | undefined;
+  if (!listening && host && host.__listen) {
+    host.__listen(dispatch);
+    listening = true;
+  }
+
+  let set = handlers.get(type);
+  if (!set) {
+    set = new Set();
+    handlers.set(type, set);
+  }
+  set.add(handler);
+
+  return () => {
+    set!.delete(handler);
+    if (set!.size === 0) handlers.delete(type);
+  };
+}
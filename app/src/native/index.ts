@@ -1,2 +1,9 @@
 export { default as NativeComponent } from "./NativeComponent";
 export type { PrimitiveType } from "./types";
+export { post, call, flush } from "./batch";
+export type { BatchArg } from "./batch";
+export { on } from "./events";
+export type { NativeEvent } from "./events";
+export { sharedBlock } from "./shared";
+export type { SharedBlock } from "./shared";
+export { trackSlot } from "./slots";
@@ -0,0 +1,79 @@
+// Shared blocks: native memory exposed as an ArrayBuffer under
+// window.native.__shared, written with plain stores instead of bridge calls.
+// Native polls each block once per frame, so only the latest values matter.
+//
+// Every write bumps the sequence counter at offset 0 to odd before touching
+// the fields and back to even after; native skips or retries reads that
+// overlap a write (see SharedBlock.h). Fields are little-endian.
+
+import type { SharedBlocks } from "./bridge";
+
+type FieldType = "f32" | "f64" | "i32" | "u32";
+
+interface BlockLayout {
+  buffer: ArrayBuffer;
+  fields: Record<string, { offset: number; type: FieldType }>;
+}
+
+interface SharedHost {
+  __shared?: Record<string, BlockLayout>;
+}
+
+export interface SharedBlock<T> {
+  // Writes the given fields as one update; the rest keep their values.
+  write(values: Partial<T>): void;
+  read(): T;
+}
+
+function setField(view: DataView, offset: number, type: FieldType, value: number) {
+  switch (type) {
+    case "f32": view.setFloat32(offset, value, true); break;
+    case "f64": view.setFloat64(offset, value, true); break;
+    case "i32": view.setInt32(offset, value, true); break;
+    case "u32": view.setUint32(offset, value, true); break;
+  }
+}
+
+function getField(view: DataView, offset: number, type: FieldType): number {
+  switch (type) {
+    case "f32": return view.getFloat32(offset, true);
+    case "f64": return view.getFloat64(offset, true);
+    case "i32": return view.getInt32(offset, true);
+    case "u32": return view.getUint32(offset, true);
+  }
+}
+
+const blocks = new Map<string, SharedBlock<any>>();
+
+// The named block, or null if native didn't create it.
+export function sharedBlock<K extends keyof SharedBlocks>(name: K): SharedBlock<SharedBlocks[K]> | null {
+  const cached = blocks.get(name);
+  if (cached) return cached;
+
+  const host = window.native as unknown as SharedHost | undefined;
+  const layout = host && host.__shared ? host.__shared[name] : undefined;
+  if (!layout) return null;
+
+  const view = new DataView(layout.buffer);
+  const sequence = new Int32Array(layout.buffer, 0, 1);
+  const block: SharedBlock<SharedBlocks[K]> = {
+    write(values) {
+      Atomics.add(sequence, 0, 1);
+      for (const key in values) {
+        const field = layout.fields[key];
+        if (field) setField(view, field.offset, field.type, Number(values[key]));
+      }
+      Atomics.add(sequence, 0, 1);
+    },
+    read() {
+      const values: Record<string, number> = {};
+      for (const key in layout.fields) {
+        const field = layout.fields[key];
+        values[key] = getField(view, field.offset, field.type);
+      }
+      return values as SharedBlocks[K];
+    },
+  };
+  blocks.set(name, block);
+  return block;
+}
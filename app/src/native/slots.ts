@@ -0,0 +1,92 @@
+// Component slots: where each NativeComponent sits in the view. Rects are
+// measured only after something that can move them (a resize, a scroll in
+// any container, a DOM change), at most once per animation frame, and only
+// the ones that changed are sent, in a single updateComponentSlots call.
+// Native runs that call on the page's thread, so the rects are attached to
+// the frame being painted and the component composites in step with it.
+
+import { on } from "./events";
+
+interface SlotHost {
+  acquireComponentSlot?(name: string): number;
+  updateComponentSlots?(slots: Float32Array): boolean;
+}
+
+interface TrackedSlot {
+  handle: number;
+  element: Element;
+  rect: { left: number; top: number; width: number; height: number } | null;
+}
+
+// Values per slot in an update: handle, x, y, width, height, visible
+const SLOT_STRIDE = 6;
+
+const tracked = new Set<TrackedSlot>();
+let scheduled = false;
+let observing = false;
+let resizeObserver: ResizeObserver | null = null;
+
+function host(): SlotHost | undefined {
+  return window.native as unknown as SlotHost | undefined;
+}
+
+function measure() {
+  scheduled = false;
+  const native = host();
+  if (!native || !native.updateComponentSlots) return;
+
+  const changes: number[] = [];
+  tracked.forEach((slot) => {
+    const rect = slot.element.getBoundingClientRect();
+    const last = slot.rect;
+    if (last && last.left === rect.left && last.top === rect.top &&
+        last.width === rect.width && last.height === rect.height)
+      return;
+
+    slot.rect = { left: rect.left, top: rect.top, width: rect.width, height: rect.height };
+    changes.push(slot.handle, rect.left, rect.top, rect.width, rect.height, 1);
+  });
+  if (changes.length > 0) native.updateComponentSlots(new Float32Array(changes));
+}
+
+function schedule() {
+  if (scheduled) return;
+  scheduled = true;
+  requestAnimationFrame(measure);
+}
+
+function observe() {
+  observing = true;
+  window.addEventListener("resize", schedule);
+  on("resize", schedule);
+  // Captured, since scroll events from nested containers don't bubble
+  document.addEventListener("scroll", schedule, { capture: true, passive: true });
+  new MutationObserver(schedule).observe(document.body, {
+    attributes: true,
+    characterData: true,
+    childList: true,
+    subtree: true,
+  });
+  if (typeof ResizeObserver !== "undefined") resizeObserver = new ResizeObserver(schedule);
+}
+
+// Reports the element's rect as the named slot until the returned function
+// is called, which hides the slot. Does nothing outside the native host.
+export function trackSlot(name: string, element: Element): () => void {
+  const native = host();
+  if (!native || !native.acquireComponentSlot) return () => {};
+  if (!observing) observe();
+
+  const slot: TrackedSlot = { handle: native.acquireComponentSlot(name), element, rect: null };
+  tracked.add(slot);
+  if (resizeObserver) resizeObserver.observe(element);
+  schedule();
+
+  return () => {
+    tracked.delete(slot);
+    if (resizeObserver) resizeObserver.unobserve(element);
+    const hidden = new Float32Array(SLOT_STRIDE);
+    hidden[0] = slot.handle;
+    if (native.updateComponentSlots) native.updateComponentSlots(hidden);
+  };
+}
@@ -1,10 +1,11 @@
-export type PrimitiveType = "cube" | "pyramid" | "cylinder" | "cone";
+import type { NativeFunctions } from "./bridge";
 
-interface NativeBridge {
-  setComponentSlot(name: string, x: number, y: number, width: number, height: number, visible: boolean): void;
-  setRotation(x: number, y: number, z: number): void;
-  setPrimitive(type: PrimitiveType): void;
+// Declared with the native setPrimitive registration
+export type PrimitiveType = Parameters<NativeFunctions["setPrimitive"]>[0];
 
+// Function signatures come from bridge.d.ts, generated from the native
+// registrations
+interface NativeBridge extends NativeFunctions {
   [key: string]: (...args: any[]) => any;
 }
 
@@ -5,8 +5,11 @@ layout (location = 2) in vec2 a_TexCoord;
 
 out vec2 v_TexCoord;
 
+// Left, top, right, bottom of the texture region to sample
+uniform vec4 u_UVRect = vec4(0.0, 0.0, 1.0, 1.0);
+
 void main()
 {
     gl_Position = vec4(a_Position.xy, 0.0, 1.0);
-    v_TexCoord = a_TexCoord;
+    v_TexCoord = mix(u_UVRect.xy, u_UVRect.zw, a_TexCoord);
 }
@@ -0,0 +1,247 @@
+#version 330 core
+
+in vec4 v_Color;
+in vec2 v_TexCoord;
+in vec2 v_ObjectCoord;
+in vec4 v_Data0;
+in vec4 v_Data1;
+in vec4 v_Data2;
+in vec4 v_Data3;
+in vec4 v_Data4;
+in vec4 v_Data5;
+in vec4 v_Data6;
+out vec4 OutColor;
+
+uniform vec4 u_State;
+uniform vec4 u_Scalar4[2];
+uniform vec4 u_Vector[8];
+uniform uint u_ClipSize;
+uniform mat4 u_Clip[8];
+uniform sampler2D u_Texture1;
+uniform sampler2D u_Texture2;
+uniform sampler2D u_Texture3;
+
+#define FILL_SOLID            0u
+#define FILL_IMAGE            1u
+#define FILL_PATTERN_IMAGE    2u
+#define FILL_PATTERN_GRADIENT 3u
+#define FILL_ROUNDED_RECT     7u
+#define FILL_BOX_SHADOW       8u
+
+#define AA_WIDTH 0.354
+
+float Antialias(float d, float width, float median)
+{
+    return smoothstep(median - width, median + width, d);
+}
+
+float SdRect(vec2 p, vec2 size)
+{
+    vec2 d = abs(p) - size;
+    return min(max(d.x, d.y), 0.0) + length(max(d, 0.0));
+}
+
+float SdEllipse(vec2 p, vec2 ab)
+{
+    if (abs(ab.x - ab.y) < 0.1)
+        return length(p) - ab.x;
+
+    vec2 q = abs(p);
+    vec2 e = max(ab, vec2(0.001));
+    float k0 = length(q / e);
+    float k1 = length(q / (e * e));
+    return k0 * (k0 - 1.0) / max(k1, 0.0001);
+}
+
+float SdRoundRect(vec2 p, vec2 size, vec4 rx, vec4 ry)
+{
+    size *= 0.5;
+
+    vec2 corner = vec2(-size.x + rx.x, -size.y + ry.x);
+    if (rx.x * ry.x > 0.0 && p.x < corner.x && p.y <= corner.y)
+        return SdEllipse(p - corner, vec2(rx.x, ry.x));
+
+    corner = vec2(size.x - rx.y, -size.y + ry.y);
+    if (rx.y * ry.y > 0.0 && p.x >= corner.x && p.y <= corner.y)
+        return SdEllipse(p - corner, vec2(rx.y, ry.y));
+
+    corner = vec2(size.x - rx.z, size.y - ry.z);
+    if (rx.z * ry.z > 0.0 && p.x >= corner.x && p.y >= corner.y)
+        return SdEllipse(p - corner, vec2(rx.z, ry.z));
+
+    corner = vec2(-size.x + rx.w, size.y - ry.w);
+    if (rx.w * ry.w > 0.0 && p.x < corner.x && p.y > corner.y)
+        return SdEllipse(p - corner, vec2(rx.w, ry.w));
+
+    return SdRect(p, size);
+}
+
+void Unpack(vec4 x, out vec4 a, out vec4 b)
+{
+    const float s = 65536.0;
+    a = floor(x / s);
+    b = x - a * s;
+}
+
+vec2 TransformAffine(vec2 p, vec2 a, vec2 b, vec2 c)
+{
+    return p.x * a + p.y * b + c;
+}
+
+void ApplyClip()
+{
+    for (uint i = 0u; i < u_ClipSize; i++)
+    {
+        mat4 data = u_Clip[i];
+        vec2 origin = data[0].xy;
+        vec2 size = data[0].zw;
+        vec4 radiiX, radiiY;
+        Unpack(data[1], radiiX, radiiY);
+        bool inverse = data[3].z > 0.5;
+
+        vec2 p = TransformAffine(v_ObjectCoord, data[2].xy, data[2].zw, data[3].xy) - origin;
+        float d = SdRoundRect(p, size, radiiX, radiiY) * (inverse ? -1.0 : 1.0);
+        OutColor *= Antialias(-d, AA_WIDTH, -AA_WIDTH);
+    }
+}
+
+float Scalar(int i)
+{
+    return i < 4 ? u_Scalar4[0][i] : u_Scalar4[1][i - 4];
+}
+
+struct GradientStop
+{
+    float percent;
+    vec4 color;
+};
+
+GradientStop GetGradientStop(int index)
+{
+    GradientStop stop;
+    if (index < 4)
+    {
+        stop.percent = v_Data2[index];
+        if (index == 0) stop.color = v_Data3;
+        else if (index == 1) stop.color = v_Data4;
+        else if (index == 2) stop.color = v_Data5;
+        else stop.color = v_Data6;
+    }
+    else
+    {
+        stop.percent = Scalar(index - 4);
+        stop.color = u_Vector[index - 4];
+    }
+    return stop;
+}
+
+void FillPatternImage()
+{
+    vec4 tileRectUV = u_Vector[0];
+    vec2 tileSize = u_Vector[1].zw;
+
+    vec2 p = TransformAffine(v_ObjectCoord, u_Vector[2].xy, u_Vector[2].zw, u_Vector[3].xy);
+    p = mod(p, tileSize) / tileSize;
+    vec2 uv = mix(tileRectUV.xy, tileRectUV.zw, p);
+    OutColor = texture(u_Texture1, uv) * v_Color;
+}
+
+void FillPatternGradient()
+{
+    int numStops = int(v_Data0.y + 0.5);
+    bool isRadial = v_Data0.z > 0.5;
+    vec2 p0 = v_Data1.xy;
+    vec2 p1 = v_Data1.zw;
+
+    float t;
+    if (isRadial)
+    {
+        float r0 = p1.x;
+        float r1 = p1.y;
+        t = (distance(v_TexCoord, p0) - r0) / max(r1 - r0, 0.0001);
+    }
+    else
+    {
+        vec2 v = p1 - p0;
+        t = dot(v_TexCoord - p0, v) / max(dot(v, v), 0.0001);
+    }
+
+    GradientStop previous = GetGradientStop(0);
+    OutColor = previous.color;
+    for (int i = 1; i < numStops; i++)
+    {
+        GradientStop next = GetGradientStop(i);
+        float range = max(next.percent - previous.percent, 0.0001);
+        OutColor = mix(OutColor, next.color, clamp((t - previous.percent) / range, 0.0, 1.0));
+        previous = next;
+    }
+}
+
+void FillRoundedRect()
+{
+    vec2 size = v_Data0.zw;
+    vec2 p = (v_TexCoord - 0.5) * size;
+    float d = SdRoundRect(p, size, v_Data1, v_Data2);
+
+    OutColor = v_Color * Antialias(-d, AA_WIDTH, 0.0);
+
+    float strokeWidth = v_Data3.x;
+    if (strokeWidth > 0.0)
+    {
+        vec4 strokeColor = v_Data4;
+        float inner = Antialias(-d, AA_WIDTH, strokeWidth);
+        float outer = Antialias(-d, AA_WIDTH, 0.0);
+        vec4 stroke = strokeColor * (outer - inner);
+        OutColor = stroke + OutColor * (1.0 - stroke.a);
+    }
+}
+
+void FillBoxShadow()
+{
+    vec2 p = v_ObjectCoord;
+    bool inset = v_Data0.y > 0.5;
+    float radius = v_Data0.z;
+    vec2 origin = v_Data1.xy;
+    vec2 size = v_Data1.zw;
+    vec2 clipOrigin = v_Data4.xy;
+    vec2 clipSize = v_Data4.zw;
+
+    float sdClip = SdRoundRect(p - clipOrigin, clipSize, v_Data5, v_Data6);
+    float sdShadow = SdRoundRect(p - origin, size, v_Data2, v_Data3);
+
+    float clip = inset ? -sdShadow : sdClip;
+    float d = inset ? -sdClip : sdShadow;
+    if (clip < -AA_WIDTH && !inset)
+    {
+        OutColor = vec4(0.0);
+        return;
+    }
+
+    float alpha = radius >= 1.0
+        ? pow(Antialias(-d, radius * 2.0 + 0.2, 0.0), 1.9) * 3.3 / pow(radius * 1.2, 0.15)
+        : Antialias(-d, AA_WIDTH, inset ? -1.0 : 1.0);
+    alpha = clamp(alpha, 0.0, 1.0);
+    OutColor = v_Color * alpha;
+}
+
+void main()
+{
+    uint fillType = uint(v_Data0.x + 0.5);
+
+    if (fillType == FILL_SOLID)
+        OutColor = v_Color;
+    else if (fillType == FILL_IMAGE)
+        OutColor = texture(u_Texture1, v_TexCoord) * v_Color;
+    else if (fillType == FILL_PATTERN_IMAGE)
+        FillPatternImage();
+    else if (fillType == FILL_PATTERN_GRADIENT)
+        FillPatternGradient();
+    else if (fillType == FILL_ROUNDED_RECT)
+        FillRoundedRect();
+    else if (fillType == FILL_BOX_SHADOW)
+        FillBoxShadow();
+    else
+        OutColor = v_Color;
+
+    ApplyClip();
+}
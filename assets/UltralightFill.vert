@@ -0,0 +1,41 @@
+#version 330 core
+
+layout (location = 0) in vec2 a_Position;
+layout (location = 1) in vec4 a_Color;
+layout (location = 2) in vec2 a_TexCoord;
+layout (location = 3) in vec2 a_ObjectCoord;
+layout (location = 4) in vec4 a_Data0;
+layout (location = 5) in vec4 a_Data1;
+layout (location = 6) in vec4 a_Data2;
+layout (location = 7) in vec4 a_Data3;
+layout (location = 8) in vec4 a_Data4;
+layout (location = 9) in vec4 a_Data5;
+layout (location = 10) in vec4 a_Data6;
+
+uniform mat4 u_Transform;
+
+out vec4 v_Color;
+out vec2 v_TexCoord;
+out vec2 v_ObjectCoord;
+out vec4 v_Data0;
+out vec4 v_Data1;
+out vec4 v_Data2;
+out vec4 v_Data3;
+out vec4 v_Data4;
+out vec4 v_Data5;
+out vec4 v_Data6;
+
+void main()
+{
+    gl_Position = u_Transform * vec4(a_Position, 0.0, 1.0);
+    v_Color = a_Color;
+    v_TexCoord = a_TexCoord;
+    v_ObjectCoord = a_ObjectCoord;
+    v_Data0 = a_Data0;
+    v_Data1 = a_Data1;
+    v_Data2 = a_Data2;
+    v_Data3 = a_Data3;
+    v_Data4 = a_Data4;
+    v_Data5 = a_Data5;
+    v_Data6 = a_Data6;
+}
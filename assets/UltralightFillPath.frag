@@ -0,0 +1,91 @@
+#version 330 core
+
+in vec4 v_Color;
+in vec2 v_ObjectCoord;
+out vec4 OutColor;
+
+uniform uint u_ClipSize;
+uniform mat4 u_Clip[8];
+
+#define AA_WIDTH 0.354
+
+float Antialias(float d, float width, float median)
+{
+    return smoothstep(median - width, median + width, d);
+}
+
+float SdRect(vec2 p, vec2 size)
+{
+    vec2 d = abs(p) - size;
+    return min(max(d.x, d.y), 0.0) + length(max(d, 0.0));
+}
+
+float SdEllipse(vec2 p, vec2 ab)
+{
+    if (abs(ab.x - ab.y) < 0.1)
+        return length(p) - ab.x;
+
+    vec2 q = abs(p);
+    vec2 e = max(ab, vec2(0.001));
+    float k0 = length(q / e);
+    float k1 = length(q / (e * e));
+    return k0 * (k0 - 1.0) / max(k1, 0.0001);
+}
+
+float SdRoundRect(vec2 p, vec2 size, vec4 rx, vec4 ry)
+{
+    size *= 0.5;
+
+    vec2 corner = vec2(-size.x + rx.x, -size.y + ry.x);
+    if (rx.x * ry.x > 0.0 && p.x < corner.x && p.y <= corner.y)
+        return SdEllipse(p - corner, vec2(rx.x, ry.x));
+
+    corner = vec2(size.x - rx.y, -size.y + ry.y);
+    if (rx.y * ry.y > 0.0 && p.x >= corner.x && p.y <= corner.y)
+        return SdEllipse(p - corner, vec2(rx.y, ry.y));
+
+    corner = vec2(size.x - rx.z, size.y - ry.z);
+    if (rx.z * ry.z > 0.0 && p.x >= corner.x && p.y >= corner.y)
+        return SdEllipse(p - corner, vec2(rx.z, ry.z));
+
+    corner = vec2(-size.x + rx.w, size.y - ry.w);
+    if (rx.w * ry.w > 0.0 && p.x < corner.x && p.y > corner.y)
+        return SdEllipse(p - corner, vec2(rx.w, ry.w));
+
+    return SdRect(p, size);
+}
+
+void Unpack(vec4 x, out vec4 a, out vec4 b)
+{
+    const float s = 65536.0;
+    a = floor(x / s);
+    b = x - a * s;
+}
+
+vec2 TransformAffine(vec2 p, vec2 a, vec2 b, vec2 c)
+{
+    return p.x * a + p.y * b + c;
+}
+
+void ApplyClip()
+{
+    for (uint i = 0u; i < u_ClipSize; i++)
+    {
+        mat4 data = u_Clip[i];
+        vec2 origin = data[0].xy;
+        vec2 size = data[0].zw;
+        vec4 radiiX, radiiY;
+        Unpack(data[1], radiiX, radiiY);
+        bool inverse = data[3].z > 0.5;
+
+        vec2 p = TransformAffine(v_ObjectCoord, data[2].xy, data[2].zw, data[3].xy) - origin;
+        float d = SdRoundRect(p, size, radiiX, radiiY) * (inverse ? -1.0 : 1.0);
+        OutColor *= Antialias(-d, AA_WIDTH, -AA_WIDTH);
+    }
+}
+
+void main()
+{
+    OutColor = v_Color;
+    ApplyClip();
+}
@@ -0,0 +1,17 @@
+#version 330 core
+
+layout (location = 0) in vec2 a_Position;
+layout (location = 1) in vec4 a_Color;
+layout (location = 2) in vec2 a_ObjectCoord;
+
+uniform mat4 u_Transform;
+
+out vec4 v_Color;
+out vec2 v_ObjectCoord;
+
+void main()
+{
+    gl_Position = u_Transform * vec4(a_Position, 0.0, 1.0);
+    v_Color = a_Color;
+    v_ObjectCoord = a_ObjectCoord;
+}
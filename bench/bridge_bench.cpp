@@ -0,0 +1,200 @@
+// Measures JS -> native call throughput through JSBridge against the
+// name-based dispatch it replaced (read _nativeFuncName off the function,
+// copy it to a std::string, hash it into a map). The typed cases convert
+// arguments straight into parameters instead of building JSArgs. The last
+// table is the per-call cost of turning profiling on.
+//
+// Usage: ULGL-Embed-BridgeBench [calls]
+
+#include "JSBridge.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+static std::unordered_map<std::string, JSCallback> s_LegacyFunctions;
+
+static std::string ToString(JSContextRef ctx, JSValueRef value)
+{
+    JSStringRef jsStr = JSValueToStringCopy(ctx, value, nullptr);
+    if (!jsStr) return "";
+
+    size_t maxSize = JSStringGetMaximumUTF8CStringSize(jsStr);
+    std::string result(maxSize, '\0');
+    size_t actualSize = JSStringGetUTF8CString(jsStr, &result[0], maxSize);
+    result.resize(actualSize > 0 ? actualSize - 1 : 0);
+    JSStringRelease(jsStr);
+    return result;
+}
+
+// Same conversions JSBridge does, so only the dispatch differs
+static JSValue FromJS(JSContextRef ctx, JSValueRef value)
+{
+    if (JSValueIsNull(ctx, value) || JSValueIsUndefined(ctx, value))
+        return nullptr;
+    if (JSValueIsBoolean(ctx, value))
+        return JSValueToBoolean(ctx, value);
+    if (JSValueIsNumber(ctx, value))
+        return JSValueToNumber(ctx, value, nullptr);
+    return ToString(ctx, value);
+}
+
+static JSValueRef ToJS(JSContextRef ctx, const JSValue& value)
+{
+    if (auto* b = std::get_if<bool>(&value))
+        return JSValueMakeBoolean(ctx, *b);
+    if (auto* d = std::get_if<double>(&value))
+        return JSValueMakeNumber(ctx, *d);
+    if (auto* s = std::get_if<std::string>(&value))
+    {
+        JSStringRef jsStr = JSStringCreateWithUTF8CString(s->c_str());
+        JSValueRef result = JSValueMakeString(ctx, jsStr);
+        JSStringRelease(jsStr);
+        return result;
+    }
+    return JSValueMakeNull(ctx);
+}
+
+// The previous dispatch path, kept here only for comparison
+static JSValueRef LegacyCallHandler(JSContextRef ctx, JSObjectRef function, JSObjectRef, size_t argumentCount,
+                                    const JSValueRef arguments[], JSValueRef*)
+{
+    JSStringRef nameProperty = JSStringCreateWithUTF8CString("_nativeFuncName");
+    JSValueRef nameValue = JSObjectGetProperty(ctx, function, nameProperty, nullptr);
+    JSStringRelease(nameProperty);
+
+    auto it = s_LegacyFunctions.find(ToString(ctx, nameValue));
+    if (it == s_LegacyFunctions.end())
+        return JSValueMakeUndefined(ctx);
+
+    JSArgs args;
+    args.reserve(argumentCount);
+    for (size_t i = 0; i < argumentCount; i++)
+        args.push_back(FromJS(ctx, arguments[i]));
+
+    return ToJS(ctx, it->second(args));
+}
+
+static void BindLegacy(JSContextRef ctx)
+{
+    JSObjectRef legacyObj = JSObjectMake(ctx, nullptr, nullptr);
+    for (const auto& entry : s_LegacyFunctions)
+    {
+        JSStringRef funcNameStr = JSStringCreateWithUTF8CString(entry.first.c_str());
+        JSObjectRef funcObj = JSObjectMakeFunctionWithCallback(ctx, funcNameStr, LegacyCallHandler);
+
+        JSStringRef nameProperty = JSStringCreateWithUTF8CString("_nativeFuncName");
+        JSObjectSetProperty(ctx, funcObj, nameProperty, JSValueMakeString(ctx, funcNameStr),
+                            kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontEnum, nullptr);
+        JSStringRelease(nameProperty);
+
+        JSObjectSetProperty(ctx, legacyObj, funcNameStr, funcObj, kJSPropertyAttributeNone, nullptr);
+        JSStringRelease(funcNameStr);
+    }
+
+    JSStringRef legacyName = JSStringCreateWithUTF8CString("legacy");
+    JSObjectSetProperty(ctx, JSContextGetGlobalObject(ctx), legacyName, legacyObj, kJSPropertyAttributeNone, nullptr);
+    JSStringRelease(legacyName);
+}
+
+// Runs `calls` iterations of the expression in a JS loop; returns calls/sec.
+static double Measure(JSContextRef ctx, const char* expression, long calls)
+{
+    std::string script = "(function(){ let sum = 0; for (let i = 0; i < " + std::to_string(calls) +
+                         "; i++) sum += " + expression + " || 0; return sum; })()";
+    JSStringRef source = JSStringCreateWithUTF8CString(script.c_str());
+
+    auto start = std::chrono::steady_clock::now();
+    JSValueRef exception = nullptr;
+    JSEvaluateScript(ctx, source, nullptr, nullptr, 0, &exception);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    JSStringRelease(source);
+
+    if (exception)
+    {
+        std::cerr << "Script failed: " << ToString(ctx, exception) << std::endl;
+        return 0.0;
+    }
+    return calls / seconds;
+}
+
+int main(int argc, char* argv[])
+{
+    long calls = argc > 1 ? std::atol(argv[1]) : 1000000;
+
+    // A realistic table size; the legacy path hashes into it on every call
+    JSBridge bridge;
+    for (int i = 0; i < 32; i++)
+    {
+        std::string name = "filler" + std::to_string(i);
+        bridge.Register(name, [](const JSArgs&) -> JSValue { return nullptr; });
+        s_LegacyFunctions[name] = [](const JSArgs&) -> JSValue { return nullptr; };
+    }
+
+    JSCallback noop = [](const JSArgs&) -> JSValue { return nullptr; };
+    JSCallback add = [](const JSArgs& args) -> JSValue
+    {
+        return JSBridge::GetArg<double>(args, 0).value_or(0.0) + JSBridge::GetArg<double>(args, 1).value_or(0.0);
+    };
+    bridge.Register("noop", noop);
+    bridge.Register("add", add);
+    bridge.Register("setComponentSlot", noop);
+    bridge.Register("addTyped", [](double a, double b) { return a + b; });
+    bridge.Register("setComponentSlotTyped", [](const std::string&, float, float, float, float, bool) {});
+    s_LegacyFunctions["noop"] = noop;
+    s_LegacyFunctions["add"] = add;
+    s_LegacyFunctions["setComponentSlot"] = noop;
+
+    JSGlobalContextRef ctx = JSGlobalContextCreate(nullptr);
+    bridge.BindToContext(ctx);
+    BindLegacy(ctx);
+
+    struct Case
+    {
+        const char* label;
+        const char* handle;
+        const char* legacy;
+    };
+    const Case cases[] = {
+        { "no arguments", "native.noop()", "legacy.noop()" },
+        { "2 numbers -> number", "native.add(i, 1)", "legacy.add(i, 1)" },
+        { "setComponentSlot (6 args)", "native.setComponentSlot(i, 1, 2, 3, 4, 5)",
+          "legacy.setComponentSlot(i, 1, 2, 3, 4, 5)" },
+        { "2 numbers -> number, typed", "native.addTyped(i, 1)", "legacy.add(i, 1)" },
+        { "setComponentSlot, typed", "native.setComponentSlotTyped('cube', 1, 2, 3, 4, true)",
+          "legacy.setComponentSlot('cube', 1, 2, 3, 4, true)" },
+    };
+
+    std::printf("%ld calls per case\n", calls);
+    std::printf("%-28s %14s %14s %8s\n", "case", "handle/s", "by-name/s", "speedup");
+    for (const Case& c : cases)
+    {
+        // Warm both paths up before timing
+        Measure(ctx, c.handle, calls / 10);
+        Measure(ctx, c.legacy, calls / 10);
+
+        double handle = Measure(ctx, c.handle, calls);
+        double legacy = Measure(ctx, c.legacy, calls);
+        std::printf("%-28s %14.0f %14.0f %7.2fx\n", c.label, handle, legacy, legacy > 0.0 ? handle / legacy : 0.0);
+    }
+
+    const Case profiled[] = { cases[1], cases[3], cases[4] };
+    std::printf("\n%-28s %14s %14s %10s\n", "profiling", "off/s", "on/s", "ns/call");
+    for (const Case& c : profiled)
+    {
+        bridge.SetProfiling(false);
+        Measure(ctx, c.handle, calls / 10);
+        double off = Measure(ctx, c.handle, calls);
+        bridge.SetProfiling(true);
+        Measure(ctx, c.handle, calls / 10);
+        double on = Measure(ctx, c.handle, calls);
+        double overhead = off > 0.0 && on > 0.0 ? (1.0 / on - 1.0 / off) * 1e9 : 0.0;
+        std::printf("%-28s %14.0f %14.0f %10.1f\n", c.label, off, on, overhead);
+    }
+    bridge.SetProfiling(false);
+
+    JSGlobalContextRelease(ctx);
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Checks that the SIMD BGRA -> I420 conversion matches the scalar reference
+// byte for byte, over widths that leave a scalar tail, odd sizes, padded
+// strides and bottom-up (negative stride) sources. Then times both on a
+// 1080p frame. Exits non-zero on the first mismatch.
+//
+// Usage: ULGL-Embed-ColorConvertBench [iterations]
+
+#include "ColorConvert.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+struct Planes
+{
+    std::vector<uint8_t> y;
+    std::vector<uint8_t> u;
+    std::vector<uint8_t> v;
+    uint32_t yStride;
+    uint32_t uvStride;
+
+    // Pads each plane row so writes past the image show up as mismatches
+    Planes(uint32_t width, uint32_t height)
+        : yStride(width + 3)
+        , uvStride((width + 1) / 2 + 5)
+    {
+        y.assign(static_cast<size_t>(yStride) * height, 0xCD);
+        u.assign(static_cast<size_t>(uvStride) * ((height + 1) / 2), 0xCD);
+        v.assign(u.size(), 0xCD);
+    }
+
+    bool operator==(const Planes& other) const
+    {
+        return y == other.y && u == other.u && v == other.v;
+    }
+};
+
+using ConvertFunction = void (*)(const uint8_t*, ptrdiff_t, uint32_t, uint32_t,
+                                 uint8_t*, uint32_t, uint8_t*, uint8_t*, uint32_t);
+
+static void Run(ConvertFunction convert, const std::vector<uint8_t>& bgra, ptrdiff_t stride,
+                uint32_t width, uint32_t height, Planes& planes)
+{
+    // A negative stride starts from the last row
+    const uint8_t* source = bgra.data();
+    if (stride < 0)
+        source += static_cast<ptrdiff_t>(height - 1) * -stride;
+    convert(source, stride, width, height, planes.y.data(), planes.yStride,
+            planes.u.data(), planes.v.data(), planes.uvStride);
+}
+
+static bool Compare(std::mt19937& random, uint32_t width, uint32_t height, uint32_t padding, bool bottomUp)
+{
+    ptrdiff_t rowBytes = static_cast<ptrdiff_t>(width) * 4 + padding;
+    std::vector<uint8_t> bgra(static_cast<size_t>(rowBytes) * height);
+    for (uint8_t& byte : bgra)
+        byte = static_cast<uint8_t>(random());
+
+    Planes simd(width, height);
+    Planes scalar(width, height);
+    Run(ColorConvert::BGRAToI420, bgra, bottomUp ? -rowBytes : rowBytes, width, height, simd);
+    Run(ColorConvert::BGRAToI420Scalar, bgra, bottomUp ? -rowBytes : rowBytes, width, height, scalar);
+    if (simd == scalar)
+        return true;
+
+    std::fprintf(stderr, "Mismatch at %ux%u, padding %u%s\n", width, height, padding, bottomUp ? ", bottom-up" : "");
+    return false;
+}
+
+static double Time(ConvertFunction convert, const std::vector<uint8_t>& bgra, uint32_t width, uint32_t height,
+                   Planes& planes, int iterations)
+{
+    ptrdiff_t rowBytes = static_cast<ptrdiff_t>(width) * 4;
+    Run(convert, bgra, -rowBytes, width, height, planes);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        Run(convert, bgra, -rowBytes, width, height, planes);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 100;
+
+    std::mt19937 random(1);
+    const uint32_t widths[] = { 1, 2, 3, 6, 7, 8, 9, 14, 16, 17, 30, 33, 1918, 1920 };
+    const uint32_t heights[] = { 1, 2, 3, 4, 17 };
+    const uint32_t paddings[] = { 0, 4, 13 };
+    int cases = 0;
+    for (uint32_t width : widths)
+    {
+        for (uint32_t height : heights)
+        {
+            for (uint32_t padding : paddings)
+            {
+                for (bool bottomUp : { false, true })
+                {
+                    if (!Compare(random, width, height, padding, bottomUp))
+                        return 1;
+                    cases++;
+                }
+            }
+        }
+    }
+    std::printf("%d sizes and strides match the scalar reference\n", cases);
+
+    const uint32_t width = 1920;
+    const uint32_t height = 1080;
+    std::vector<uint8_t> bgra(static_cast<size_t>(width) * height * 4);
+    for (uint8_t& byte : bgra)
+        byte = static_cast<uint8_t>(random());
+
+    Planes planes(width, height);
+    double simd = Time(ColorConvert::BGRAToI420, bgra, width, height, planes, iterations);
+    double scalar = Time(ColorConvert::BGRAToI420Scalar, bgra, width, height, planes, iterations);
+    std::printf("%ux%u, %d iterations\n", width, height, iterations);
+    std::printf("%-10s %10.3f ms\n", ColorConvert::HasSIMD() ? "SSE2" : "no SIMD", simd);
+    std::printf("%-10s %10.3f ms\n", "scalar", scalar);
+    std::printf("%-10s %9.2fx\n", "speedup", simd > 0.0 ? scalar / simd : 0.0);
+    return 0;
+}
@@ -0,0 +1,388 @@
+// Compares passing structured data through JSBridge as objects and arrays
+// with the JSON round trip it replaces (JSON.stringify in JS, parse in C++,
+// and the reverse for results), using a telemetry-style object. Then times
+// values JSON can't express or would blow up: a self-referencing object and
+// a chain of objects each referencing the next one twice.
+//
+// Usage: ULGL-Embed-MarshalBench [fields] [iterations]
+
+#include "JSBridge.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Minimal JSON reader and writer, only so the comparison has a C++ side
+namespace Json
+{
+    struct Reader
+    {
+        const char* cursor;
+        const char* end;
+
+        void SkipSpace()
+        {
+            while (cursor < end && (*cursor == ' ' || *cursor == '\n' || *cursor == '\r' || *cursor == '\t'))
+                cursor++;
+        }
+
+        static void AppendUTF8(std::string& out, uint32_t code)
+        {
+            if (code < 0x80)
+            {
+                out += static_cast<char>(code);
+            }
+            else if (code < 0x800)
+            {
+                out += static_cast<char>(0xC0 | (code >> 6));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else if (code < 0x10000)
+            {
+                out += static_cast<char>(0xE0 | (code >> 12));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+            else
+            {
+                out += static_cast<char>(0xF0 | (code >> 18));
+                out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+
+        uint32_t ReadHex4()
+        {
+            uint32_t value = 0;
+            for (int i = 0; i < 4 && cursor < end; i++, cursor++)
+            {
+                char c = *cursor;
+                value = value * 16 + static_cast<uint32_t>(c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+            }
+            return value;
+        }
+
+        std::string ReadString()
+        {
+            std::string out;
+            cursor++;
+            while (cursor < end && *cursor != '"')
+            {
+                if (*cursor != '\\')
+                {
+                    out += *cursor++;
+                    continue;
+                }
+
+                cursor++;
+                char escape = cursor < end ? *cursor++ : '\0';
+                switch (escape)
+                {
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u':
+                {
+                    uint32_t code = ReadHex4();
+                    if (code >= 0xD800 && code < 0xDC00 && end - cursor >= 6 && cursor[0] == '\\' && cursor[1] == 'u')
+                    {
+                        cursor += 2;
+                        code = 0x10000 + ((code - 0xD800) << 10) + (ReadHex4() - 0xDC00);
+                    }
+                    AppendUTF8(out, code);
+                    break;
+                }
+                default: out += escape; break;
+                }
+            }
+            cursor++;
+            return out;
+        }
+
+        JSValue ReadValue()
+        {
+            SkipSpace();
+            if (cursor >= end)
+                return nullptr;
+
+            switch (*cursor)
+            {
+            case '{':
+            {
+                JSObject object;
+                cursor++;
+                SkipSpace();
+                while (cursor < end && *cursor != '}')
+                {
+                    SkipSpace();
+                    std::string key = ReadString();
+                    SkipSpace();
+                    cursor++; // ':'
+                    object.fields.emplace_back(std::move(key), ReadValue());
+                    SkipSpace();
+                    if (cursor < end && *cursor == ',')
+                        cursor++;
+                }
+                cursor++;
+                return object;
+            }
+            case '[':
+            {
+                JSArray array;
+                cursor++;
+                SkipSpace();
+                while (cursor < end && *cursor != ']')
+                {
+                    array.push_back(ReadValue());
+                    SkipSpace();
+                    if (cursor < end && *cursor == ',')
+                        cursor++;
+                }
+                cursor++;
+                return array;
+            }
+            case '"':
+                return ReadString();
+            case 't':
+                cursor += 4;
+                return true;
+            case 'f':
+                cursor += 5;
+                return false;
+            case 'n':
+                cursor += 4;
+                return nullptr;
+            default:
+            {
+                char* numberEnd = nullptr;
+                double number = std::strtod(cursor, &numberEnd);
+                cursor = numberEnd > cursor ? numberEnd : cursor + 1;
+                return number;
+            }
+            }
+        }
+    };
+
+    JSValue Parse(const std::string& text)
+    {
+        Reader reader{ text.data(), text.data() + text.size() };
+        return reader.ReadValue();
+    }
+
+    void WriteString(std::string& out, const std::string& value)
+    {
+        out += '"';
+        for (char c : value)
+        {
+            switch (c)
+            {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escape[8];
+                    std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+                    out += escape;
+                }
+                else
+                {
+                    out += c;
+                }
+            }
+        }
+        out += '"';
+    }
+
+    void Write(std::string& out, const JSValue& value)
+    {
+        if (auto* b = std::get_if<bool>(&value))
+        {
+            out += *b ? "true" : "false";
+        }
+        else if (auto* d = std::get_if<double>(&value))
+        {
+            if (!std::isfinite(*d))
+            {
+                out += "null";
+                return;
+            }
+            char number[32];
+            std::snprintf(number, sizeof(number), "%.17g", *d);
+            out += number;
+        }
+        else if (auto* s = std::get_if<std::string>(&value))
+        {
+            WriteString(out, *s);
+        }
+        else if (auto* array = std::get_if<JSArray>(&value))
+        {
+            out += '[';
+            for (size_t i = 0; i < array->size(); i++)
+            {
+                if (i > 0) out += ',';
+                Write(out, (*array)[i]);
+            }
+            out += ']';
+        }
+        else if (auto* object = std::get_if<JSObject>(&value))
+        {
+            out += '{';
+            for (size_t i = 0; i < object->fields.size(); i++)
+            {
+                if (i > 0) out += ',';
+                WriteString(out, object->fields[i].first);
+                out += ':';
+                Write(out, object->fields[i].second);
+            }
+            out += '}';
+        }
+        else
+        {
+            out += "null";
+        }
+    }
+}
+
+// Touches every number so neither path can skip work
+static double Checksum(const JSValue& value)
+{
+    if (auto* d = std::get_if<double>(&value))
+        return *d;
+    if (auto* s = std::get_if<std::string>(&value))
+        return static_cast<double>(s->size());
+    if (auto* array = std::get_if<JSArray>(&value))
+    {
+        double sum = 0.0;
+        for (const JSValue& element : *array)
+            sum += Checksum(element);
+        return sum;
+    }
+    if (auto* object = std::get_if<JSObject>(&value))
+    {
+        double sum = 0.0;
+        for (const auto& field : object->fields)
+            sum += Checksum(field.second);
+        return sum;
+    }
+    return 0.0;
+}
+
+static JSValue MakeTelemetry(int fields)
+{
+    JSObject object;
+    object.fields.reserve(fields);
+    for (int i = 0; i < fields; i++)
+    {
+        std::string key = "metric" + std::to_string(i);
+        if (i % 50 == 0)
+            object.fields.emplace_back(key, JSArray{ JSValue(i * 0.5), JSValue(i * 1.5), JSValue(i * 2.5) });
+        else if (i % 10 == 0)
+            object.fields.emplace_back(key, "state-" + std::to_string(i));
+        else
+            object.fields.emplace_back(key, i * 0.25);
+    }
+    return object;
+}
+
+static double Run(JSContextRef ctx, const std::string& body, int iterations)
+{
+    std::string script = "(function(){ let sum = 0; for (let i = 0; i < " + std::to_string(iterations) +
+                         "; i++) { " + body + " } return sum; })()";
+    JSStringRef source = JSStringCreateWithUTF8CString(script.c_str());
+
+    auto start = std::chrono::steady_clock::now();
+    JSValueRef exception = nullptr;
+    JSEvaluateScript(ctx, source, nullptr, nullptr, 0, &exception);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    JSStringRelease(source);
+
+    if (exception)
+    {
+        std::cerr << "Script failed" << std::endl;
+        return 0.0;
+    }
+    return iterations / seconds;
+}
+
+int main(int argc, char* argv[])
+{
+    int fields = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    JSValue telemetry = MakeTelemetry(fields);
+    std::string telemetryJSON;
+    Json::Write(telemetryJSON, telemetry);
+
+    JSBridge bridge;
+    bridge.Register("consumeObject", [](const JSArgs& args) -> JSValue
+    {
+        return args.empty() ? 0.0 : Checksum(args[0]);
+    });
+    bridge.Register("consumeJSON", [](const JSArgs& args) -> JSValue
+    {
+        auto text = std::get_if<std::string>(args.empty() ? nullptr : &args[0]);
+        return text ? Checksum(Json::Parse(*text)) : 0.0;
+    });
+    bridge.Register("produceObject", [&telemetry](const JSArgs&) -> JSValue
+    {
+        return telemetry;
+    });
+    bridge.Register("produceJSON", [&telemetry](const JSArgs&) -> JSValue
+    {
+        std::string text;
+        Json::Write(text, telemetry);
+        return text;
+    });
+
+    JSGlobalContextRef ctx = JSGlobalContextCreate(nullptr);
+    bridge.BindToContext(ctx);
+
+    std::string setup = "var telemetry = " + telemetryJSON + ";"
+                        "var cyclic = { x: 1 }; cyclic.a = cyclic; cyclic.b = cyclic;"
+                        "var shared = { x: 1 }; for (var d = 0; d < 30; d++) shared = { a: shared, b: shared };";
+    JSStringRef setupSource = JSStringCreateWithUTF8CString(setup.c_str());
+    JSEvaluateScript(ctx, setupSource, nullptr, nullptr, 0, nullptr);
+    JSStringRelease(setupSource);
+
+    struct Case
+    {
+        const char* label;
+        const char* bridged;
+        const char* json;
+    };
+    const Case cases[] = {
+        { "JS -> native", "sum += native.consumeObject(telemetry);",
+          "sum += native.consumeJSON(JSON.stringify(telemetry));" },
+        { "native -> JS", "sum += native.produceObject().metric1;",
+          "sum += JSON.parse(native.produceJSON()).metric1;" },
+    };
+
+    std::printf("%d fields, %d iterations per case\n", fields, iterations);
+    std::printf("%-16s %14s %14s %8s\n", "case", "objects/s", "json/s", "speedup");
+    for (const Case& c : cases)
+    {
+        Run(ctx, c.bridged, iterations / 10 + 1);
+        Run(ctx, c.json, iterations / 10 + 1);
+
+        double bridged = Run(ctx, c.bridged, iterations);
+        double json = Run(ctx, c.json, iterations);
+        std::printf("%-16s %14.0f %14.0f %7.2fx\n", c.label, bridged, json, json > 0.0 ? bridged / json : 0.0);
+    }
+
+    // Both must finish: the cycle is cut to null, the shared chain stops at
+    // the conversion's value budget instead of expanding to 2^30 objects
+    std::printf("%-16s %14.0f\n", "cyclic object", Run(ctx, "sum += native.consumeObject(cyclic);", 100));
+    std::printf("%-16s %14.0f\n", "shared x2^30", Run(ctx, "sum += native.consumeObject(shared);", 3));
+
+    JSGlobalContextRelease(ctx);
+    return 0;
+}
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+
+import sys
+import os
+import struct
+import mimetypes
+
+# Layout (little endian), read by src/BundleFileSystem.cpp:
+#   header   magic[8] version:u32 entryCount:u32 slotCount:u32 reserved:u32
+#            entriesOffset:u64 slotsOffset:u64
+#   entries  hash:u64 dataOffset:u64 dataSize:u64
+#            pathOffset:u32 pathLength:u32 mimeOffset:u32 mimeLength:u32
+#   slots    u32 per slot, entry index + 1 (0 = empty), open addressing on
+#            hash & (slotCount - 1) with linear probing
+#   strings  paths and MIME types, not null terminated
+#   data     file contents, each aligned to DATA_ALIGNMENT
+MAGIC = b"ULBUNDLE"
+VERSION = 1
+HEADER_FORMAT = "<8sIIIIQQ"
+ENTRY_FORMAT = "<QQQIIII"
+DATA_ALIGNMENT = 16
+
+EXCLUDE_DIRS = ['node_modules', '.git', '.vscode', '.idea', '__pycache__', '.pytest_cache']
+EXCLUDE_FILES = ['.gitignore', '.gitattributes', '.DS_Store', 'Thumbs.db']
+
+MIME_OVERRIDES = {
+    '.js': 'application/javascript',
+    '.mjs': 'application/javascript',
+    '.json': 'application/json',
+    '.map': 'application/json',
+    '.wasm': 'application/wasm',
+    '.svg': 'image/svg+xml',
+    '.woff': 'font/woff',
+    '.woff2': 'font/woff2',
+    '.ttf': 'font/ttf',
+    '.otf': 'font/otf',
+    '.css': 'text/css',
+    '.html': 'text/html',
+    '.htm': 'text/html',
+    '.txt': 'text/plain',
+    '.pem': 'application/x-pem-file',
+    '.dat': 'application/octet-stream',
+}
+
+def fnv1a64(data):
+    value = 0xcbf29ce484222325
+    for byte in data:
+        value ^= byte
+        value = (value * 0x100000001b3) & 0xffffffffffffffff
+    return value
+
+def guess_mime_type(path):
+    ext = os.path.splitext(path)[1].lower()
+    if ext in MIME_OVERRIDES:
+        return MIME_OVERRIDES[ext]
+    mime, _ = mimetypes.guess_type(path)
+    return mime or 'application/octet-stream'
+
+def align(value, alignment):
+    return (value + alignment - 1) & ~(alignment - 1)
+
+def collect_files(src, prefix):
+    files = []
+    for root, dirs, names in os.walk(src):
+        dirs[:] = sorted(d for d in dirs if d not in EXCLUDE_DIRS)
+        for name in sorted(names):
+            if name in EXCLUDE_FILES:
+                continue
+            full_path = os.path.join(root, name)
+            rel_path = os.path.relpath(full_path, src).replace(os.sep, '/')
+            bundle_path = f"{prefix}/{rel_path}" if prefix else rel_path
+            files.append((bundle_path, full_path))
+    return files
+
+def pack(output, sources):
+    files = []
+    for src, prefix in sources:
+        if not os.path.isdir(src):
+            print(f"Warning: Source directory does not exist: {src}", file=sys.stderr)
+            continue
+        files.extend(collect_files(src, prefix))
+
+    if not files:
+        print("Error: Nothing to pack", file=sys.stderr)
+        return 1
+
+    slot_count = 1
+    while slot_count < len(files) * 2:
+        slot_count <<= 1
+
+    header_size = struct.calcsize(HEADER_FORMAT)
+    entry_size = struct.calcsize(ENTRY_FORMAT)
+    entries_offset = header_size
+    slots_offset = entries_offset + entry_size * len(files)
+    strings_offset = slots_offset + 4 * slot_count
+
+    strings = bytearray()
+    mime_offsets = {}
+    records = []
+    for bundle_path, full_path in files:
+        path_bytes = bundle_path.encode('utf-8')
+        path_offset = strings_offset + len(strings)
+        strings += path_bytes
+
+        mime = guess_mime_type(bundle_path).encode('utf-8')
+        if mime not in mime_offsets:
+            mime_offsets[mime] = strings_offset + len(strings)
+            strings += mime
+
+        records.append([fnv1a64(path_bytes), 0, os.path.getsize(full_path),
+                        path_offset, len(path_bytes), mime_offsets[mime], len(mime), full_path])
+
+    data_offset = align(strings_offset + len(strings), DATA_ALIGNMENT)
+    for record in records:
+        record[1] = data_offset
+        data_offset = align(data_offset + record[2], DATA_ALIGNMENT)
+
+    slots = [0] * slot_count
+    for index, record in enumerate(records):
+        slot = record[0] & (slot_count - 1)
+        while slots[slot] != 0:
+            slot = (slot + 1) & (slot_count - 1)
+        slots[slot] = index + 1
+
+    os.makedirs(os.path.dirname(os.path.abspath(output)), exist_ok=True)
+    temp_output = output + ".tmp"
+    with open(temp_output, 'wb') as out:
+        out.write(struct.pack(HEADER_FORMAT, MAGIC, VERSION, len(records), slot_count, 0,
+                              entries_offset, slots_offset))
+        for record in records:
+            out.write(struct.pack(ENTRY_FORMAT, *record[:7]))
+        out.write(struct.pack(f"<{slot_count}I", *slots))
+        out.write(strings)
+
+        for record in records:
+            out.write(b'\0' * (record[1] - out.tell()))
+            with open(record[7], 'rb') as src_file:
+                out.write(src_file.read())
+
+    os.replace(temp_output, output)
+    print(f"Packed {len(records)} files ({data_offset} bytes) into {output}")
+    return 0
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3:
+        print("Usage: python pack_bundle.py <output> <source>[=<prefix>] [<source>[=<prefix>] ...]", file=sys.stderr)
+        print("  Files are stored as <prefix>/<path relative to source>, matching the", file=sys.stderr)
+        print("  paths Ultralight requests for file:/// URLs.", file=sys.stderr)
+        print("  Example: pack_bundle.py bin/app.bundle app/build=app/build resources=resources", file=sys.stderr)
+        sys.exit(1)
+
+    output = sys.argv[1]
+    sources = []
+    for arg in sys.argv[2:]:
+        src, _, prefix = arg.partition('=')
+        sources.append((src, prefix.strip('/')))
+
+    sys.exit(pack(output, sources))
@@ -0,0 +1,106 @@
+#include "AsyncReadback.h"
+
+AsyncReadback::AsyncReadback(size_t depth)
+    : m_Slots(depth > 0 ? depth : 1)
+    , m_NextSlot(0)
+{
+    for (Slot& slot : m_Slots)
+        glGenBuffers(1, &slot.pbo);
+}
+
+AsyncReadback::~AsyncReadback()
+{
+    for (Slot& slot : m_Slots)
+    {
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+        glDeleteBuffers(1, &slot.pbo);
+    }
+}
+
+bool AsyncReadback::Issue(uint32_t framebufferID, uint32_t width, uint32_t height, uint64_t tag)
+{
+    if (width == 0 || height == 0)
+        return false;
+
+    Slot& slot = m_Slots[m_NextSlot];
+    if (slot.fence)
+        return false;
+
+    GLint previousReadFramebuffer = 0;
+    GLint previousPackBuffer = 0;
+    GLint previousPackAlignment = 4;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFramebuffer);
+    glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &previousPackBuffer);
+    glGetIntegerv(GL_PACK_ALIGNMENT, &previousPackAlignment);
+
+    size_t size = static_cast<size_t>(width) * height * 4;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebufferID);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    if (slot.capacity < size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_READ);
+        slot.capacity = size;
+    }
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height), GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.width = width;
+    slot.height = height;
+    slot.tag = tag;
+
+    glPixelStorei(GL_PACK_ALIGNMENT, previousPackAlignment);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, static_cast<GLuint>(previousPackBuffer));
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(previousReadFramebuffer));
+
+    m_NextSlot = (m_NextSlot + 1) % m_Slots.size();
+    return true;
+}
+
+void AsyncReadback::Collect(Slot& slot, const Callback& callback)
+{
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    GLint previousPackBuffer = 0;
+    glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &previousPackBuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+
+    size_t size = static_cast<size_t>(slot.width) * slot.height * 4;
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT);
+    callback(static_cast<const uint8_t*>(mapped), slot.width, slot.height, slot.tag);
+    if (mapped)
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, static_cast<GLuint>(previousPackBuffer));
+}
+
+void AsyncReadback::Poll(const Callback& callback)
+{
+    // Oldest first, stopping at the first readback still in flight
+    for (size_t i = 0; i < m_Slots.size(); i++)
+    {
+        Slot& slot = m_Slots[(m_NextSlot + i) % m_Slots.size()];
+        if (!slot.fence)
+            continue;
+
+        GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+
+        Collect(slot, callback);
+    }
+}
+
+void AsyncReadback::Flush(const Callback& callback)
+{
+    for (size_t i = 0; i < m_Slots.size(); i++)
+    {
+        Slot& slot = m_Slots[(m_NextSlot + i) % m_Slots.size()];
+        if (!slot.fence)
+            continue;
+
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        Collect(slot, callback);
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Ring of pixel pack buffers for reading framebuffers back without stalling.
+// Issue() starts a glReadPixels into the next free buffer and fences it;
+// Poll() hands over whichever readbacks the GPU has finished, oldest first.
+class AsyncReadback
+{
+public:
+    // pixels are BGRA8, bottom row first, width * 4 bytes per row, and are
+    // only valid for the duration of the call. pixels is null if the buffer
+    // could not be mapped.
+    using Callback = std::function<void(const uint8_t* pixels, uint32_t width, uint32_t height, uint64_t tag)>;
+
+private:
+    struct Slot
+    {
+        uint32_t pbo = 0;
+        size_t capacity = 0;
+        GLsync fence = nullptr;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint64_t tag = 0;
+    };
+
+    std::vector<Slot> m_Slots;
+    size_t m_NextSlot;
+
+    void Collect(Slot& slot, const Callback& callback);
+
+public:
+    explicit AsyncReadback(size_t depth = 3);
+    ~AsyncReadback();
+
+    AsyncReadback(const AsyncReadback&) = delete;
+    AsyncReadback& operator=(const AsyncReadback&) = delete;
+
+    // Framebuffer 0 reads the back buffer. Returns false, issuing nothing,
+    // if every buffer is still in flight.
+    bool Issue(uint32_t framebufferID, uint32_t width, uint32_t height, uint64_t tag);
+    bool HasFreeSlot() const { return m_Slots[m_NextSlot].fence == nullptr; }
+
+    // Never blocks.
+    void Poll(const Callback& callback);
+    // Waits for every outstanding readback.
+    void Flush(const Callback& callback);
+};
@@ -0,0 +1,312 @@
+#include "BundleFileSystem.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Must match scripts/pack_bundle.py
+static constexpr char BUNDLE_MAGIC[8] = { 'U', 'L', 'B', 'U', 'N', 'D', 'L', 'E' };
+static constexpr uint32_t BUNDLE_VERSION = 1;
+
+#pragma pack(push, 1)
+struct BundleHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t slotCount;
+    uint32_t reserved;
+    uint64_t entriesOffset;
+    uint64_t slotsOffset;
+};
+
+struct BundleFileSystem::Entry
+{
+    uint64_t hash;
+    uint64_t dataOffset;
+    uint64_t dataSize;
+    uint32_t pathOffset;
+    uint32_t pathLength;
+    uint32_t mimeOffset;
+    uint32_t mimeLength;
+};
+#pragma pack(pop)
+
+static uint64_t HashPath(const char* path, size_t length)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= static_cast<uint8_t>(path[i]);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Ultralight passes paths relative to the file system root, but be lenient
+// about leading slashes and Windows separators.
+static std::string NormalizePath(const ultralight::String& path)
+{
+    std::string result = path.utf8().data();
+    for (char& c : result)
+    {
+        if (c == '\\')
+            c = '/';
+    }
+
+    size_t start = 0;
+    while (start < result.size() && (result[start] == '/' || (result[start] == '.' && result.compare(start, 2, "./") == 0)))
+        start += result[start] == '.' ? 2 : 1;
+
+    return result.substr(start);
+}
+
+static void NoopDestroyBuffer(void* userData, void* data)
+{
+}
+
+BundleFileSystem::BundleFileSystem()
+    : m_Data(nullptr)
+    , m_Size(0)
+    , m_Entries(nullptr)
+    , m_Slots(nullptr)
+    , m_EntryCount(0)
+    , m_SlotCount(0)
+    , m_Fallback(nullptr)
+#ifdef _WIN32
+    , m_FileHandle(nullptr)
+    , m_MappingHandle(nullptr)
+#else
+    , m_FileDescriptor(-1)
+#endif
+{
+}
+
+BundleFileSystem::~BundleFileSystem()
+{
+    Close();
+}
+
+bool BundleFileSystem::Open(const std::string& path)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_FileHandle = file;
+    m_MappingHandle = mapping;
+    m_Data = static_cast<const uint8_t*>(view);
+    m_Size = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+
+    m_FileDescriptor = fd;
+    m_Data = static_cast<const uint8_t*>(view);
+    m_Size = static_cast<size_t>(info.st_size);
+#endif
+
+    if (!Validate())
+    {
+        std::cerr << "[Bundle] Invalid bundle: " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    std::cout << "[Bundle] Mapped " << m_EntryCount << " files from " << path << std::endl;
+    return true;
+}
+
+void BundleFileSystem::Close()
+{
+    if (!m_Data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_Data);
+    CloseHandle(m_MappingHandle);
+    CloseHandle(m_FileHandle);
+    m_MappingHandle = nullptr;
+    m_FileHandle = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(m_Data), m_Size);
+    close(m_FileDescriptor);
+    m_FileDescriptor = -1;
+#endif
+
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Entries = nullptr;
+    m_Slots = nullptr;
+    m_EntryCount = 0;
+    m_SlotCount = 0;
+}
+
+bool BundleFileSystem::Validate()
+{
+    if (m_Size < sizeof(BundleHeader))
+        return false;
+
+    BundleHeader header;
+    std::memcpy(&header, m_Data, sizeof(header));
+    if (std::memcmp(header.magic, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC)) != 0 || header.version != BUNDLE_VERSION)
+        return false;
+
+    // Slot count must be a power of two with at least one free slot
+    if (header.slotCount == 0 || (header.slotCount & (header.slotCount - 1)) != 0 ||
+        header.slotCount <= header.entryCount)
+        return false;
+
+    if (header.entriesOffset > m_Size ||
+        (m_Size - header.entriesOffset) / sizeof(Entry) < header.entryCount ||
+        header.slotsOffset > m_Size ||
+        (m_Size - header.slotsOffset) / sizeof(uint32_t) < header.slotCount ||
+        header.slotsOffset % alignof(uint32_t) != 0)
+        return false;
+
+    const Entry* entries = reinterpret_cast<const Entry*>(m_Data + header.entriesOffset);
+    for (uint32_t i = 0; i < header.entryCount; i++)
+    {
+        const Entry& entry = entries[i];
+        if (entry.dataOffset > m_Size || entry.dataSize > m_Size - entry.dataOffset ||
+            entry.pathOffset > m_Size || entry.pathLength > m_Size - entry.pathOffset ||
+            entry.mimeOffset > m_Size || entry.mimeLength > m_Size - entry.mimeOffset)
+            return false;
+    }
+
+    // Every entry in at most one slot, and some slot empty to end a probe
+    const uint32_t* slots = reinterpret_cast<const uint32_t*>(m_Data + header.slotsOffset);
+    std::vector<bool> used(header.entryCount, false);
+    bool anyEmpty = false;
+    for (uint32_t slot = 0; slot < header.slotCount; slot++)
+    {
+        uint32_t index = slots[slot];
+        if (index == 0)
+        {
+            anyEmpty = true;
+            continue;
+        }
+        if (index > header.entryCount || used[index - 1])
+            return false;
+        used[index - 1] = true;
+    }
+    if (!anyEmpty)
+        return false;
+
+    m_Entries = entries;
+    m_Slots = slots;
+    m_EntryCount = header.entryCount;
+    m_SlotCount = header.slotCount;
+    return true;
+}
+
+const BundleFileSystem::Entry* BundleFileSystem::FindEntry(const ultralight::String& path) const
+{
+    if (!m_Data)
+        return nullptr;
+
+    std::string key = NormalizePath(path);
+    uint64_t hash = HashPath(key.data(), key.size());
+
+    // Validate guarantees an empty slot; the bound is a second line of defence
+    uint32_t mask = m_SlotCount - 1;
+    uint32_t slot = static_cast<uint32_t>(hash) & mask;
+    for (uint32_t probe = 0; probe < m_SlotCount; probe++, slot = (slot + 1) & mask)
+    {
+        uint32_t index = m_Slots[slot];
+        if (index == 0 || index > m_EntryCount)
+            return nullptr;
+
+        const Entry& entry = m_Entries[index - 1];
+        if (entry.hash == hash && entry.pathLength == key.size() &&
+            std::memcmp(m_Data + entry.pathOffset, key.data(), key.size()) == 0)
+            return &entry;
+    }
+    return nullptr;
+}
+
+bool BundleFileSystem::FileExists(const ultralight::String& file_path)
+{
+    if (FindEntry(file_path))
+        return true;
+
+    return m_Fallback && m_Fallback->FileExists(file_path);
+}
+
+ultralight::String BundleFileSystem::GetFileMimeType(const ultralight::String& file_path)
+{
+    if (const Entry* entry = FindEntry(file_path))
+        return ultralight::String(reinterpret_cast<const char*>(m_Data + entry->mimeOffset), entry->mimeLength);
+
+    if (m_Fallback)
+        return m_Fallback->GetFileMimeType(file_path);
+
+    return "application/octet-stream";
+}
+
+ultralight::String BundleFileSystem::GetFileCharset(const ultralight::String& file_path)
+{
+    if (!FindEntry(file_path) && m_Fallback)
+        return m_Fallback->GetFileCharset(file_path);
+
+    return "utf-8";
+}
+
+ultralight::RefPtr<ultralight::Buffer> BundleFileSystem::OpenFile(const ultralight::String& file_path)
+{
+    if (const Entry* entry = FindEntry(file_path))
+    {
+        // The mapping lives as long as this file system, so hand out a view
+        void* data = const_cast<uint8_t*>(m_Data + entry->dataOffset);
+        return ultralight::Buffer::Create(data, static_cast<size_t>(entry->dataSize), nullptr, NoopDestroyBuffer);
+    }
+
+    if (m_Fallback)
+        return m_Fallback->OpenFile(file_path);
+
+    return nullptr;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Ultralight/Ultralight.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Serves files out of a single memory-mapped archive written by
+// scripts/pack_bundle.py. Lookups hash the path into the archive's slot
+// table, and OpenFile hands Ultralight a view into the mapping without
+// copying. Paths missing from the bundle go to the fallback file system.
+class BundleFileSystem : public ultralight::FileSystem
+{
+private:
+    struct Entry;
+
+    const uint8_t* m_Data;
+    size_t m_Size;
+    const Entry* m_Entries;
+    const uint32_t* m_Slots;
+    uint32_t m_EntryCount;
+    uint32_t m_SlotCount;
+    ultralight::FileSystem* m_Fallback;
+#ifdef _WIN32
+    void* m_FileHandle;
+    void* m_MappingHandle;
+#else
+    int m_FileDescriptor;
+#endif
+
+    const Entry* FindEntry(const ultralight::String& path) const;
+    bool Validate();
+
+public:
+    BundleFileSystem();
+    ~BundleFileSystem() override;
+
+    BundleFileSystem(const BundleFileSystem&) = delete;
+    BundleFileSystem& operator=(const BundleFileSystem&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return m_Data != nullptr; }
+    uint32_t GetFileCount() const { return m_EntryCount; }
+
+    // Not owned; must outlive this file system.
+    void SetFallback(ultralight::FileSystem* fallback) { m_Fallback = fallback; }
+
+    bool FileExists(const ultralight::String& file_path) override;
+    ultralight::String GetFileMimeType(const ultralight::String& file_path) override;
+    ultralight::String GetFileCharset(const ultralight::String& file_path) override;
+    ultralight::RefPtr<ultralight::Buffer> OpenFile(const ultralight::String& file_path) override;
+};
@@ -0,0 +1,176 @@
+#include "ColorConvert.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COLORCONVERT_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace ColorConvert
+{
+    // BT.601 limited range in 8.8 fixed point
+    static inline uint8_t LumaFromBGR(int b, int g, int r)
+    {
+        return static_cast<uint8_t>(((25 * b + 129 * g + 66 * r + 128) >> 8) + 16);
+    }
+
+    static inline uint8_t ChromaUFromBGR(int b, int g, int r)
+    {
+        return static_cast<uint8_t>(((112 * b - 74 * g - 38 * r + 128) >> 8) + 128);
+    }
+
+    static inline uint8_t ChromaVFromBGR(int b, int g, int r)
+    {
+        return static_cast<uint8_t>(((-18 * b - 94 * g + 112 * r + 128) >> 8) + 128);
+    }
+
+    static void ConvertRowPairScalar(const uint8_t* row0, const uint8_t* row1, uint32_t begin, uint32_t width,
+                                     uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v)
+    {
+        for (uint32_t x = begin; x < width; x += 2)
+        {
+            const uint8_t* a = row0 + x * 4;
+            const uint8_t* b = row1 + x * 4;
+            // An odd width repeats the last column into its chroma block
+            uint32_t right = x + 1 < width ? 4 : 0;
+            y0[x] = LumaFromBGR(a[0], a[1], a[2]);
+            y1[x] = LumaFromBGR(b[0], b[1], b[2]);
+            if (right)
+            {
+                y0[x + 1] = LumaFromBGR(a[4], a[5], a[6]);
+                y1[x + 1] = LumaFromBGR(b[4], b[5], b[6]);
+            }
+
+            int blue = (a[0] + a[right] + b[0] + b[right] + 2) >> 2;
+            int green = (a[1] + a[right + 1] + b[1] + b[right + 1] + 2) >> 2;
+            int red = (a[2] + a[right + 2] + b[2] + b[right + 2] + 2) >> 2;
+            u[x / 2] = ChromaUFromBGR(blue, green, red);
+            v[x / 2] = ChromaVFromBGR(blue, green, red);
+        }
+    }
+
+#ifdef COLORCONVERT_SSE2
+    // m0 and m1 hold pmaddwd results for two pixels each, [lo, hi] per pixel;
+    // returns the four per-pixel sums in order.
+    static inline __m128i SumPixelPairs(__m128i m0, __m128i m1)
+    {
+        __m128 even = _mm_shuffle_ps(_mm_castsi128_ps(m0), _mm_castsi128_ps(m1), _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 odd = _mm_shuffle_ps(_mm_castsi128_ps(m0), _mm_castsi128_ps(m1), _MM_SHUFFLE(3, 1, 3, 1));
+        return _mm_add_epi32(_mm_castps_si128(even), _mm_castps_si128(odd));
+    }
+
+    // Eight pixels of luma from 32 bytes of BGRA
+    static inline __m128i Luma8(__m128i lo, __m128i hi, __m128i coefficients, __m128i bias)
+    {
+        __m128i zero = _mm_setzero_si128();
+        __m128i y03 = SumPixelPairs(_mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), coefficients),
+                                    _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), coefficients));
+        __m128i y47 = SumPixelPairs(_mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), coefficients),
+                                    _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), coefficients));
+        y03 = _mm_srai_epi32(_mm_add_epi32(y03, bias), 8);
+        y47 = _mm_srai_epi32(_mm_add_epi32(y47, bias), 8);
+        __m128i y16 = _mm_add_epi16(_mm_packs_epi32(y03, y47), _mm_set1_epi16(16));
+        return _mm_packus_epi16(y16, y16);
+    }
+
+    // Sums a column pair of two-pixel registers, then the two pixels in each,
+    // leaving one 2x2 block average per 64-bit half.
+    static inline __m128i Average2x2(__m128i top01, __m128i bottom01, __m128i top23, __m128i bottom23)
+    {
+        __m128i s01 = _mm_add_epi16(top01, bottom01);
+        __m128i s23 = _mm_add_epi16(top23, bottom23);
+        s01 = _mm_add_epi16(s01, _mm_srli_si128(s01, 8));
+        s23 = _mm_add_epi16(s23, _mm_srli_si128(s23, 8));
+        __m128i blocks = _mm_unpacklo_epi64(s01, s23);
+        return _mm_srli_epi16(_mm_add_epi16(blocks, _mm_set1_epi16(2)), 2);
+    }
+
+    static inline __m128i Chroma4(__m128i blocks01, __m128i blocks23, __m128i coefficients, __m128i bias)
+    {
+        __m128i sum = SumPixelPairs(_mm_madd_epi16(blocks01, coefficients), _mm_madd_epi16(blocks23, coefficients));
+        return _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(sum, bias), 8), _mm_set1_epi32(128));
+    }
+
+    // Returns the first column left for the scalar tail.
+    static uint32_t ConvertRowPairSSE2(const uint8_t* row0, const uint8_t* row1, uint32_t width,
+                                       uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v)
+    {
+        const __m128i lumaCoefficients = _mm_setr_epi16(25, 129, 66, 0, 25, 129, 66, 0);
+        const __m128i uCoefficients = _mm_setr_epi16(112, -74, -38, 0, 112, -74, -38, 0);
+        const __m128i vCoefficients = _mm_setr_epi16(-18, -94, 112, 0, -18, -94, 112, 0);
+        const __m128i bias = _mm_set1_epi32(128);
+        const __m128i zero = _mm_setzero_si128();
+
+        uint32_t x = 0;
+        for (; x + 8 <= width; x += 8)
+        {
+            __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 4));
+            __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 4 + 16));
+            __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 4));
+            __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 4 + 16));
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(y0 + x), Luma8(a0, a1, lumaCoefficients, bias));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(y1 + x), Luma8(b0, b1, lumaCoefficients, bias));
+
+            __m128i blocks01 = Average2x2(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero),
+                                          _mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+            __m128i blocks23 = Average2x2(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero),
+                                          _mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+            __m128i uv = _mm_packs_epi32(Chroma4(blocks01, blocks23, uCoefficients, bias),
+                                         Chroma4(blocks01, blocks23, vCoefficients, bias));
+            uv = _mm_packus_epi16(uv, uv);
+            uint8_t uvBytes[8];
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(uvBytes), uv);
+            std::memcpy(u + x / 2, uvBytes, 4);
+            std::memcpy(v + x / 2, uvBytes + 4, 4);
+        }
+        return x;
+    }
+#endif
+
+    static void Convert(const uint8_t* bgra, ptrdiff_t stride, uint32_t width, uint32_t height,
+                        uint8_t* y, uint32_t yStride, uint8_t* u, uint8_t* v, uint32_t uvStride, bool useSIMD)
+    {
+        for (uint32_t row = 0; row < height; row += 2)
+        {
+            // An odd height pairs the last row with itself
+            bool single = row + 1 == height;
+            const uint8_t* row0 = bgra + static_cast<ptrdiff_t>(row) * stride;
+            const uint8_t* row1 = single ? row0 : row0 + stride;
+            uint8_t* y0 = y + static_cast<size_t>(row) * yStride;
+            uint8_t* y1 = single ? y0 : y0 + yStride;
+            uint8_t* uRow = u + static_cast<size_t>(row / 2) * uvStride;
+            uint8_t* vRow = v + static_cast<size_t>(row / 2) * uvStride;
+
+            uint32_t begin = 0;
+#ifdef COLORCONVERT_SSE2
+            if (useSIMD)
+                begin = ConvertRowPairSSE2(row0, row1, width, y0, y1, uRow, vRow);
+#endif
+            ConvertRowPairScalar(row0, row1, begin, width, y0, y1, uRow, vRow);
+        }
+    }
+
+    void BGRAToI420(const uint8_t* bgra, ptrdiff_t stride, uint32_t width, uint32_t height,
+                    uint8_t* y, uint32_t yStride, uint8_t* u, uint8_t* v, uint32_t uvStride)
+    {
+        Convert(bgra, stride, width, height, y, yStride, u, v, uvStride, true);
+    }
+
+    void BGRAToI420Scalar(const uint8_t* bgra, ptrdiff_t stride, uint32_t width, uint32_t height,
+                          uint8_t* y, uint32_t yStride, uint8_t* u, uint8_t* v, uint32_t uvStride)
+    {
+        Convert(bgra, stride, width, height, y, yStride, u, v, uvStride, false);
+    }
+
+    bool HasSIMD()
+    {
+#ifdef COLORCONVERT_SSE2
+        return true;
+#else
+        return false;
+#endif
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ColorConvert
+{
+    // Converts BGRA8 to planar I420: BT.601 limited range, with chroma taken
+    // from the average of each 2x2 block. The chroma planes are
+    // ceil(width / 2) x ceil(height / 2); an odd last column or row is
+    // averaged with itself. A negative stride walks the source bottom-up,
+    // which turns a GL readback the right way up for free. Uses SSE2 where
+    // available.
+    void BGRAToI420(const uint8_t* bgra, ptrdiff_t stride, uint32_t width, uint32_t height,
+                    uint8_t* y, uint32_t yStride, uint8_t* u, uint8_t* v, uint32_t uvStride);
+
+    // Plain C++ reference; bench/colorconvert_bench.cpp checks that both
+    // produce the same output.
+    void BGRAToI420Scalar(const uint8_t* bgra, ptrdiff_t stride, uint32_t width, uint32_t height,
+                          uint8_t* y, uint32_t yStride, uint8_t* u, uint8_t* v, uint32_t uvStride);
+
+    bool HasSIMD();
+}
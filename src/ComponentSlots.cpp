@@ -0,0 +1,48 @@
+#include "ComponentSlots.h"
+
+uint32_t ComponentSlotRegistry::Acquire(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Handles.find(name);
+    if (it != m_Handles.end())
+        return it->second;
+
+    m_State.entries.emplace_back();
+    m_State.version++;
+    uint32_t handle = static_cast<uint32_t>(m_State.entries.size());
+    m_Handles.emplace(name, handle);
+    return handle;
+}
+
+bool ComponentSlotRegistry::Set(uint32_t handle, const ComponentSlot& slot)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (handle == 0 || handle > m_State.entries.size())
+        return false;
+
+    ComponentSlotSnapshot::Entry& entry = m_State.entries[handle - 1];
+    if (entry.slot != slot)
+    {
+        entry.slot = slot;
+        entry.version++;
+        m_State.version++;
+    }
+    return true;
+}
+
+bool ComponentSlotRegistry::CopyTo(ComponentSlotSnapshot& snapshot) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (snapshot.version == m_State.version)
+        return false;
+
+    snapshot.version = m_State.version;
+    snapshot.entries.assign(m_State.entries.begin(), m_State.entries.end());
+    return true;
+}
+
+uint64_t ComponentSlotRegistry::GetVersion() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_State.version;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Where a native component is drawn, in view pixels, as laid out by the page.
+struct ComponentSlot
+{
+    float x = 0;
+    float y = 0;
+    float width = 0;
+    float height = 0;
+    bool visible = false;
+
+    bool operator==(const ComponentSlot& other) const
+    {
+        return x == other.x && y == other.y && width == other.width &&
+               height == other.height && visible == other.visible;
+    }
+    bool operator!=(const ComponentSlot& other) const { return !(*this == other); }
+};
+
+// Every slot as of one moment. Handles start at 1 and index the entries;
+// each entry's version changes with its slot, and the snapshot's version
+// with any of them, so a consumer can tell what moved without comparing.
+struct ComponentSlotSnapshot
+{
+    struct Entry
+    {
+        ComponentSlot slot;
+        uint32_t version = 0;
+    };
+
+    uint64_t version = 0;
+    std::vector<Entry> entries;
+
+    // Null for a handle no page has asked for yet
+    const ComponentSlot* Get(uint32_t handle) const
+    {
+        return handle > 0 && handle <= entries.size() ? &entries[handle - 1].slot : nullptr;
+    }
+    uint32_t GetVersion(uint32_t handle) const
+    {
+        return handle > 0 && handle <= entries.size() ? entries[handle - 1].version : 0;
+    }
+};
+
+// Slots written by the page as its layout changes and read by the frame
+// that composites it, possibly on another thread.
+class ComponentSlotRegistry
+{
+private:
+    mutable std::mutex m_Mutex;
+    std::unordered_map<std::string, uint32_t> m_Handles;
+    ComponentSlotSnapshot m_State;
+
+public:
+    // The handle for a name, the same every time and for every page.
+    uint32_t Acquire(const std::string& name);
+    // False for an unknown handle. Setting the same rect again is not a change.
+    bool Set(uint32_t handle, const ComponentSlot& slot);
+    // Brings the snapshot up to date; false if it already was.
+    bool CopyTo(ComponentSlotSnapshot& snapshot) const;
+    uint64_t GetVersion() const;
+};
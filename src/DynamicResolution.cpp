@@ -0,0 +1,166 @@
+#include "DynamicResolution.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+
+// Samples that must agree before the scale moves, and how many to ignore
+// afterwards while queries issued at the old size drain.
+static constexpr uint32_t SAMPLES_TO_SCALE_DOWN = 3;
+static constexpr uint32_t SAMPLES_TO_SCALE_UP = 30;
+static constexpr uint32_t COOLDOWN_SAMPLES = 8;
+// Scale up only when comfortably under budget, and aim below it either way.
+static constexpr double SCALE_UP_THRESHOLD = 0.6;
+static constexpr double TARGET_FRACTION = 0.85;
+static constexpr double SMOOTHING = 0.2;
+
+DynamicResolution::DynamicResolution()
+    : m_Queries{}
+    , m_QueryPending{}
+    , m_NextQuery(0)
+    , m_QueryActive(false)
+    , m_HasTimerQueries(GLAD_GL_VERSION_3_3 != 0)
+    , m_Scale(2.0f)
+    , m_MinScale(0.5f)
+    , m_MaxScale(2.0f)
+    , m_Step(0.125f)
+    , m_Budget(4.0)
+    , m_CPUTime(0.0)
+    , m_GPUTime(0.0)
+    , m_SmoothedTime(0.0)
+    , m_HasNewSample(false)
+    , m_OverBudgetSamples(0)
+    , m_UnderBudgetSamples(0)
+    , m_Cooldown(0)
+{
+    if (m_HasTimerQueries)
+        glGenQueries(static_cast<GLsizei>(QUERY_COUNT), m_Queries.data());
+}
+
+DynamicResolution::~DynamicResolution()
+{
+    if (m_HasTimerQueries)
+        glDeleteQueries(static_cast<GLsizei>(QUERY_COUNT), m_Queries.data());
+}
+
+void DynamicResolution::SetScaleRange(float minScale, float maxScale)
+{
+    m_MinScale = std::max(minScale, 0.01f);
+    m_MaxScale = std::max(maxScale, m_MinScale);
+    m_Scale = m_MaxScale;
+    m_Cooldown = COOLDOWN_SAMPLES;
+}
+
+void DynamicResolution::BeginSample()
+{
+    m_CPUStart = std::chrono::steady_clock::now();
+
+    // If the oldest query has still not landed, skip GPU timing for this
+    // pass rather than wait on it.
+    m_QueryActive = m_HasTimerQueries && !m_QueryPending[m_NextQuery];
+    if (m_QueryActive)
+        glBeginQuery(GL_TIME_ELAPSED, m_Queries[m_NextQuery]);
+}
+
+void DynamicResolution::EndSample()
+{
+    if (m_QueryActive)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_QueryPending[m_NextQuery] = true;
+        m_NextQuery = (m_NextQuery + 1) % QUERY_COUNT;
+        m_QueryActive = false;
+    }
+
+    m_CPUTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_CPUStart).count();
+    m_HasNewSample = true;
+}
+
+void DynamicResolution::CollectQueries()
+{
+    // Oldest first, stopping at the first one still in flight
+    for (size_t i = 0; i < QUERY_COUNT; i++)
+    {
+        size_t index = (m_NextQuery + i) % QUERY_COUNT;
+        if (!m_QueryPending[index])
+            continue;
+
+        GLuint available = 0;
+        glGetQueryObjectuiv(m_Queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(m_Queries[index], GL_QUERY_RESULT, &elapsed);
+        m_GPUTime = static_cast<double>(elapsed) / 1.0e6;
+        m_QueryPending[index] = false;
+    }
+}
+
+float DynamicResolution::Quantize(float scale) const
+{
+    if (m_Step > 0.0f)
+        scale = std::round(scale / m_Step) * m_Step;
+    return std::clamp(scale, m_MinScale, m_MaxScale);
+}
+
+bool DynamicResolution::Update()
+{
+    if (m_HasTimerQueries)
+        CollectQueries();
+
+    if (!m_HasNewSample)
+        return false;
+    m_HasNewSample = false;
+
+    double sample = std::max(m_CPUTime, m_GPUTime);
+    m_SmoothedTime = m_SmoothedTime > 0.0 ? m_SmoothedTime + (sample - m_SmoothedTime) * SMOOTHING : sample;
+
+    if (m_Cooldown > 0)
+    {
+        m_Cooldown--;
+        return false;
+    }
+
+    if (m_SmoothedTime > m_Budget)
+    {
+        m_UnderBudgetSamples = 0;
+        if (++m_OverBudgetSamples < SAMPLES_TO_SCALE_DOWN)
+            return false;
+    }
+    else if (m_SmoothedTime < m_Budget * SCALE_UP_THRESHOLD)
+    {
+        m_OverBudgetSamples = 0;
+        if (++m_UnderBudgetSamples < SAMPLES_TO_SCALE_UP)
+            return false;
+    }
+    else
+    {
+        m_OverBudgetSamples = 0;
+        m_UnderBudgetSamples = 0;
+        return false;
+    }
+
+    m_OverBudgetSamples = 0;
+    m_UnderBudgetSamples = 0;
+
+    // Cost grows with pixel count, i.e. with the square of the scale. Step
+    // up by at most one increment at a time, since an underestimate there
+    // costs a visible hitch.
+    double ratio = std::sqrt(m_Budget * TARGET_FRACTION / std::max(m_SmoothedTime, 0.001));
+    float desired = static_cast<float>(m_Scale * ratio);
+    if (desired > m_Scale)
+        desired = std::min(desired, m_Scale + std::max(m_Step, 0.01f));
+
+    float scale = Quantize(desired);
+    if (m_SmoothedTime > m_Budget && scale >= m_Scale)
+        scale = Quantize(m_Scale - m_Step);
+    if (scale == m_Scale)
+        return false;
+
+    // Predict the cost at the new size until real samples arrive
+    double change = static_cast<double>(scale) / static_cast<double>(m_Scale);
+    m_SmoothedTime *= change * change;
+    m_Scale = scale;
+    m_Cooldown = COOLDOWN_SAMPLES;
+    return true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+// Picks the render scale of a component's framebuffer so its render pass
+// stays within a time budget. Each pass is timed on the CPU and, where
+// GL_TIME_ELAPSED queries are available, on the GPU; results are read back
+// a few frames late so timing never stalls the pipeline.
+//
+// The scale only moves after the cost has stayed outside the budget for
+// several samples, in fixed steps, and then holds for a cooldown, so the
+// framebuffer is resized rarely rather than every frame.
+class DynamicResolution
+{
+private:
+    static constexpr size_t QUERY_COUNT = 4;
+
+    std::array<uint32_t, QUERY_COUNT> m_Queries;
+    std::array<bool, QUERY_COUNT> m_QueryPending;
+    size_t m_NextQuery;
+    bool m_QueryActive;
+    bool m_HasTimerQueries;
+    std::chrono::steady_clock::time_point m_CPUStart;
+
+    float m_Scale;
+    float m_MinScale;
+    float m_MaxScale;
+    float m_Step;
+    double m_Budget;
+
+    double m_CPUTime;
+    double m_GPUTime;
+    double m_SmoothedTime;
+    bool m_HasNewSample;
+    uint32_t m_OverBudgetSamples;
+    uint32_t m_UnderBudgetSamples;
+    uint32_t m_Cooldown;
+
+    void CollectQueries();
+    float Quantize(float scale) const;
+
+public:
+    DynamicResolution();
+    ~DynamicResolution();
+
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    // Scale factors relative to the component's on-screen size. The scale
+    // starts at the maximum.
+    void SetScaleRange(float minScale, float maxScale);
+    // Resize granularity, in scale units.
+    void SetStep(float step) { m_Step = step; }
+    void SetBudget(double milliseconds) { m_Budget = milliseconds; }
+
+    // Bracket the component's render pass.
+    void BeginSample();
+    void EndSample();
+
+    // Feeds completed samples into the controller. Returns true when the
+    // scale changed and the framebuffer should be resized.
+    bool Update();
+
+    float GetScale() const { return m_Scale; }
+    double GetCPUTime() const { return m_CPUTime; }
+    double GetGPUTime() const { return m_GPUTime; }
+    bool HasGPUTimer() const { return m_HasTimerQueries; }
+};
@@ -0,0 +1,256 @@
+#include "FontCache.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+static std::string ToLower(std::string text)
+{
+    for (char& c : text)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return text;
+}
+
+static uint32_t DecodeFirstCodePoint(const ultralight::String& text)
+{
+    ultralight::String8 utf8 = text.utf8();
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(utf8.data());
+    size_t length = utf8.length();
+    if (length == 0)
+        return 0;
+
+    unsigned char lead = bytes[0];
+    size_t count = lead < 0x80 ? 0 : lead < 0xE0 ? 1 : lead < 0xF0 ? 2 : 3;
+    if (count >= length)
+        return lead;
+
+    uint32_t codePoint = count == 0 ? lead : lead & (0x3F >> count);
+    for (size_t i = 1; i <= count; i++)
+        codePoint = (codePoint << 6) | (bytes[i] & 0x3F);
+    return codePoint;
+}
+
+static void FreeFontData(void* userData, void* data)
+{
+    std::free(data);
+}
+
+FontCache::FontCache()
+    : m_FallbackFont("Arial")
+    , m_FileSystem(nullptr)
+    , m_PlatformLoader(nullptr)
+{
+}
+
+void FontCache::Declare(const std::string& family, int weight, bool italic, const std::string& path)
+{
+    m_Declarations.push_back({ family, weight, italic, path });
+}
+
+void FontCache::DeclareFallback(uint32_t first, uint32_t last, const std::string& family)
+{
+    m_FallbackRanges.push_back({ first, last, family });
+}
+
+ultralight::RefPtr<ultralight::FontFile> FontCache::LoadFromPath(const std::string& path) const
+{
+    if (m_FileSystem && m_FileSystem->FileExists(path.c_str()))
+    {
+        ultralight::RefPtr<ultralight::Buffer> buffer = m_FileSystem->OpenFile(path.c_str());
+        if (buffer)
+            return ultralight::FontFile::Create(buffer);
+    }
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return nullptr;
+
+    std::streamsize size = file.tellg();
+    if (size <= 0)
+        return nullptr;
+
+    void* data = std::malloc(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!data || !file.read(static_cast<char*>(data), size))
+    {
+        std::free(data);
+        return nullptr;
+    }
+
+    return ultralight::FontFile::Create(
+        ultralight::Buffer::Create(data, static_cast<size_t>(size), nullptr, FreeFontData));
+}
+
+ultralight::RefPtr<ultralight::FontFile> FontCache::LoadFromPlatform(const std::string& family, int weight, bool italic) const
+{
+    if (!m_PlatformLoader)
+        return nullptr;
+
+    ultralight::RefPtr<ultralight::FontFile> file = m_PlatformLoader->Load(family.c_str(), weight, italic);
+    if (!file || file->is_in_memory())
+        return file;
+
+    // Pull the face into memory now so Ultralight never reads it later
+    ultralight::RefPtr<ultralight::FontFile> resident = LoadFromPath(file->filepath().utf8().data());
+    return resident ? resident : file;
+}
+
+const FontCache::Face* FontCache::FindFace(const std::string& family, int weight, bool italic) const
+{
+    auto it = m_Faces.find(ToLower(family));
+    if (it == m_Faces.end())
+        return nullptr;
+
+    for (const Face& face : it->second)
+    {
+        if (face.weight == weight && face.italic == italic)
+            return &face;
+    }
+    return nullptr;
+}
+
+void FontCache::AddFace(const std::string& family, int weight, bool italic,
+                        ultralight::RefPtr<ultralight::FontFile> file)
+{
+    m_Faces[ToLower(family)].push_back({ weight, italic, std::move(file) });
+}
+
+size_t FontCache::Preload(ultralight::FileSystem* fileSystem, ultralight::FontLoader* platformLoader)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_FileSystem = fileSystem;
+    m_PlatformLoader = platformLoader;
+
+    size_t failed = 0;
+    for (const Declaration& declaration : m_Declarations)
+    {
+        if (FindFace(declaration.family, declaration.weight, declaration.italic))
+            continue;
+
+        ultralight::RefPtr<ultralight::FontFile> file = declaration.path.empty()
+            ? LoadFromPlatform(declaration.family, declaration.weight, declaration.italic)
+            : LoadFromPath(declaration.path);
+        if (!file)
+        {
+            std::cerr << "[FontCache] Could not load " << declaration.family << " " << declaration.weight
+                      << (declaration.italic ? " italic" : "")
+                      << (declaration.path.empty() ? "" : " from " + declaration.path) << std::endl;
+            failed++;
+            continue;
+        }
+
+        AddFace(declaration.family, declaration.weight, declaration.italic, std::move(file));
+    }
+
+    // Resolve the fallback families too, so the first glyph outside the
+    // declared faces does not stall.
+    for (const FallbackRange& range : m_FallbackRanges)
+    {
+        for (int weight : { 400, 700 })
+        {
+            if (!FindFace(range.family, weight, false))
+            {
+                if (ultralight::RefPtr<ultralight::FontFile> file = LoadFromPlatform(range.family, weight, false))
+                    AddFace(range.family, weight, false, std::move(file));
+            }
+        }
+    }
+
+    size_t count = 0;
+    for (const auto& [family, faces] : m_Faces)
+        count += faces.size();
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[FontCache] Preloaded " << count << " font faces in " << ms << " ms";
+    if (failed > 0)
+        std::cout << " (" << failed << " failed)";
+    std::cout << std::endl;
+    return count;
+}
+
+size_t FontCache::GetFaceCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    size_t count = 0;
+    for (const auto& [family, faces] : m_Faces)
+        count += faces.size();
+    return count;
+}
+
+void FontCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Faces.clear();
+    m_FallbackCache.clear();
+    m_FileSystem = nullptr;
+    m_PlatformLoader = nullptr;
+}
+
+ultralight::String FontCache::fallback_font() const
+{
+    return m_FallbackFont.c_str();
+}
+
+ultralight::String FontCache::fallback_font_for_characters(const ultralight::String& characters,
+                                                           int weight, bool italic) const
+{
+    uint32_t codePoint = DecodeFirstCodePoint(characters);
+    for (const FallbackRange& range : m_FallbackRanges)
+    {
+        if (codePoint >= range.first && codePoint <= range.last)
+            return range.family.c_str();
+    }
+
+    if (!m_PlatformLoader)
+        return fallback_font();
+
+    // Scripts live in contiguous blocks, so one platform answer per 128 code
+    // points is close enough and keeps repeat queries off fontconfig.
+    uint64_t key = (static_cast<uint64_t>(codePoint >> 7) << 16) | (static_cast<uint64_t>(weight) << 1) | (italic ? 1 : 0);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_FallbackCache.find(key);
+    if (it == m_FallbackCache.end())
+    {
+        ultralight::String family = m_PlatformLoader->fallback_font_for_characters(characters, weight, italic);
+        it = m_FallbackCache.emplace(key, family.utf8().data()).first;
+    }
+    return it->second.c_str();
+}
+
+ultralight::RefPtr<ultralight::FontFile> FontCache::Load(const ultralight::String& family, int weight, bool italic)
+{
+    std::string name = family.utf8().data();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (const Face* face = FindFace(name, weight, italic))
+        return face->file;
+
+    ultralight::RefPtr<ultralight::FontFile> file = LoadFromPlatform(name, weight, italic);
+    if (file)
+    {
+        std::cout << "[FontCache] Loaded undeclared face " << name << " " << weight
+                  << (italic ? " italic" : "") << " on demand; declare it to preload" << std::endl;
+        AddFace(name, weight, italic, file);
+        return file;
+    }
+
+    // Nearest weight with the same style among the resident faces
+    auto it = m_Faces.find(ToLower(name));
+    if (it == m_Faces.end())
+        return nullptr;
+
+    const Face* best = nullptr;
+    for (const Face& face : it->second)
+    {
+        if (face.italic != italic)
+            continue;
+        if (!best || std::abs(face.weight - weight) < std::abs(best->weight - weight))
+            best = &face;
+    }
+    return best ? best->file : nullptr;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Ultralight/Ultralight.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// FontLoader that resolves a declared set of faces once, up front, and keeps
+// their data resident so the first use of a weight never touches fontconfig
+// or the disk mid-frame. Faces that were not declared are still resolved
+// through the platform loader on demand, then cached and reported so they
+// can be added to the declared set.
+class FontCache : public ultralight::FontLoader
+{
+private:
+    struct Declaration
+    {
+        std::string family;
+        int weight;
+        bool italic;
+        // Empty to let the platform loader find the face.
+        std::string path;
+    };
+
+    struct Face
+    {
+        int weight;
+        bool italic;
+        ultralight::RefPtr<ultralight::FontFile> file;
+    };
+
+    struct FallbackRange
+    {
+        uint32_t first;
+        uint32_t last;
+        std::string family;
+    };
+
+    std::vector<Declaration> m_Declarations;
+    std::vector<FallbackRange> m_FallbackRanges;
+    std::string m_FallbackFont;
+    ultralight::FileSystem* m_FileSystem;
+    ultralight::FontLoader* m_PlatformLoader;
+
+    // Keyed by lowercased family name.
+    std::unordered_map<std::string, std::vector<Face>> m_Faces;
+    mutable std::unordered_map<uint64_t, std::string> m_FallbackCache;
+    mutable std::mutex m_Mutex;
+
+    ultralight::RefPtr<ultralight::FontFile> LoadFromPath(const std::string& path) const;
+    ultralight::RefPtr<ultralight::FontFile> LoadFromPlatform(const std::string& family, int weight, bool italic) const;
+    const Face* FindFace(const std::string& family, int weight, bool italic) const;
+    void AddFace(const std::string& family, int weight, bool italic,
+                 ultralight::RefPtr<ultralight::FontFile> file);
+
+public:
+    FontCache();
+
+    FontCache(const FontCache&) = delete;
+    FontCache& operator=(const FontCache&) = delete;
+
+    // Record a face to load in Preload. Paths are looked up in the file
+    // system first (so fonts can ship in the app bundle), then on disk.
+    void Declare(const std::string& family, int weight, bool italic, const std::string& path = "");
+    // Answer fallback queries for characters in [first, last] with a family
+    // without asking the platform.
+    void DeclareFallback(uint32_t first, uint32_t last, const std::string& family);
+    void SetFallbackFont(const std::string& family) { m_FallbackFont = family; }
+
+    // Loads every declared face. Neither pointer is owned; both must outlive
+    // the cache. Returns the number of faces now resident.
+    size_t Preload(ultralight::FileSystem* fileSystem, ultralight::FontLoader* platformLoader);
+    size_t GetFaceCount() const;
+    // Drops every resident face. Faces loaded from the file system may point
+    // into its memory, so call this before the file system goes away.
+    void Clear();
+
+    ultralight::String fallback_font() const override;
+    ultralight::String fallback_font_for_characters(const ultralight::String& characters,
+                                                    int weight, bool italic) const override;
+    ultralight::RefPtr<ultralight::FontFile> Load(const ultralight::String& family,
+                                                  int weight, bool italic) override;
+};
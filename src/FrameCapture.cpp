@@ -0,0 +1,164 @@
+#include "FrameCapture.h"
+#include "Framebuffer.h"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// Encodes waiting beyond this are dropped so a slow disk cannot grow memory
+// without bound.
+static constexpr size_t MAX_QUEUED_ENCODES = 8;
+
+FrameCapture::FrameCapture(size_t latency, size_t encoderThreads)
+    : m_Readback(latency)
+    , m_Interval(0.0)
+    , m_OutputDirectory("captures")
+    , m_Format(ImageWriter::Format::PNG)
+    , m_Sequence(0)
+    , m_Written(0)
+    , m_Failed(0)
+    , m_Encoders(encoderThreads, MAX_QUEUED_ENCODES)
+{
+    m_OnReadback = [this](const uint8_t* pixels, uint32_t width, uint32_t height, uint64_t sequence)
+    {
+        Encode(pixels, width, height, sequence);
+    };
+}
+
+FrameCapture::~FrameCapture()
+{
+    Flush();
+}
+
+void FrameCapture::SetRate(double hz)
+{
+    m_Interval = hz > 0.0 ? 1.0 / hz : 0.0;
+    m_LastCapture = std::chrono::steady_clock::time_point();
+}
+
+bool FrameCapture::IsDue() const
+{
+    if (m_Interval <= 0.0)
+        return false;
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_LastCapture).count();
+    return elapsed >= m_Interval;
+}
+
+std::string FrameCapture::MakeCapturePath()
+{
+    auto now = std::chrono::system_clock::now();
+    std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+    int milliseconds = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        now.time_since_epoch()).count() % 1000);
+
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "capture_%04d%02d%02d-%02d%02d%02d-%03d_%06llu",
+                  local.tm_year + 1900, local.tm_mon + 1, local.tm_mday,
+                  local.tm_hour, local.tm_min, local.tm_sec, milliseconds,
+                  static_cast<unsigned long long>(m_Sequence));
+
+    return (std::filesystem::path(m_OutputDirectory) / (std::string(name) + ImageWriter::GetExtension(m_Format))).string();
+}
+
+bool FrameCapture::CaptureIfDue(uint32_t framebufferID, uint32_t width, uint32_t height)
+{
+    if (!IsDue())
+        return false;
+
+    // Keep the cadence even if this capture is dropped
+    m_LastCapture = std::chrono::steady_clock::now();
+
+    if (m_Sequence == 0)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(m_OutputDirectory, error);
+    }
+
+    return Capture(framebufferID, width, height, MakeCapturePath());
+}
+
+bool FrameCapture::Capture(const Framebuffer& framebuffer, const std::string& path)
+{
+    return Capture(framebuffer.GetID(), framebuffer.GetWidth(), framebuffer.GetHeight(), path);
+}
+
+bool FrameCapture::Capture(uint32_t framebufferID, uint32_t width, uint32_t height, const std::string& path)
+{
+    if (!m_Readback.Issue(framebufferID, width, height, m_Sequence))
+    {
+        // Every buffer is still waiting on the GPU
+        m_Stats.dropped++;
+        return false;
+    }
+
+    m_PendingPaths[m_Sequence++] = path;
+    m_Stats.issued++;
+    return true;
+}
+
+void FrameCapture::Encode(const uint8_t* pixels, uint32_t width, uint32_t height, uint64_t sequence)
+{
+    auto it = m_PendingPaths.find(sequence);
+    if (it == m_PendingPaths.end())
+        return;
+    std::string path = std::move(it->second);
+    m_PendingPaths.erase(it);
+
+    if (!pixels)
+    {
+        m_Failed++;
+        return;
+    }
+
+    // GL rows are bottom-up; flip while copying out of the mapped buffer
+    size_t rowBytes = static_cast<size_t>(width) * 4;
+    auto copy = std::make_shared<std::vector<uint8_t>>(rowBytes * height);
+    for (uint32_t row = 0; row < height; row++)
+        std::memcpy(copy->data() + row * rowBytes, pixels + (height - 1 - row) * rowBytes, rowBytes);
+
+    bool queued = m_Encoders.Submit([this, copy, width, height, path = std::move(path)]()
+    {
+        // The window blends alpha like color, so translucent UI leaves the
+        // default framebuffer's alpha below 255; what it shows is opaque.
+        for (size_t i = 3; i < copy->size(); i += 4)
+            (*copy)[i] = 0xFF;
+
+        if (ImageWriter::Write(path, copy->data(), width, height, width * 4))
+            m_Written++;
+        else
+            m_Failed++;
+    });
+
+    if (!queued)
+        m_Stats.dropped++;
+}
+
+void FrameCapture::Poll()
+{
+    m_Readback.Poll(m_OnReadback);
+}
+
+void FrameCapture::Flush()
+{
+    m_Readback.Flush(m_OnReadback);
+    m_Encoders.WaitIdle();
+}
+
+FrameCapture::Stats FrameCapture::GetStats() const
+{
+    Stats stats = m_Stats;
+    stats.written = m_Written.load();
+    stats.failed = m_Failed.load();
+    return stats;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "AsyncReadback.h"
+#include "ImageWriter.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+class Framebuffer;
+
+// Periodic and on-request screenshots that never stall the render thread.
+// Frames are read back through an AsyncReadback ring and the finished
+// pixels are encoded by a pool of worker threads. A capture that finds no
+// free readback buffer, or too long an encode backlog, is dropped instead of
+// waiting.
+class FrameCapture
+{
+public:
+    struct Stats
+    {
+        uint64_t issued = 0;
+        uint64_t dropped = 0;
+        uint64_t written = 0;
+        uint64_t failed = 0;
+    };
+
+private:
+    AsyncReadback m_Readback;
+    std::unordered_map<uint64_t, std::string> m_PendingPaths;
+    AsyncReadback::Callback m_OnReadback;
+
+    double m_Interval;
+    std::chrono::steady_clock::time_point m_LastCapture;
+    std::string m_OutputDirectory;
+    ImageWriter::Format m_Format;
+    uint64_t m_Sequence;
+
+    Stats m_Stats;
+    std::atomic<uint64_t> m_Written;
+    std::atomic<uint64_t> m_Failed;
+    // Last, so its workers are joined before anything they touch goes away
+    ThreadPool m_Encoders;
+
+    void Encode(const uint8_t* pixels, uint32_t width, uint32_t height, uint64_t sequence);
+    std::string MakeCapturePath();
+
+public:
+    // latency is the number of readbacks that may be in flight at once.
+    explicit FrameCapture(size_t latency = 3, size_t encoderThreads = 2);
+    // Waits for outstanding readbacks and encodes. Requires the GL context
+    // to still be current.
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Periodic captures per second for CaptureIfDue; 0 disables them.
+    void SetRate(double hz);
+    void SetOutputDirectory(const std::string& directory) { m_OutputDirectory = directory; }
+    void SetFormat(ImageWriter::Format format) { m_Format = format; }
+
+    bool IsEnabled() const { return m_Interval > 0.0; }
+    double GetInterval() const { return m_Interval; }
+    // True when a periodic capture should be taken on the next frame.
+    bool IsDue() const;
+
+    // Captures into a timestamped file in the output directory if the
+    // periodic interval has elapsed. Framebuffer 0 reads the back buffer, so
+    // call this after compositing and before swapping.
+    bool CaptureIfDue(uint32_t framebufferID, uint32_t width, uint32_t height);
+    // Queues a readback of the framebuffer to the given path. Returns false
+    // if every buffer is still in flight.
+    bool Capture(uint32_t framebufferID, uint32_t width, uint32_t height, const std::string& path);
+    bool Capture(const Framebuffer& framebuffer, const std::string& path);
+
+    // Hands finished readbacks to the encoders. Never blocks; call once a
+    // frame.
+    void Poll();
+    // Blocks until every readback has been encoded and written.
+    void Flush();
+
+    Stats GetStats() const;
+};
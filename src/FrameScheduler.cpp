@@ -0,0 +1,185 @@
+#include "FrameScheduler.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <iostream>
+
+FrameScheduler::FrameScheduler()
+    : m_Mode(Mode::OnDemand)
+    , m_IdleTimeout(0.25)
+    , m_ActiveTimeout(1.0 / 60.0)
+    , m_ActiveLinger(0.5)
+    , m_LastFrameTime(0.0)
+    , m_FrameRequested(true)
+    , m_SwapInterval(-1)
+    , m_RefreshInterval(0.0)
+    , m_FrameInterval(0.0)
+    , m_NextFrameTime(0.0)
+    , m_ReportInterval(5.0)
+    , m_LastReportTime(0.0)
+{
+}
+
+void FrameScheduler::SetActiveTimeout(double seconds, double linger)
+{
+    m_ActiveTimeout = seconds;
+    m_ActiveLinger = linger;
+}
+
+void FrameScheduler::SetSwapInterval(int interval)
+{
+    glfwSwapInterval(interval);
+    m_SwapInterval = interval;
+    m_RefreshInterval = 0.0;
+
+    if (interval <= 0)
+        return;
+
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = monitor ? glfwGetVideoMode(monitor) : nullptr;
+    if (mode && mode->refreshRate > 0)
+        m_RefreshInterval = static_cast<double>(interval) / mode->refreshRate;
+}
+
+void FrameScheduler::SetTargetFrameRate(double fps)
+{
+    m_FrameInterval = fps > 0.0 ? 1.0 / fps : 0.0;
+}
+
+void FrameScheduler::SetStageRate(Stage stage, double hz)
+{
+    m_Stages[static_cast<size_t>(stage)].interval = hz > 0.0 ? 1.0 / hz : 0.0;
+}
+
+void FrameScheduler::RequestFrame()
+{
+    if (!m_FrameRequested.exchange(true))
+        glfwPostEmptyEvent();
+}
+
+void FrameScheduler::RequestStage(Stage stage)
+{
+    m_Stages[static_cast<size_t>(stage)].pending = true;
+}
+
+double FrameScheduler::GetFrameBudget() const
+{
+    return std::max(m_FrameInterval, m_RefreshInterval);
+}
+
+double FrameScheduler::GetPendingStageTime() const
+{
+    double earliest = -1.0;
+    for (const Cadence& cadence : m_Stages)
+    {
+        if (cadence.pending && (earliest < 0.0 || cadence.next < earliest))
+            earliest = cadence.next;
+    }
+    return earliest;
+}
+
+bool FrameScheduler::Advance(double& next, double interval, double now)
+{
+    if (now < next)
+        return false;
+
+    // Keep the cadence when slightly late, but resync rather than bursting
+    // to catch up after a long stall.
+    next += interval;
+    if (next <= now)
+        next = now + interval;
+    return true;
+}
+
+void FrameScheduler::WaitForEvents()
+{
+    double now = glfwGetTime();
+    bool active = now - m_LastFrameTime < m_ActiveLinger;
+    double timeout = active ? m_ActiveTimeout : m_IdleTimeout;
+
+    bool wantFrame = m_Mode == Mode::Continuous || m_FrameRequested.load();
+    if (wantFrame)
+    {
+        double remaining = m_NextFrameTime - now;
+        if (remaining > 0.0)
+            glfwWaitEventsTimeout(remaining);
+        else
+            glfwPollEvents();
+        return;
+    }
+
+    // A throttled stage sleeps until its slot, still waking at the usual
+    // rate for JS timers
+    double stageTime = GetPendingStageTime();
+    if (stageTime >= 0.0)
+    {
+        double remaining = std::max(stageTime, m_NextFrameTime) - now;
+        if (remaining > 0.0)
+            glfwWaitEventsTimeout(std::min(remaining, timeout));
+        else
+            glfwPollEvents();
+        return;
+    }
+
+    glfwWaitEventsTimeout(timeout);
+}
+
+bool FrameScheduler::StageDue(Stage stage)
+{
+    Cadence& cadence = m_Stages[static_cast<size_t>(stage)];
+    if (cadence.interval <= 0.0)
+    {
+        cadence.pending = false;
+        return true;
+    }
+
+    if (!Advance(cadence.next, cadence.interval, glfwGetTime()))
+        return false;
+
+    cadence.pending = false;
+    return true;
+}
+
+bool FrameScheduler::BeginFrame()
+{
+    double now = glfwGetTime();
+    double stageTime = GetPendingStageTime();
+    bool stageDue = stageTime >= 0.0 && now >= stageTime;
+    if (m_Mode != Mode::Continuous && !m_FrameRequested.load() && !stageDue)
+        return false;
+
+    if (m_FrameInterval > 0.0 && !Advance(m_NextFrameTime, m_FrameInterval, now))
+        return false;
+
+    m_FrameRequested.store(false);
+    m_LastFrameTime = now;
+    return true;
+}
+
+void FrameScheduler::EndFrame()
+{
+    double now = glfwGetTime();
+    double frameTime = now - m_LastFrameTime;
+    double budget = GetFrameBudget();
+
+    for (Stats* stats : { &m_TotalStats, &m_WindowStats })
+    {
+        stats->frames++;
+        stats->worstFrameTime = std::max(stats->worstFrameTime, frameTime);
+        // A little slack so vsync jitter does not count as a miss.
+        if (budget > 0.0 && frameTime > budget * 1.1)
+            stats->missedDeadlines++;
+    }
+
+    if (m_ReportInterval <= 0.0 || now - m_LastReportTime < m_ReportInterval)
+        return;
+
+    if (m_WindowStats.missedDeadlines > 0)
+    {
+        std::cout << "FrameScheduler: " << m_WindowStats.missedDeadlines << "/" << m_WindowStats.frames
+                  << " frames missed the " << budget * 1000.0 << " ms budget (worst "
+                  << m_WindowStats.worstFrameTime * 1000.0 << " ms)" << std::endl;
+    }
+
+    m_WindowStats = Stats{};
+    m_LastReportTime = now;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Decides when the main loop should produce a frame. In on-demand mode the
+// loop blocks in glfwWaitEventsTimeout until input, a RequestFrame() call or
+// a timeout wakes it, instead of redrawing continuously.
+//
+// Frames are paced to an optional target rate, and the Ultralight update and
+// native component passes can each run at their own, lower cadence; frames
+// in between reuse whatever those stages produced last.
+class FrameScheduler
+{
+public:
+    enum class Mode
+    {
+        Continuous,
+        OnDemand
+    };
+
+    enum class Stage
+    {
+        UI,
+        Component
+    };
+
+    struct Stats
+    {
+        uint64_t frames = 0;
+        uint64_t missedDeadlines = 0;
+        double worstFrameTime = 0.0;
+    };
+
+private:
+    struct Cadence
+    {
+        double interval = 0.0;
+        double next = 0.0;
+        bool pending = false;
+    };
+
+    Mode m_Mode;
+    double m_IdleTimeout;
+    double m_ActiveTimeout;
+    double m_ActiveLinger;
+    double m_LastFrameTime;
+    std::atomic<bool> m_FrameRequested;
+
+    int m_SwapInterval;
+    double m_RefreshInterval;
+    double m_FrameInterval;
+    double m_NextFrameTime;
+    std::array<Cadence, 2> m_Stages;
+
+    double m_ReportInterval;
+    double m_LastReportTime;
+    Stats m_TotalStats;
+    Stats m_WindowStats;
+
+    double GetFrameBudget() const;
+    // When the earliest pending stage may next run; negative if none is
+    double GetPendingStageTime() const;
+    static bool Advance(double& next, double interval, double now);
+
+public:
+    FrameScheduler();
+
+    FrameScheduler(const FrameScheduler&) = delete;
+    FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+    void SetMode(Mode mode) { m_Mode = mode; }
+    Mode GetMode() const { return m_Mode; }
+
+    // How long to sleep when nothing has changed recently. The loop still
+    // wakes at this rate so Ultralight can service JS timers.
+    void SetIdleTimeout(double seconds) { m_IdleTimeout = seconds; }
+    // Wake interval used for a short while after the last frame, so
+    // animations keep their cadence without input.
+    void SetActiveTimeout(double seconds, double linger);
+
+    // Applies glfwSwapInterval to the current context. The primary monitor's
+    // refresh rate is used as the frame budget when no target rate is set.
+    void SetSwapInterval(int interval);
+    int GetSwapInterval() const { return m_SwapInterval; }
+
+    // Caps presentation at fps frames per second; 0 leaves pacing to vsync.
+    void SetTargetFrameRate(double fps);
+    // Runs the given stage at most hz times per second; 0 runs it every frame.
+    void SetStageRate(Stage stage, double hz);
+
+    // Seconds between missed-deadline reports on stdout; 0 disables them.
+    void SetReportInterval(double seconds) { m_ReportInterval = seconds; }
+
+    // Safe to call from any thread; wakes the main loop if it is waiting.
+    void RequestFrame();
+    // Keeps the stage pending until it has run; a frame is produced once its
+    // cadence allows. Main thread only.
+    void RequestStage(Stage stage);
+
+    // Processes pending window events, blocking until there is work in
+    // on-demand mode. Must be called on the main thread.
+    void WaitForEvents();
+
+    // Returns true if the stage's cadence allows it to run now and consumes
+    // its pending request.
+    bool StageDue(Stage stage);
+
+    // Returns true if a frame should be rendered and consumes the request.
+    bool BeginFrame();
+    // Call after presenting to record the frame time against the budget.
+    void EndFrame();
+
+    const Stats& GetStats() const { return m_TotalStats; }
+};
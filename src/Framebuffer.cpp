@@ -7,6 +7,7 @@ Framebuffer::Framebuffer(uint32_t width, uint32_t height)
     , m_DepthAttachment(0)
     , m_Width(width)
     , m_Height(height)
+    , m_OwnsColorAttachment(true)
 {
     glGenFramebuffers(1, &m_RendererID);
     glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
@@ -31,11 +32,28 @@ Framebuffer::Framebuffer(uint32_t width, uint32_t height)
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+Framebuffer::Framebuffer(uint32_t colorAttachment, uint32_t width, uint32_t height)
+    : m_RendererID(0)
+    , m_ColorAttachment(colorAttachment)
+    , m_DepthAttachment(0)
+    , m_Width(width)
+    , m_Height(height)
+    , m_OwnsColorAttachment(false)
+{
+    glGenFramebuffers(1, &m_RendererID);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_ColorAttachment, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "Framebuffer is not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
 Framebuffer::~Framebuffer()
 {
     if (m_DepthAttachment)
         glDeleteRenderbuffers(1, &m_DepthAttachment);
-    if (m_ColorAttachment)
+    if (m_ColorAttachment && m_OwnsColorAttachment)
         glDeleteTextures(1, &m_ColorAttachment);
     if (m_RendererID)
         glDeleteFramebuffers(1, &m_RendererID);
@@ -47,6 +65,7 @@ Framebuffer::Framebuffer(Framebuffer&& other) noexcept
     , m_DepthAttachment(other.m_DepthAttachment)
     , m_Width(other.m_Width)
     , m_Height(other.m_Height)
+    , m_OwnsColorAttachment(other.m_OwnsColorAttachment)
 {
     other.m_RendererID = 0;
     other.m_ColorAttachment = 0;
@@ -59,7 +78,7 @@ Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept
     {
         if (m_DepthAttachment)
             glDeleteRenderbuffers(1, &m_DepthAttachment);
-        if (m_ColorAttachment)
+        if (m_ColorAttachment && m_OwnsColorAttachment)
             glDeleteTextures(1, &m_ColorAttachment);
         if (m_RendererID)
             glDeleteFramebuffers(1, &m_RendererID);
@@ -69,6 +88,7 @@ Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept
         m_DepthAttachment = other.m_DepthAttachment;
         m_Width = other.m_Width;
         m_Height = other.m_Height;
+        m_OwnsColorAttachment = other.m_OwnsColorAttachment;
 
         other.m_RendererID = 0;
         other.m_ColorAttachment = 0;
@@ -96,11 +116,17 @@ void Framebuffer::Resize(uint32_t width, uint32_t height)
     m_Width = width;
     m_Height = height;
 
-    glBindTexture(GL_TEXTURE_2D, m_ColorAttachment);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    if (m_OwnsColorAttachment)
+    {
+        glBindTexture(GL_TEXTURE_2D, m_ColorAttachment);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
 
-    glBindRenderbuffer(GL_RENDERBUFFER, m_DepthAttachment);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    if (m_DepthAttachment)
+    {
+        glBindRenderbuffer(GL_RENDERBUFFER, m_DepthAttachment);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    }
 }
 
 void Framebuffer::BindColorAttachment(uint32_t slot) const
@@ -11,9 +11,12 @@ private:
     uint32_t m_DepthAttachment;
     uint32_t m_Width;
     uint32_t m_Height;
+    bool m_OwnsColorAttachment;
 
 public:
     Framebuffer(uint32_t width, uint32_t height);
+    // Renders into an existing texture owned by the caller, without a depth buffer.
+    Framebuffer(uint32_t colorAttachment, uint32_t width, uint32_t height);
     ~Framebuffer();
 
     Framebuffer(const Framebuffer&) = delete;
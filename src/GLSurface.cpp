@@ -0,0 +1,226 @@
+#include "GLSurface.h"
+#include "Texture.h"
+#include <algorithm>
+#include <cstring>
+
+static constexpr uint32_t BYTES_PER_PIXEL = 4;
+
+GLSurface::GLSurface(uint32_t width, uint32_t height)
+    : m_Width(0)
+    , m_Height(0)
+    , m_RowBytes(0)
+    , m_BufferID(0)
+    , m_Mapped(nullptr)
+    , m_Pixels(nullptr)
+    , m_Region(0)
+    , m_Fences()
+{
+    Allocate(width, height);
+}
+
+GLSurface::~GLSurface()
+{
+    Release();
+}
+
+void GLSurface::Allocate(uint32_t width, uint32_t height)
+{
+    m_Width = std::max(width, 1u);
+    m_Height = std::max(height, 1u);
+    m_RowBytes = m_Width * BYTES_PER_PIXEL;
+
+    const GLsizeiptr bufferSize = static_cast<GLsizeiptr>(size() * REGION_COUNT);
+
+    if (GLAD_GL_VERSION_4_4)
+    {
+        // Readable so repaints can be carried over from one region to the next
+        const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        glGenBuffers(1, &m_BufferID);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_BufferID);
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, bufferSize, nullptr, flags);
+        m_Mapped = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bufferSize, flags));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        if (m_Mapped)
+        {
+            // Every region starts out equally blank
+            std::fill(m_Mapped, m_Mapped + size() * REGION_COUNT, 0);
+            m_Pixels = m_Mapped;
+        }
+        else
+        {
+            glDeleteBuffers(1, &m_BufferID);
+            m_BufferID = 0;
+        }
+    }
+
+    if (!m_Pixels)
+    {
+        m_HeapPixels.assign(size(), 0);
+        m_Pixels = m_HeapPixels.data();
+    }
+
+    ultralight::IntRect full = { 0, 0, static_cast<int>(m_Width), static_cast<int>(m_Height) };
+    dirty_bounds_ = full;
+}
+
+void GLSurface::Release()
+{
+    for (uint32_t i = 0; i < REGION_COUNT; i++)
+    {
+        if (m_Fences[i])
+        {
+            glDeleteSync(m_Fences[i]);
+            m_Fences[i] = nullptr;
+        }
+        m_Stale[i] = ultralight::IntRect::MakeEmpty();
+    }
+    m_Region = 0;
+
+    if (m_BufferID)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_BufferID);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(1, &m_BufferID);
+        m_BufferID = 0;
+    }
+
+    m_HeapPixels.clear();
+    m_HeapPixels.shrink_to_fit();
+    m_Mapped = nullptr;
+    m_Pixels = nullptr;
+}
+
+void GLSurface::NextRegion()
+{
+    uint32_t previous = m_Region;
+    m_Region = (m_Region + 1) % REGION_COUNT;
+    m_Pixels = m_Mapped + size() * m_Region;
+
+    // Ultralight must not repaint pixels the GPU is still copying out of.
+    // This only blocks once every region has an upload in flight.
+    GLsync fence = m_Fences[m_Region];
+    if (fence)
+    {
+        GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        while (status == GL_TIMEOUT_EXPIRED)
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+
+        glDeleteSync(fence);
+        m_Fences[m_Region] = nullptr;
+    }
+
+    // Ultralight only repaints what changed, so bring the region up to date
+    CopyStale(previous, m_Region);
+}
+
+void GLSurface::CopyStale(uint32_t from, uint32_t to)
+{
+    ultralight::IntRect& stale = m_Stale[to];
+    if (stale.IsEmpty())
+        return;
+
+    uint32_t left = static_cast<uint32_t>(std::clamp(stale.left, 0, static_cast<int>(m_Width)));
+    uint32_t right = static_cast<uint32_t>(std::clamp(stale.right, 0, static_cast<int>(m_Width)));
+    uint32_t top = static_cast<uint32_t>(std::clamp(stale.top, 0, static_cast<int>(m_Height)));
+    uint32_t bottom = static_cast<uint32_t>(std::clamp(stale.bottom, 0, static_cast<int>(m_Height)));
+    stale = ultralight::IntRect::MakeEmpty();
+    if (left >= right)
+        return;
+
+    const uint8_t* source = m_Mapped + size() * from;
+    uint8_t* destination = m_Mapped + size() * to;
+    size_t rowSize = static_cast<size_t>(right - left) * BYTES_PER_PIXEL;
+    for (uint32_t y = top; y < bottom; y++)
+    {
+        size_t offset = static_cast<size_t>(y) * m_RowBytes + static_cast<size_t>(left) * BYTES_PER_PIXEL;
+        std::memcpy(destination + offset, source + offset, rowSize);
+    }
+}
+
+void* GLSurface::LockPixels()
+{
+    // Move off a region once it has been uploaded
+    if (m_BufferID && m_Fences[m_Region])
+        NextRegion();
+    return m_Pixels;
+}
+
+void GLSurface::UnlockPixels()
+{
+}
+
+void GLSurface::Resize(uint32_t width, uint32_t height)
+{
+    if (width == m_Width && height == m_Height)
+        return;
+
+    Release();
+    Allocate(width, height);
+}
+
+void GLSurface::set_dirty_bounds(const ultralight::IntRect& bounds)
+{
+    // Accumulate until the next upload so skipped frames are not lost.
+    if (dirty_bounds_.IsEmpty())
+        dirty_bounds_ = bounds;
+    else
+        dirty_bounds_.Join(bounds);
+}
+
+bool GLSurface::UploadTo(Texture& texture)
+{
+    ultralight::IntRect dirty = dirty_bounds_;
+
+    if (texture.GetWidth() != m_Width || texture.GetHeight() != m_Height)
+    {
+        texture.Resize(m_Width, m_Height);
+        dirty = { 0, 0, static_cast<int>(m_Width), static_cast<int>(m_Height) };
+    }
+
+    if (dirty.IsEmpty())
+        return false;
+
+    uint32_t x = static_cast<uint32_t>(std::max(dirty.left, 0));
+    uint32_t y = static_cast<uint32_t>(std::max(dirty.top, 0));
+    uint32_t w = static_cast<uint32_t>(std::max(dirty.right, 0)) - x;
+    uint32_t h = static_cast<uint32_t>(std::max(dirty.bottom, 0)) - y;
+
+    if (m_BufferID)
+    {
+        texture.UpdateSubDataFromBuffer(m_BufferID, x, y, w, h, m_RowBytes, size() * m_Region);
+        if (m_Fences[m_Region])
+            glDeleteSync(m_Fences[m_Region]);
+        m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        // The other regions have not seen what was painted here
+        for (uint32_t i = 0; i < REGION_COUNT; i++)
+        {
+            if (i == m_Region)
+                continue;
+            if (m_Stale[i].IsEmpty())
+                m_Stale[i] = dirty;
+            else
+                m_Stale[i].Join(dirty);
+        }
+    }
+    else
+    {
+        texture.UpdateSubData(m_Pixels, x, y, w, h, m_RowBytes);
+    }
+
+    ClearDirtyBounds();
+    return true;
+}
+
+ultralight::Surface* GLSurfaceFactory::CreateSurface(uint32_t width, uint32_t height)
+{
+    return new GLSurface(width, height);
+}
+
+void GLSurfaceFactory::DestroySurface(ultralight::Surface* surface)
+{
+    delete static_cast<GLSurface*>(surface);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <Ultralight/Ultralight.h>
+#include <cstdint>
+#include <vector>
+
+class Texture;
+
+// Ultralight surface that paints straight into a persistently mapped pixel
+// buffer, so presenting a frame is a GPU-side buffer-to-texture copy of the
+// dirty region. The buffer holds a ring of frames: painting moves on to the
+// next one while the GPU still copies out of the last, and only waits when
+// the ring is full. Falls back to plain heap memory without OpenGL 4.4.
+class GLSurface : public ultralight::Surface
+{
+private:
+    static constexpr uint32_t REGION_COUNT = 3;
+
+    uint32_t m_Width;
+    uint32_t m_Height;
+    uint32_t m_RowBytes;
+    uint32_t m_BufferID;
+    uint8_t* m_Mapped;
+    void* m_Pixels;
+    std::vector<uint8_t> m_HeapPixels;
+    uint32_t m_Region;
+    GLsync m_Fences[REGION_COUNT];
+    // Area painted since each region was last current, to copy in on reuse
+    ultralight::IntRect m_Stale[REGION_COUNT];
+
+    void Allocate(uint32_t width, uint32_t height);
+    void Release();
+    void NextRegion();
+    void CopyStale(uint32_t from, uint32_t to);
+
+public:
+    GLSurface(uint32_t width, uint32_t height);
+    ~GLSurface() override;
+
+    GLSurface(const GLSurface&) = delete;
+    GLSurface& operator=(const GLSurface&) = delete;
+
+    uint32_t width() const override { return m_Width; }
+    uint32_t height() const override { return m_Height; }
+    uint32_t row_bytes() const override { return m_RowBytes; }
+    size_t size() const override { return static_cast<size_t>(m_RowBytes) * m_Height; }
+
+    void* LockPixels() override;
+    void UnlockPixels() override;
+    void Resize(uint32_t width, uint32_t height) override;
+    void set_dirty_bounds(const ultralight::IntRect& bounds) override;
+
+    // Copies the dirty region into the texture and clears the dirty bounds.
+    // Returns false if there was nothing to upload.
+    bool UploadTo(Texture& texture);
+
+    bool IsPersistentlyMapped() const { return m_BufferID != 0; }
+    uint32_t GetBufferID() const { return m_BufferID; }
+};
+
+class GLSurfaceFactory : public ultralight::SurfaceFactory
+{
+public:
+    ultralight::Surface* CreateSurface(uint32_t width, uint32_t height) override;
+    void DestroySurface(ultralight::Surface* surface) override;
+};
@@ -0,0 +1,347 @@
+#include "GPUDriverGL.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <chrono>
+#include <iostream>
+
+static const std::vector<VertexAttribute> FILL_PATH_LAYOUT =
+{
+    { 2, GL_FLOAT, false, 0 },
+    { 4, GL_UNSIGNED_BYTE, true, 8 },
+    { 2, GL_FLOAT, false, 12 },
+};
+
+static const std::vector<VertexAttribute> FILL_LAYOUT =
+{
+    { 2, GL_FLOAT, false, 0 },
+    { 4, GL_UNSIGNED_BYTE, true, 8 },
+    { 2, GL_FLOAT, false, 12 },
+    { 2, GL_FLOAT, false, 20 },
+    { 4, GL_FLOAT, false, 28 },
+    { 4, GL_FLOAT, false, 44 },
+    { 4, GL_FLOAT, false, 60 },
+    { 4, GL_FLOAT, false, 76 },
+    { 4, GL_FLOAT, false, 92 },
+    { 4, GL_FLOAT, false, 108 },
+    { 4, GL_FLOAT, false, 124 },
+};
+
+static double GetSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+GPUDriverGL::GPUDriverGL()
+    : m_NextTextureID(1)
+    , m_NextRenderBufferID(1)
+    , m_NextGeometryID(1)
+    , m_StartTime(GetSeconds())
+{
+    LoadProgram(m_FillProgram, "assets/UltralightFill.vert", "assets/UltralightFill.frag");
+    LoadProgram(m_FillPathProgram, "assets/UltralightFillPath.vert", "assets/UltralightFillPath.frag");
+}
+
+void GPUDriverGL::LoadProgram(Program& program, const char* vertexPath, const char* fragmentPath)
+{
+    program.shader = std::make_unique<Shader>(vertexPath, fragmentPath);
+    uint32_t id = program.shader->GetID();
+    if (id == 0)
+    {
+        std::cerr << "GPUDriverGL: Failed to create shader " << fragmentPath << std::endl;
+        return;
+    }
+
+    program.transform = glGetUniformLocation(id, "u_Transform");
+    program.state = glGetUniformLocation(id, "u_State");
+    program.scalar4 = glGetUniformLocation(id, "u_Scalar4");
+    program.vector = glGetUniformLocation(id, "u_Vector");
+    program.clipSize = glGetUniformLocation(id, "u_ClipSize");
+    program.clip = glGetUniformLocation(id, "u_Clip");
+    program.textures[0] = glGetUniformLocation(id, "u_Texture1");
+    program.textures[1] = glGetUniformLocation(id, "u_Texture2");
+    program.textures[2] = glGetUniformLocation(id, "u_Texture3");
+
+    program.shader->Bind();
+    for (int i = 0; i < 3; i++)
+    {
+        if (program.textures[i] != -1)
+            glUniform1i(program.textures[i], i);
+    }
+    program.shader->Unbind();
+}
+
+void GPUDriverGL::UploadBitmap(Texture& texture, ultralight::RefPtr<ultralight::Bitmap> bitmap)
+{
+    void* pixels = bitmap->LockPixels();
+    if (pixels)
+    {
+        texture.UpdateSubData(pixels, 0, 0, bitmap->width(), bitmap->height(), bitmap->row_bytes());
+        bitmap->UnlockPixels();
+    }
+}
+
+void GPUDriverGL::CreateTexture(uint32_t textureID, ultralight::RefPtr<ultralight::Bitmap> bitmap)
+{
+    std::unique_ptr<Texture> texture;
+
+    if (bitmap->format() == ultralight::kBitmapFormat_A8_UNORM)
+    {
+        texture = std::make_unique<Texture>(bitmap->width(), bitmap->height(), nullptr, GL_R8, GL_RED);
+
+        // Coverage masks are multiplied into premultiplied colors, so
+        // replicate the single channel into all four.
+        const GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_RED };
+        texture->Bind(0);
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+        texture->Unbind();
+    }
+    else
+    {
+        texture = std::make_unique<Texture>(bitmap->width(), bitmap->height(), nullptr, GL_RGBA8, GL_BGRA);
+    }
+
+    // Empty bitmaps describe render targets; they are filled by DrawCommandList.
+    if (!bitmap->IsEmpty())
+        UploadBitmap(*texture, bitmap);
+
+    m_Textures[textureID] = std::move(texture);
+}
+
+void GPUDriverGL::UpdateTexture(uint32_t textureID, ultralight::RefPtr<ultralight::Bitmap> bitmap)
+{
+    auto it = m_Textures.find(textureID);
+    if (it == m_Textures.end())
+    {
+        CreateTexture(textureID, bitmap);
+        return;
+    }
+
+    Texture& texture = *it->second;
+    if (texture.GetWidth() != bitmap->width() || texture.GetHeight() != bitmap->height())
+        texture.Resize(bitmap->width(), bitmap->height());
+
+    if (!bitmap->IsEmpty())
+        UploadBitmap(texture, bitmap);
+}
+
+void GPUDriverGL::DestroyTexture(uint32_t textureID)
+{
+    m_Textures.erase(textureID);
+}
+
+void GPUDriverGL::CreateRenderBuffer(uint32_t renderBufferID, const ultralight::RenderBuffer& buffer)
+{
+    auto it = m_Textures.find(buffer.texture_id);
+    if (it == m_Textures.end())
+    {
+        std::cerr << "GPUDriverGL: Render buffer " << renderBufferID
+                  << " references unknown texture " << buffer.texture_id << std::endl;
+        return;
+    }
+
+    m_RenderBuffers[renderBufferID] = std::make_unique<Framebuffer>(it->second->GetID(), buffer.width, buffer.height);
+}
+
+void GPUDriverGL::DestroyRenderBuffer(uint32_t renderBufferID)
+{
+    m_RenderBuffers.erase(renderBufferID);
+}
+
+void GPUDriverGL::CreateGeometry(uint32_t geometryID, const ultralight::VertexBuffer& vertices,
+                                 const ultralight::IndexBuffer& indices)
+{
+    // Keep whatever VAO the caller left bound from capturing our index buffer.
+    glBindVertexArray(0);
+
+    Geometry geometry;
+    geometry.vao = std::make_unique<VertexArray>();
+    geometry.vbo = std::make_unique<VertexBuffer>(vertices.data, vertices.size);
+    geometry.ibo = std::make_unique<IndexBuffer>(reinterpret_cast<const uint32_t*>(indices.data),
+                                                 indices.size / static_cast<uint32_t>(sizeof(uint32_t)));
+
+    if (vertices.format == ultralight::kVertexBufferFormat_2f_4ub_2f_2f_28f)
+        geometry.vao->AddVertexBuffer(*geometry.vbo, FILL_LAYOUT, sizeof(ultralight::Vertex_2f_4ub_2f_2f_28f));
+    else
+        geometry.vao->AddVertexBuffer(*geometry.vbo, FILL_PATH_LAYOUT, sizeof(ultralight::Vertex_2f_4ub_2f));
+    geometry.vao->SetIndexBuffer(*geometry.ibo);
+    geometry.vao->Unbind();
+
+    m_Geometry[geometryID] = std::move(geometry);
+}
+
+void GPUDriverGL::UpdateGeometry(uint32_t geometryID, const ultralight::VertexBuffer& vertices,
+                                 const ultralight::IndexBuffer& indices)
+{
+    auto it = m_Geometry.find(geometryID);
+    if (it == m_Geometry.end())
+    {
+        CreateGeometry(geometryID, vertices, indices);
+        return;
+    }
+
+    glBindVertexArray(0);
+    it->second.vbo->SetData(vertices.data, vertices.size);
+    it->second.ibo->SetData(reinterpret_cast<const uint32_t*>(indices.data),
+                            indices.size / static_cast<uint32_t>(sizeof(uint32_t)));
+}
+
+void GPUDriverGL::DestroyGeometry(uint32_t geometryID)
+{
+    m_Geometry.erase(geometryID);
+}
+
+void GPUDriverGL::UpdateCommandList(const ultralight::CommandList& list)
+{
+    m_Commands.assign(list.commands, list.commands + list.size);
+}
+
+void GPUDriverGL::BindRenderBuffer(uint32_t renderBufferID)
+{
+    auto it = m_RenderBuffers.find(renderBufferID);
+    if (it != m_RenderBuffers.end())
+        glBindFramebuffer(GL_FRAMEBUFFER, it->second->GetID());
+    else
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void GPUDriverGL::ClearRenderBuffer(uint32_t renderBufferID)
+{
+    BindRenderBuffer(renderBufferID);
+    glDisable(GL_SCISSOR_TEST);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void GPUDriverGL::SetUniforms(const Program& program, const ultralight::GPUState& state)
+{
+    // Render targets are stored top row first, matching CPU-rasterized
+    // bitmaps, so both paths composite with the same flipped quad.
+    glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(state.viewport_width),
+                                      0.0f, static_cast<float>(state.viewport_height), -1.0f, 1.0f);
+    glm::mat4 transform = projection * glm::make_mat4(state.transform.data);
+
+    if (program.transform != -1)
+        glUniformMatrix4fv(program.transform, 1, GL_FALSE, glm::value_ptr(transform));
+    if (program.state != -1)
+        glUniform4f(program.state, static_cast<float>(GetSeconds() - m_StartTime),
+                    static_cast<float>(state.viewport_width), static_cast<float>(state.viewport_height), 1.0f);
+    if (program.scalar4 != -1)
+        glUniform4fv(program.scalar4, 2, state.uniform_scalar);
+    if (program.vector != -1)
+        glUniform4fv(program.vector, 8, &state.uniform_vector[0].value[0]);
+    if (program.clipSize != -1)
+        glUniform1ui(program.clipSize, state.clip_size);
+    if (program.clip != -1 && state.clip_size > 0)
+        glUniformMatrix4fv(program.clip, state.clip_size, GL_FALSE, &state.clip[0].data[0]);
+}
+
+void GPUDriverGL::DrawGeometry(uint32_t geometryID, uint32_t indexCount, uint32_t indexOffset,
+                               const ultralight::GPUState& state)
+{
+    auto it = m_Geometry.find(geometryID);
+    if (it == m_Geometry.end())
+        return;
+
+    const Program& program = state.shader_type == ultralight::kShaderType_Fill ? m_FillProgram : m_FillPathProgram;
+    if (!program.shader || program.shader->GetID() == 0)
+        return;
+
+    BindRenderBuffer(state.render_buffer_id);
+    glViewport(0, 0, state.viewport_width, state.viewport_height);
+
+    program.shader->Bind();
+    SetUniforms(program, state);
+
+    if (state.enable_texturing)
+    {
+        const uint32_t textureIDs[3] = { state.texture_1_id, state.texture_2_id, state.texture_3_id };
+        for (uint32_t slot = 0; slot < 3; slot++)
+        {
+            if (textureIDs[slot])
+                BindTexture(textureIDs[slot], slot);
+        }
+    }
+
+    if (state.enable_scissor)
+    {
+        const ultralight::IntRect& r = state.scissor_rect;
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(r.left, r.top, r.right - r.left, r.bottom - r.top);
+    }
+    else
+    {
+        glDisable(GL_SCISSOR_TEST);
+    }
+
+    if (state.enable_blend)
+    {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    else
+    {
+        glDisable(GL_BLEND);
+    }
+
+    it->second.vao->Bind();
+    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT,
+                   reinterpret_cast<const void*>(static_cast<uintptr_t>(indexOffset) * sizeof(uint32_t)));
+}
+
+bool GPUDriverGL::DrawCommandList()
+{
+    if (m_Commands.empty())
+        return false;
+
+    GLint previousFramebuffer = 0;
+    GLint previousViewport[4];
+    GLint previousSrcRGB, previousDstRGB, previousSrcAlpha, previousDstAlpha;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    glGetIntegerv(GL_BLEND_SRC_RGB, &previousSrcRGB);
+    glGetIntegerv(GL_BLEND_DST_RGB, &previousDstRGB);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &previousSrcAlpha);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &previousDstAlpha);
+    GLboolean previousBlend = glIsEnabled(GL_BLEND);
+    GLboolean previousScissor = glIsEnabled(GL_SCISSOR_TEST);
+    GLboolean previousDepth = glIsEnabled(GL_DEPTH_TEST);
+
+    glDisable(GL_DEPTH_TEST);
+
+    for (const ultralight::Command& command : m_Commands)
+    {
+        if (command.command_type == ultralight::kCommandType_ClearRenderBuffer)
+            ClearRenderBuffer(command.gpu_state.render_buffer_id);
+        else if (command.command_type == ultralight::kCommandType_DrawGeometry)
+            DrawGeometry(command.geometry_id, command.indices_count, command.indices_offset, command.gpu_state);
+    }
+    m_Commands.clear();
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    glBlendFuncSeparate(previousSrcRGB, previousDstRGB, previousSrcAlpha, previousDstAlpha);
+    if (previousBlend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
+    if (previousScissor) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
+    if (previousDepth) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
+    return true;
+}
+
+bool GPUDriverGL::BindTexture(uint32_t textureID, uint32_t slot) const
+{
+    Texture* texture = GetTexture(textureID);
+    if (!texture)
+        return false;
+
+    texture->Bind(slot);
+    return true;
+}
+
+Texture* GPUDriverGL::GetTexture(uint32_t textureID) const
+{
+    auto it = m_Textures.find(textureID);
+    return it != m_Textures.end() ? it->second.get() : nullptr;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <Ultralight/Ultralight.h>
+#include "Texture.h"
+#include "Framebuffer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// ultralight::GPUDriver implemented on the project's GL wrappers. Ultralight
+// records its draw calls during Renderer::Render(); DrawCommandList() replays
+// them into offscreen render targets that the compositor samples directly.
+class GPUDriverGL : public ultralight::GPUDriver
+{
+private:
+    struct Geometry
+    {
+        std::unique_ptr<VertexArray> vao;
+        std::unique_ptr<VertexBuffer> vbo;
+        std::unique_ptr<IndexBuffer> ibo;
+    };
+
+    struct Program
+    {
+        std::unique_ptr<Shader> shader;
+        int transform = -1;
+        int state = -1;
+        int scalar4 = -1;
+        int vector = -1;
+        int clipSize = -1;
+        int clip = -1;
+        int textures[3] = { -1, -1, -1 };
+    };
+
+    std::unordered_map<uint32_t, std::unique_ptr<Texture>> m_Textures;
+    std::unordered_map<uint32_t, std::unique_ptr<Framebuffer>> m_RenderBuffers;
+    std::unordered_map<uint32_t, Geometry> m_Geometry;
+    std::vector<ultralight::Command> m_Commands;
+
+    Program m_FillProgram;
+    Program m_FillPathProgram;
+
+    uint32_t m_NextTextureID;
+    uint32_t m_NextRenderBufferID;
+    uint32_t m_NextGeometryID;
+    double m_StartTime;
+
+    void LoadProgram(Program& program, const char* vertexPath, const char* fragmentPath);
+    void UploadBitmap(Texture& texture, ultralight::RefPtr<ultralight::Bitmap> bitmap);
+    void BindRenderBuffer(uint32_t renderBufferID);
+    void SetUniforms(const Program& program, const ultralight::GPUState& state);
+    void ClearRenderBuffer(uint32_t renderBufferID);
+    void DrawGeometry(uint32_t geometryID, uint32_t indexCount, uint32_t indexOffset,
+                      const ultralight::GPUState& state);
+
+public:
+    GPUDriverGL();
+    ~GPUDriverGL() override = default;
+
+    GPUDriverGL(const GPUDriverGL&) = delete;
+    GPUDriverGL& operator=(const GPUDriverGL&) = delete;
+
+    void BeginSynchronize() override {}
+    void EndSynchronize() override {}
+
+    uint32_t NextTextureId() override { return m_NextTextureID++; }
+    void CreateTexture(uint32_t textureID, ultralight::RefPtr<ultralight::Bitmap> bitmap) override;
+    void UpdateTexture(uint32_t textureID, ultralight::RefPtr<ultralight::Bitmap> bitmap) override;
+    void DestroyTexture(uint32_t textureID) override;
+
+    uint32_t NextRenderBufferId() override { return m_NextRenderBufferID++; }
+    void CreateRenderBuffer(uint32_t renderBufferID, const ultralight::RenderBuffer& buffer) override;
+    void DestroyRenderBuffer(uint32_t renderBufferID) override;
+
+    uint32_t NextGeometryId() override { return m_NextGeometryID++; }
+    void CreateGeometry(uint32_t geometryID, const ultralight::VertexBuffer& vertices,
+                        const ultralight::IndexBuffer& indices) override;
+    void UpdateGeometry(uint32_t geometryID, const ultralight::VertexBuffer& vertices,
+                        const ultralight::IndexBuffer& indices) override;
+    void DestroyGeometry(uint32_t geometryID) override;
+
+    void UpdateCommandList(const ultralight::CommandList& list) override;
+
+    bool HasCommandsPending() const { return !m_Commands.empty(); }
+    // Replays the queued command list and returns false if there was none.
+    // Restores the blend, scissor and framebuffer state it touches so callers
+    // can keep their own setup.
+    bool DrawCommandList();
+
+    // Binds the GL texture backing an Ultralight texture ID (e.g. a view's render target).
+    bool BindTexture(uint32_t textureID, uint32_t slot = 0) const;
+    Texture* GetTexture(uint32_t textureID) const;
+};
@@ -0,0 +1,172 @@
+#include "HeadlessContext.h"
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#include <iostream>
+
+static bool HasExtension(const char* extensions, const char* name)
+{
+    if (!extensions)
+        return false;
+
+    size_t length = std::strlen(name);
+    for (const char* p = std::strstr(extensions, name); p; p = std::strstr(p + length, name))
+    {
+        bool startsWord = p == extensions || p[-1] == ' ';
+        bool endsWord = p[length] == ' ' || p[length] == '\0';
+        if (startsWord && endsWord)
+            return true;
+    }
+    return false;
+}
+
+static EGLDisplay OpenDisplay()
+{
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (HasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+    {
+        auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay)
+        {
+            EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+            {
+                std::cout << "[Headless] Using surfaceless EGL platform" << std::endl;
+                return display;
+            }
+        }
+    }
+
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+    {
+        std::cout << "[Headless] Using default EGL display" << std::endl;
+        return display;
+    }
+    return EGL_NO_DISPLAY;
+}
+
+HeadlessContext::HeadlessContext()
+    : m_Display(EGL_NO_DISPLAY)
+    , m_Context(EGL_NO_CONTEXT)
+    , m_Surface(EGL_NO_SURFACE)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    Shutdown();
+}
+
+bool HeadlessContext::Initialize(int majorVersion, int minorVersion)
+{
+    if (m_Context)
+        return true;
+
+    EGLDisplay display = OpenDisplay();
+    if (display == EGL_NO_DISPLAY)
+    {
+        std::cerr << "[Headless] Failed to open an EGL display" << std::endl;
+        return false;
+    }
+    m_Display = display;
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cerr << "[Headless] EGL implementation does not support desktop OpenGL" << std::endl;
+        Shutdown();
+        return false;
+    }
+
+    const EGLint configAttributes[] =
+    {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+
+    EGLConfig config = nullptr;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+        config = nullptr;
+
+    const char* displayExtensions = eglQueryString(display, EGL_EXTENSIONS);
+    bool noConfig = HasExtension(displayExtensions, "EGL_KHR_no_config_context");
+    if (!config && !noConfig)
+    {
+        std::cerr << "[Headless] No suitable EGL config" << std::endl;
+        Shutdown();
+        return false;
+    }
+
+    const EGLint contextAttributes[] =
+    {
+        EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+        EGL_CONTEXT_MINOR_VERSION, minorVersion,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+
+    EGLContext context = eglCreateContext(display, config ? config : EGL_NO_CONFIG_KHR,
+                                          EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT)
+    {
+        std::cerr << "[Headless] Failed to create an OpenGL " << majorVersion << "." << minorVersion
+                  << " core context (EGL error 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        Shutdown();
+        return false;
+    }
+    m_Context = context;
+
+    // Everything renders into framebuffer objects, so a surface is only
+    // needed when the driver cannot make a context current without one.
+    EGLSurface surface = EGL_NO_SURFACE;
+    if (!HasExtension(displayExtensions, "EGL_KHR_surfaceless_context") && config)
+    {
+        const EGLint pbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, pbufferAttributes);
+        m_Surface = surface;
+    }
+
+    if (!eglMakeCurrent(display, surface, surface, context))
+    {
+        std::cerr << "[Headless] Failed to make the context current" << std::endl;
+        Shutdown();
+        return false;
+    }
+
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress)))
+    {
+        std::cerr << "[Headless] Failed to load OpenGL functions" << std::endl;
+        Shutdown();
+        return false;
+    }
+
+    std::cout << "[Headless] OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
+    std::cout << "[Headless] Renderer: " << glGetString(GL_RENDERER) << std::endl;
+    return true;
+}
+
+void HeadlessContext::Shutdown()
+{
+    if (m_Display == EGL_NO_DISPLAY)
+        return;
+
+    eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (m_Surface != EGL_NO_SURFACE)
+        eglDestroySurface(m_Display, m_Surface);
+    if (m_Context != EGL_NO_CONTEXT)
+        eglDestroyContext(m_Display, m_Context);
+    eglTerminate(m_Display);
+
+    m_Display = EGL_NO_DISPLAY;
+    m_Context = EGL_NO_CONTEXT;
+    m_Surface = EGL_NO_SURFACE;
+}
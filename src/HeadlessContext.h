@@ -0,0 +1,26 @@
+#pragma once
+
+// Offscreen OpenGL context created through EGL, for rendering without a
+// window or display server. Prefers Mesa's surfaceless platform and falls
+// back to the default display with a 1x1 pbuffer. Works with llvmpipe.
+class HeadlessContext
+{
+private:
+    void* m_Display;
+    void* m_Context;
+    void* m_Surface;
+
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // Creates a core profile context of at least the given version, makes
+    // it current and loads GL entry points through glad.
+    bool Initialize(int majorVersion = 3, int minorVersion = 3);
+    void Shutdown();
+
+    bool IsInitialized() const { return m_Context != nullptr; }
+};
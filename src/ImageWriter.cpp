@@ -0,0 +1,183 @@
+#include "ImageWriter.h"
+#include <Ultralight/Ultralight.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace ImageWriter
+{
+    Format FormatFromPath(const std::string& path)
+    {
+        size_t dot = path.find_last_of('.');
+        if (dot == std::string::npos)
+            return Format::Raw;
+
+        std::string extension = path.substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (extension == "png")
+            return Format::PNG;
+        if (extension == "qoi")
+            return Format::QOI;
+        return Format::Raw;
+    }
+
+    const char* GetExtension(Format format)
+    {
+        switch (format)
+        {
+        case Format::PNG: return ".png";
+        case Format::QOI: return ".qoi";
+        default:          return ".raw";
+        }
+    }
+
+    static bool WriteRaw(const std::string& path, const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t rowBytes)
+    {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file)
+            return false;
+
+        size_t packedRowBytes = static_cast<size_t>(width) * 4;
+        bool ok = true;
+        if (rowBytes == packedRowBytes)
+        {
+            ok = std::fwrite(pixels, packedRowBytes * height, 1, file) == 1;
+        }
+        else
+        {
+            for (uint32_t y = 0; y < height && ok; y++)
+                ok = std::fwrite(pixels + static_cast<size_t>(y) * rowBytes, packedRowBytes, 1, file) == 1;
+        }
+
+        return std::fclose(file) == 0 && ok;
+    }
+
+    static void PutBigEndian(std::vector<uint8_t>& out, uint32_t value)
+    {
+        out.push_back(static_cast<uint8_t>(value >> 24));
+        out.push_back(static_cast<uint8_t>(value >> 16));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    // https://qoiformat.org/qoi-specification.pdf
+    static bool WriteQOI(const std::string& path, const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t rowBytes)
+    {
+        std::vector<uint8_t> out;
+        out.reserve(14 + static_cast<size_t>(width) * height * 2 + 8);
+        out.insert(out.end(), { 'q', 'o', 'i', 'f' });
+        PutBigEndian(out, width);
+        PutBigEndian(out, height);
+        out.push_back(4);
+        out.push_back(0);
+
+        uint8_t index[64][4] = {};
+        uint8_t previous[4] = { 0, 0, 0, 255 };
+        uint32_t run = 0;
+        size_t pixelCount = static_cast<size_t>(width) * height;
+        size_t pixelIndex = 0;
+
+        for (uint32_t y = 0; y < height; y++)
+        {
+            const uint8_t* row = pixels + static_cast<size_t>(y) * rowBytes;
+            for (uint32_t x = 0; x < width; x++, pixelIndex++)
+            {
+                const uint8_t* bgra = row + static_cast<size_t>(x) * 4;
+                uint8_t px[4] = { bgra[2], bgra[1], bgra[0], bgra[3] };
+
+                if (std::memcmp(px, previous, 4) == 0)
+                {
+                    run++;
+                    if (run == 62 || pixelIndex + 1 == pixelCount)
+                    {
+                        out.push_back(static_cast<uint8_t>(0xC0 | (run - 1)));
+                        run = 0;
+                    }
+                    continue;
+                }
+
+                if (run > 0)
+                {
+                    out.push_back(static_cast<uint8_t>(0xC0 | (run - 1)));
+                    run = 0;
+                }
+
+                uint32_t hash = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+                if (std::memcmp(index[hash], px, 4) == 0)
+                {
+                    out.push_back(static_cast<uint8_t>(hash));
+                }
+                else
+                {
+                    std::memcpy(index[hash], px, 4);
+
+                    if (px[3] == previous[3])
+                    {
+                        int8_t dr = static_cast<int8_t>(px[0] - previous[0]);
+                        int8_t dg = static_cast<int8_t>(px[1] - previous[1]);
+                        int8_t db = static_cast<int8_t>(px[2] - previous[2]);
+                        int8_t drdg = static_cast<int8_t>(dr - dg);
+                        int8_t dbdg = static_cast<int8_t>(db - dg);
+
+                        if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2)
+                        {
+                            out.push_back(static_cast<uint8_t>(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2)));
+                        }
+                        else if (drdg > -9 && drdg < 8 && dg > -33 && dg < 32 && dbdg > -9 && dbdg < 8)
+                        {
+                            out.push_back(static_cast<uint8_t>(0x80 | (dg + 32)));
+                            out.push_back(static_cast<uint8_t>(((drdg + 8) << 4) | (dbdg + 8)));
+                        }
+                        else
+                        {
+                            out.insert(out.end(), { 0xFE, px[0], px[1], px[2] });
+                        }
+                    }
+                    else
+                    {
+                        out.insert(out.end(), { 0xFF, px[0], px[1], px[2], px[3] });
+                    }
+                }
+
+                std::memcpy(previous, px, 4);
+            }
+        }
+
+        out.insert(out.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file)
+            return false;
+        bool ok = std::fwrite(out.data(), out.size(), 1, file) == 1;
+        return std::fclose(file) == 0 && ok;
+    }
+
+    bool Write(const std::string& path, const void* pixels, uint32_t width, uint32_t height, uint32_t rowBytes)
+    {
+        bool ok = false;
+        Format format = FormatFromPath(path);
+        if (format == Format::QOI)
+        {
+            ok = WriteQOI(path, static_cast<const uint8_t*>(pixels), width, height, rowBytes);
+        }
+        else if (format == Format::PNG)
+        {
+            // Wraps the caller's pixels; Ultralight's encoder does the rest.
+            auto bitmap = ultralight::Bitmap::Create(width, height, ultralight::kBitmapFormat_BGRA8_UNORM_SRGB,
+                                                     rowBytes, pixels, static_cast<size_t>(rowBytes) * height, false);
+            ok = bitmap && bitmap->WritePNG(path.c_str(), true, false);
+        }
+        else
+        {
+            ok = WriteRaw(path, static_cast<const uint8_t*>(pixels), width, height, rowBytes);
+        }
+
+        if (!ok)
+            std::cerr << "[ImageWriter] Failed to write " << path << std::endl;
+        return ok;
+    }
+}
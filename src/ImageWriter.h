@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace ImageWriter
+{
+    enum class Format
+    {
+        PNG,
+        // Quite OK Image format; lossless, far cheaper to encode than PNG
+        QOI,
+        // Tightly packed BGRA8 rows, top row first, no header
+        Raw
+    };
+
+    // Chosen from the extension; anything other than .png or .qoi is
+    // written raw.
+    Format FormatFromPath(const std::string& path);
+
+    const char* GetExtension(Format format);
+
+    // Pixels are BGRA8 with the top row first. Safe to call from any thread.
+    bool Write(const std::string& path, const void* pixels, uint32_t width, uint32_t height, uint32_t rowBytes);
+}
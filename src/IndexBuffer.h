@@ -22,6 +22,9 @@ public:
     void Bind() const;
     void Unbind() const;
 
+    // Replaces the contents, reallocating the storage as GL_DYNAMIC_DRAW.
+    void SetData(const uint32_t* data, uint32_t count);
+
     uint32_t GetCount() const { return m_Count; }
     uint32_t GetID() const { return m_RendererID; }
 };
@@ -153,6 +153,7 @@ InputEventHandler::InputEventHandler()
     , m_MouseInViewport(false)
     , m_IsDragging(false)
     , m_ResizeCallback(nullptr)
+    , m_ActivityCallback(nullptr)
 {
 }
 
@@ -170,6 +171,7 @@ void InputEventHandler::Initialize(GLFWwindow* window, UltralightRenderer* rende
     glfwSetCharCallback(window, GLFW_CharCallback);
     glfwSetWindowFocusCallback(window, GLFW_FocusCallback);
     glfwSetFramebufferSizeCallback(window, GLFW_ResizeCallback);
+    glfwSetWindowRefreshCallback(window, GLFW_RefreshCallback);
 
     std::cout << "[Input] Event handler initialized" << std::endl;
 }
@@ -194,18 +196,22 @@ void InputEventHandler::WindowToViewCoords(double windowX, double windowY, int&
     viewY = static_cast<int>(windowY - m_ViewportY);
 }
 
+void InputEventHandler::NotifyActivity()
+{
+    if (m_ActivityCallback)
+        m_ActivityCallback();
+}
+
 void InputEventHandler::OnMouseMove(double x, double y)
 {
+    NotifyActivity();
+
     m_MouseX = x;
     m_MouseY = y;
 
     if (!m_Renderer || !m_Renderer->IsInitialized())
         return;
 
-    auto* view = m_Renderer->GetView();
-    if (!view)
-        return;
-
     m_MouseInViewport = IsInViewportRegion(x, y);
 
     if (m_MouseInViewport || m_IsDragging)
@@ -218,18 +224,16 @@ void InputEventHandler::OnMouseMove(double x, double y)
         evt.x = viewX;
         evt.y = viewY;
         evt.button = ultralight::MouseEvent::kButton_None;
-        view->FireMouseEvent(evt);
+        m_Renderer->FireMouseEvent(evt);
         m_Renderer->ForceRepaint();
     }
 }
 
 void InputEventHandler::OnMouseButton(int button, int action, int mods)
 {
-    if (!m_Renderer || !m_Renderer->IsInitialized())
-        return;
+    NotifyActivity();
 
-    auto* view = m_Renderer->GetView();
-    if (!view)
+    if (!m_Renderer || !m_Renderer->IsInitialized())
         return;
 
     bool inViewport = IsInViewportRegion(m_MouseX, m_MouseY);
@@ -260,7 +264,7 @@ void InputEventHandler::OnMouseButton(int button, int action, int mods)
     evt.x = viewX;
     evt.y = viewY;
     evt.button = GLFWButtonToUltralightButton(button);
-    view->FireMouseEvent(evt);
+    m_Renderer->FireMouseEvent(evt);
     
     // Force repaint to update active/focus states
     m_Renderer->ForceRepaint();
@@ -268,11 +272,9 @@ void InputEventHandler::OnMouseButton(int button, int action, int mods)
 
 void InputEventHandler::OnScroll(double xoffset, double yoffset)
 {
-    if (!m_Renderer || !m_Renderer->IsInitialized())
-        return;
+    NotifyActivity();
 
-    auto* view = m_Renderer->GetView();
-    if (!view)
+    if (!m_Renderer || !m_Renderer->IsInitialized())
         return;
 
     if (!IsInViewportRegion(m_MouseX, m_MouseY))
@@ -282,7 +284,7 @@ void InputEventHandler::OnScroll(double xoffset, double yoffset)
     evt.type = ultralight::ScrollEvent::kType_ScrollByPixel;
     evt.delta_x = static_cast<int>(xoffset * 32);
     evt.delta_y = static_cast<int>(yoffset * 32);
-    view->FireScrollEvent(evt);
+    m_Renderer->FireScrollEvent(evt);
     
     // Force repaint after scroll
     m_Renderer->ForceRepaint();
@@ -290,11 +292,9 @@ void InputEventHandler::OnScroll(double xoffset, double yoffset)
 
 void InputEventHandler::OnKey(int key, int scancode, int action, int mods)
 {
-    if (!m_Renderer || !m_Renderer->IsInitialized())
-        return;
+    NotifyActivity();
 
-    auto* view = m_Renderer->GetView();
-    if (!view)
+    if (!m_Renderer || !m_Renderer->IsInitialized())
         return;
 
     if (action == GLFW_REPEAT)
@@ -309,17 +309,15 @@ void InputEventHandler::OnKey(int key, int scancode, int action, int mods)
     
     ultralight::GetKeyIdentifierFromVirtualKeyCode(evt.virtual_key_code, evt.key_identifier);
     
-    view->FireKeyEvent(evt);
+    m_Renderer->FireKeyEvent(evt);
 
 }
 
 void InputEventHandler::OnChar(unsigned int codepoint)
 {
-    if (!m_Renderer || !m_Renderer->IsInitialized())
-        return;
+    NotifyActivity();
 
-    auto* view = m_Renderer->GetView();
-    if (!view)
+    if (!m_Renderer || !m_Renderer->IsInitialized())
         return;
 
     ultralight::KeyEvent evt;
@@ -330,26 +328,23 @@ void InputEventHandler::OnChar(unsigned int codepoint)
     evt.text = text;
     evt.unmodified_text = text;
     
-    view->FireKeyEvent(evt);
+    m_Renderer->FireKeyEvent(evt);
 }
 
 void InputEventHandler::OnFocus(bool focused)
 {
-    if (!m_Renderer || !m_Renderer->IsInitialized())
-        return;
+    NotifyActivity();
 
-    auto* view = m_Renderer->GetView();
-    if (!view)
+    if (!m_Renderer || !m_Renderer->IsInitialized())
         return;
 
-    if (focused)
-        view->Focus();
-    else
-        view->Unfocus();
+    m_Renderer->SetFocus(focused);
 }
 
 void InputEventHandler::OnResize(int width, int height)
 {
+    NotifyActivity();
+
     if (width <= 0 || height <= 0)
         return;
 
@@ -362,6 +357,11 @@ void InputEventHandler::OnResize(int width, int height)
         m_ResizeCallback(width, height);
 }
 
+void InputEventHandler::OnRefresh()
+{
+    NotifyActivity();
+}
+
 void GLFW_MouseMoveCallback(GLFWwindow* window, double x, double y)
 {
     auto* handler = static_cast<InputEventHandler*>(glfwGetWindowUserPointer(window));
@@ -410,3 +410,10 @@ void GLFW_ResizeCallback(GLFWwindow* window, int width, int height)
     if (handler)
         handler->OnResize(width, height);
 }
+
+void GLFW_RefreshCallback(GLFWwindow* window)
+{
+    auto* handler = static_cast<InputEventHandler*>(glfwGetWindowUserPointer(window));
+    if (handler)
+        handler->OnRefresh();
+}
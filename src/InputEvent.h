@@ -12,6 +12,7 @@
 class UltralightRenderer;
 
 using ResizeCallback = std::function<void(int width, int height)>;
+using ActivityCallback = std::function<void()>;
 
 int GLFWKeyToUltralightKey(int glfwKey);
 unsigned int GLFWModsToUltralightMods(int glfwMods);
@@ -25,6 +26,8 @@ public:
 
     void Initialize(GLFWwindow* window, UltralightRenderer* renderer);
     void SetResizeCallback(ResizeCallback callback) { m_ResizeCallback = callback; }
+    // Invoked for every window event (input, focus, resize, expose).
+    void SetActivityCallback(ActivityCallback callback) { m_ActivityCallback = callback; }
 
     void SetViewportRegion(int x, int y, int width, int height);
     bool IsInViewportRegion(double x, double y) const;
@@ -37,6 +40,7 @@ public:
     void OnChar(unsigned int codepoint);
     void OnFocus(bool focused);
     void OnResize(int width, int height);
+    void OnRefresh();
 
 private:
     UltralightRenderer* m_Renderer;
@@ -54,6 +58,9 @@ private:
     bool m_IsDragging;
 
     ResizeCallback m_ResizeCallback;
+    ActivityCallback m_ActivityCallback;
+
+    void NotifyActivity();
 };
 
 void GLFW_MouseMoveCallback(GLFWwindow* window, double x, double y);
@@ -63,3 +70,4 @@ void GLFW_KeyCallback(GLFWwindow* window, int key, int scancode, int action, int
 void GLFW_CharCallback(GLFWwindow* window, unsigned int codepoint);
 void GLFW_FocusCallback(GLFWwindow* window, int focused);
 void GLFW_ResizeCallback(GLFWwindow* window, int width, int height);
+void GLFW_RefreshCallback(GLFWwindow* window);
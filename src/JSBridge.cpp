@@ -1,27 +1,462 @@
 #include "JSBridge.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <thread>
 
 JSBridge* JSBridge::s_Instance = nullptr;
 
+// Deeper values become null.
+static constexpr size_t MAX_VALUE_DEPTH = 32;
+// Values converted from one JS value before the rest become null.
+static constexpr size_t MAX_VALUE_COUNT = 1 << 18;
+// Async bridge calls are I/O and hashing, not rendering; keep the pool small.
+static constexpr unsigned MAX_ASYNC_THREADS = 4;
+
 JSBridge::JSBridge()
+    : m_Profiling(false)
+    , m_NextAsyncID(0)
 {
     s_Instance = this;
+
+    JSClassDefinition classDef = kJSClassDefinitionEmpty;
+    classDef.className = "NativeFunction";
+    classDef.callAsFunction = JSCallHandler;
+    m_FunctionClass = JSClassCreate(&classDef);
+
+    classDef.className = "NativeBatch";
+    classDef.callAsFunction = JSBatchHandler;
+    m_BatchClass = JSClassCreate(&classDef);
+
+    classDef.className = "NativeListen";
+    classDef.callAsFunction = JSListenHandler;
+    m_ListenClass = JSClassCreate(&classDef);
+
+    classDef.className = "NativeStats";
+    classDef.callAsFunction = JSStatsHandler;
+    m_StatsClass = JSClassCreate(&classDef);
 }
 
 JSBridge::~JSBridge()
 {
+    m_AsyncPool.reset();
+    // Promises never settled; FinishAsyncCalls should have been called
+    for (auto& entry : m_PendingPromises)
+    {
+        JSValueUnprotect(entry.second.context, entry.second.resolve);
+        JSValueUnprotect(entry.second.context, entry.second.reject);
+        JSGlobalContextRelease(entry.second.context);
+    }
+    for (const EventListener& listener : m_Listeners)
+    {
+        JSValueUnprotect(listener.context, listener.function);
+        JSGlobalContextRelease(listener.context);
+    }
+    JSClassRelease(m_FunctionClass);
+    JSClassRelease(m_BatchClass);
+    JSClassRelease(m_ListenClass);
+    JSClassRelease(m_StatsClass);
+
     if (s_Instance == this)
         s_Instance = nullptr;
 }
 
 void JSBridge::Register(const std::string& name, JSCallback callback)
 {
-    m_Functions[name] = std::move(callback);
+    // Reuse the slot so functions already bound pick up the new callback
+    auto it = m_Functions.find(name);
+    if (it != m_Functions.end())
+    {
+        it->second->callback = std::move(callback);
+        it->second->async = false;
+        it->second->direct = nullptr;
+        it->second->signature.clear();
+        return;
+    }
+
+    m_Slots.push_back(std::make_unique<FunctionSlot>(FunctionSlot{ this, name, std::move(callback), false, false, nullptr, {},
+                                                                   std::make_unique<CallStats>() }));
+    m_Functions[name] = m_Slots.back().get();
+}
+
+void JSBridge::RegisterAsync(const std::string& name, JSCallback callback)
+{
+    Register(name, std::move(callback));
+    m_Functions[name]->async = true;
+
+    if (!m_AsyncPool)
+    {
+        unsigned threads = std::clamp(std::thread::hardware_concurrency() / 2, 1u, MAX_ASYNC_THREADS);
+        m_AsyncPool = std::make_unique<ThreadPool>(threads);
+    }
+}
+
+static JSValue SummaryToValue(const LatencyHistogram::Summary& summary)
+{
+    JSObject object;
+    object.fields.reserve(6);
+    object.fields.emplace_back("count", static_cast<double>(summary.count));
+    object.fields.emplace_back("mean", summary.mean);
+    object.fields.emplace_back("p50", summary.p50);
+    object.fields.emplace_back("p90", summary.p90);
+    object.fields.emplace_back("p99", summary.p99);
+    object.fields.emplace_back("max", summary.max);
+    return object;
+}
+
+JSValue JSBridge::GetStats() const
+{
+    double nanosecondsPerTick = CycleClock::NanosecondsPerTick();
+
+    JSObject stats;
+    for (const std::unique_ptr<FunctionSlot>& slot : m_Slots)
+    {
+        uint64_t calls = slot->stats->calls.load(std::memory_order_relaxed);
+        if (calls == 0)
+            continue;
+
+        JSObject function;
+        function.fields.reserve(4);
+        function.fields.emplace_back("calls", static_cast<double>(calls));
+        function.fields.emplace_back("arguments", SummaryToValue(slot->stats->arguments.Summarize(nanosecondsPerTick)));
+        function.fields.emplace_back("callback", SummaryToValue(slot->stats->callback.Summarize(nanosecondsPerTick)));
+        function.fields.emplace_back("result", SummaryToValue(slot->stats->result.Summarize(nanosecondsPerTick)));
+        stats.fields.emplace_back(slot->name, std::move(function));
+    }
+    return stats;
+}
+
+void JSBridge::ResetStats()
+{
+    for (const std::unique_ptr<FunctionSlot>& slot : m_Slots)
+    {
+        slot->stats->calls.store(0, std::memory_order_relaxed);
+        slot->stats->arguments.Reset();
+        slot->stats->callback.Reset();
+        slot->stats->result.Reset();
+    }
+}
+
+void JSBridge::PrintStats(std::ostream& out) const
+{
+    double nanosecondsPerTick = CycleClock::NanosecondsPerTick();
+
+    struct Row
+    {
+        const std::string* name;
+        uint64_t calls;
+        LatencyHistogram::Summary arguments;
+        LatencyHistogram::Summary callback;
+        LatencyHistogram::Summary result;
+    };
+    std::vector<Row> rows;
+    for (const std::unique_ptr<FunctionSlot>& slot : m_Slots)
+    {
+        Row row{ &slot->name, slot->stats->calls.load(std::memory_order_relaxed),
+                 slot->stats->arguments.Summarize(nanosecondsPerTick),
+                 slot->stats->callback.Summarize(nanosecondsPerTick), slot->stats->result.Summarize(nanosecondsPerTick) };
+        if (row.calls > 0)
+            rows.push_back(row);
+    }
+    // Totals are estimated from the timed sample
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b)
+    {
+        return a.callback.mean * a.calls > b.callback.mean * b.calls;
+    });
+
+    char line[160];
+    out << "[JSBridge] Call stats, percentiles in microseconds\n";
+    std::snprintf(line, sizeof(line), "%-24s %10s %10s %17s %26s %17s", "function", "calls", "total ms",
+                  "args p50/p99", "callback p50/p99/max", "result p50/p99");
+    out << line << '\n';
+    for (const Row& row : rows)
+    {
+        std::snprintf(line, sizeof(line), "%-24s %10llu %10.2f %8.2f/%-8.2f %8.2f/%8.2f/%-8.2f %8.2f/%.2f",
+                      row.name->c_str(), static_cast<unsigned long long>(row.calls),
+                      row.callback.mean * row.calls / 1e6,
+                      row.arguments.p50 / 1e3, row.arguments.p99 / 1e3,
+                      row.callback.p50 / 1e3, row.callback.p99 / 1e3, row.callback.max / 1e3,
+                      row.result.p50 / 1e3, row.result.p99 / 1e3);
+        out << line << '\n';
+    }
+    out.flush();
+}
+
+JSValueRef JSBridge::JSStatsHandler(JSContextRef ctx, JSObjectRef function,
+                                    JSObjectRef thisObject, size_t argumentCount,
+                                    const JSValueRef arguments[], JSValueRef* exception)
+{
+    JSBridge* bridge = static_cast<JSBridge*>(JSObjectGetPrivate(function));
+    if (!bridge)
+        return JSValueMakeUndefined(ctx);
+
+    JSValueRef stats = ConvertToJS(ctx, bridge->GetStats());
+    if (argumentCount > 0 && JSValueToBoolean(ctx, arguments[0]))
+        bridge->ResetStats();
+    return stats;
+}
+
+bool JSBridge::WriteTypeScript(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cerr << "[JSBridge] Failed to write " << path << std::endl;
+        return false;
+    }
+
+    file << "// Generated by JSBridge::WriteTypeScript from the functions registered at\n"
+         << "// startup. Do not edit; regenerate with the bridge-types build target.\n\n"
+         << "export interface NativeFunctions {\n";
+    for (const std::unique_ptr<FunctionSlot>& slot : m_Slots)
+    {
+        if (!slot->callback)
+            continue;
+        file << "  " << slot->name << (slot->signature.empty() ? "(...args: any[]): any" : slot->signature) << ";\n";
+    }
+    file << "}\n\n"
+         << "export interface SharedBlocks {\n";
+    for (const std::shared_ptr<SharedBlock>& block : m_SharedBlocks)
+    {
+        file << "  " << block->GetName() << ": {";
+        for (const SharedBlock::Field& field : block->GetFields())
+            file << " " << field.name << ": number;";
+        file << " };\n";
+    }
+    file << "}\n";
+
+    return static_cast<bool>(file);
+}
+
+std::shared_ptr<SharedBlock> JSBridge::CreateSharedBlock(const std::string& name,
+                                                         std::vector<SharedBlock::Field> fields)
+{
+    for (const std::shared_ptr<SharedBlock>& block : m_SharedBlocks)
+    {
+        if (block->GetName() == name)
+            return block;
+    }
+
+    m_SharedBlocks.push_back(std::make_shared<SharedBlock>(name, std::move(fields)));
+    return m_SharedBlocks.back();
+}
+
+void JSBridge::SetRunOnJSThread(const std::string& name, bool enabled)
+{
+    auto it = m_Functions.find(name);
+    if (it != m_Functions.end())
+        it->second->onJSThread = enabled;
 }
 
 void JSBridge::Unregister(const std::string& name)
 {
-    m_Functions.erase(name);
+    auto it = m_Functions.find(name);
+    if (it != m_Functions.end())
+    {
+        it->second->callback = nullptr;
+        it->second->direct = nullptr;
+    }
+}
+
+JSValueRef JSBridge::StartAsync(JSContextRef ctx, FunctionSlot& slot, JSArgs args, bool timed)
+{
+    JSObjectRef resolve = nullptr;
+    JSObjectRef reject = nullptr;
+    JSObjectRef promise = JSObjectMakeDeferredPromise(ctx, &resolve, &reject, nullptr);
+    if (!promise)
+        return JSValueMakeUndefined(ctx);
+
+    // Kept alive until the result comes back; the context too, in case the
+    // page navigates away meanwhile
+    JSValueProtect(ctx, resolve);
+    JSValueProtect(ctx, reject);
+    uint64_t id = m_NextAsyncID++;
+    m_PendingPromises[id] = { JSGlobalContextRetain(JSContextGetGlobalContext(ctx)), resolve, reject };
+
+    // The pool outlives the call, so borrowed buffers are copied, and the
+    // callback is copied in case the function is re-registered meanwhile
+    for (JSValue& arg : args)
+        TakeOwnership(arg);
+
+    CallStats* stats = timed ? slot.stats.get() : nullptr;
+    m_AsyncPool->Submit([this, id, callback = slot.callback, name = slot.name, args = std::move(args), stats]()
+    {
+        AsyncResult result{ id, false, nullptr, {} };
+        try
+        {
+            uint64_t start = stats ? CycleClock::Now() : 0;
+            result.value = callback(args);
+            if (stats)
+                stats->callback.Record(CycleClock::Now() - start);
+            result.succeeded = true;
+        }
+        catch (const std::exception& e)
+        {
+            result.error = e.what();
+        }
+        catch (...)
+        {
+            result.error = "Unknown error in " + name;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_AsyncMutex);
+            m_AsyncResults.push_back(std::move(result));
+        }
+        if (m_WakeCallback)
+            m_WakeCallback();
+    });
+    return promise;
+}
+
+void JSBridge::ResolveAsyncCalls()
+{
+    std::vector<AsyncResult> results;
+    {
+        std::lock_guard<std::mutex> lock(m_AsyncMutex);
+        if (m_AsyncResults.empty())
+            return;
+        results.swap(m_AsyncResults);
+    }
+
+    for (AsyncResult& result : results)
+    {
+        auto it = m_PendingPromises.find(result.id);
+        if (it == m_PendingPromises.end())
+            continue;
+
+        PendingPromise pending = it->second;
+        m_PendingPromises.erase(it);
+        JSContextRef ctx = pending.context;
+
+        if (result.succeeded)
+        {
+            JSValueRef value = ConvertToJS(ctx, result.value);
+            JSObjectCallAsFunction(ctx, pending.resolve, nullptr, 1, &value, nullptr);
+        }
+        else
+        {
+            JSStringRef messageStr = JSStringCreateWithUTF8CString(result.error.c_str());
+            JSValueRef message = JSValueMakeString(ctx, messageStr);
+            JSStringRelease(messageStr);
+            JSValueRef error = JSObjectMakeError(ctx, 1, &message, nullptr);
+            JSObjectCallAsFunction(ctx, pending.reject, nullptr, 1, &error, nullptr);
+        }
+
+        JSValueUnprotect(ctx, pending.resolve);
+        JSValueUnprotect(ctx, pending.reject);
+        JSGlobalContextRelease(pending.context);
+    }
+}
+
+void JSBridge::FinishAsyncCalls()
+{
+    if (m_AsyncPool)
+        m_AsyncPool->WaitIdle();
+    ResolveAsyncCalls();
+}
+
+void JSBridge::EmitEvent(const std::string& name, JSValue payload, const std::string& key)
+{
+    TakeOwnership(payload);
+
+    bool wasEmpty;
+    {
+        std::lock_guard<std::mutex> lock(m_EventMutex);
+        wasEmpty = m_Events.empty();
+
+        std::string eventKey = name + '\0' + key;
+        auto it = m_EventIndex.find(eventKey);
+        if (it != m_EventIndex.end())
+        {
+            m_Events[it->second].payload = std::move(payload);
+        }
+        else
+        {
+            m_EventIndex.emplace(std::move(eventKey), m_Events.size());
+            m_Events.push_back({ name, key, std::move(payload) });
+        }
+    }
+
+    // One wake-up per batch of events is enough
+    if (wasEmpty && m_WakeCallback)
+        m_WakeCallback();
+}
+
+void JSBridge::DispatchEvents()
+{
+    std::vector<PendingEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(m_EventMutex);
+        if (m_Events.empty())
+            return;
+        events.swap(m_Events);
+        m_EventIndex.clear();
+    }
+
+    static JSStringRef typeName = JSStringCreateWithUTF8CString("type");
+    static JSStringRef keyName = JSStringCreateWithUTF8CString("key");
+    static JSStringRef detailName = JSStringCreateWithUTF8CString("detail");
+
+    // Copied, since a listener may replace itself while being called
+    std::vector<EventListener> listeners = m_Listeners;
+    for (const EventListener& listener : listeners)
+    {
+        JSContextRef ctx = listener.context;
+        JSObjectRef array = JSObjectMakeArray(ctx, 0, nullptr, nullptr);
+        for (size_t i = 0; i < events.size(); i++)
+        {
+            JSObjectRef event = JSObjectMake(ctx, nullptr, nullptr);
+            JSObjectSetProperty(ctx, event, typeName, ConvertToJS(ctx, events[i].name), kJSPropertyAttributeNone, nullptr);
+            JSObjectSetProperty(ctx, event, keyName, ConvertToJS(ctx, events[i].key), kJSPropertyAttributeNone, nullptr);
+            JSObjectSetProperty(ctx, event, detailName, ConvertToJS(ctx, events[i].payload), kJSPropertyAttributeNone, nullptr);
+            JSObjectSetPropertyAtIndex(ctx, array, static_cast<unsigned>(i), event, nullptr);
+        }
+
+        JSValueRef argument = array;
+        JSValueRef exception = nullptr;
+        JSObjectCallAsFunction(ctx, listener.function, nullptr, 1, &argument, &exception);
+        if (exception)
+            std::cerr << "[JSBridge] Event listener threw: " << GetStringFromJS(ctx, exception) << std::endl;
+    }
+}
+
+void JSBridge::ReleaseContext(JSGlobalContextRef context)
+{
+    for (auto it = m_Listeners.begin(); it != m_Listeners.end(); ++it)
+    {
+        if (it->context == context)
+        {
+            JSValueUnprotect(it->context, it->function);
+            JSGlobalContextRelease(it->context);
+            m_Listeners.erase(it);
+            return;
+        }
+    }
+}
+
+JSValueRef JSBridge::JSListenHandler(JSContextRef ctx, JSObjectRef function,
+                                     JSObjectRef thisObject, size_t argumentCount,
+                                     const JSValueRef arguments[], JSValueRef* exception)
+{
+    JSBridge* bridge = static_cast<JSBridge*>(JSObjectGetPrivate(function));
+    if (!bridge)
+        return JSValueMakeUndefined(ctx);
+
+    bridge->ReleaseContext(JSContextGetGlobalContext(ctx));
+
+    JSObjectRef listener = argumentCount > 0 && JSValueIsObject(ctx, arguments[0])
+                               ? JSValueToObject(ctx, arguments[0], nullptr) : nullptr;
+    if (listener && JSObjectIsFunction(ctx, listener))
+    {
+        // Held until replaced, released or the bridge goes away
+        JSValueProtect(ctx, listener);
+        bridge->m_Listeners.push_back({ JSGlobalContextRetain(JSContextGetGlobalContext(ctx)), listener });
+    }
+    return JSValueMakeUndefined(ctx);
 }
 
 std::string JSBridge::GetStringFromJS(JSContextRef ctx, JSValueRef value)
@@ -29,17 +464,68 @@ std::string JSBridge::GetStringFromJS(JSContextRef ctx, JSValueRef value)
     JSStringRef jsStr = JSValueToStringCopy(ctx, value, nullptr);
     if (!jsStr) return "";
     
-    size_t maxSize = JSStringGetMaximumUTF8CStringSize(jsStr);
-    std::string result(maxSize, '\0');
-    size_t actualSize = JSStringGetUTF8CString(jsStr, &result[0], maxSize);
-    result.resize(actualSize > 0 ? actualSize - 1 : 0);
+    std::string result = GetStringFromJS(jsStr);
     JSStringRelease(jsStr);
     
     return result;
 }
 
+std::string JSBridge::GetStringFromJS(JSStringRef string)
+{
+    size_t maxSize = JSStringGetMaximumUTF8CStringSize(string);
+    std::string result(maxSize, '\0');
+    size_t actualSize = JSStringGetUTF8CString(string, &result[0], maxSize);
+    result.resize(actualSize > 0 ? actualSize - 1 : 0);
+    return result;
+}
+
+bool JSBridge::GetBytesFromJS(JSContextRef ctx, JSValueRef value, JSBytes& bytes)
+{
+    JSTypedArrayType type = JSValueGetTypedArrayType(ctx, value, nullptr);
+    if (type == kJSTypedArrayTypeNone)
+        return false;
+
+    JSObjectRef object = JSValueToObject(ctx, value, nullptr);
+    bytes.type = type;
+    if (type == kJSTypedArrayTypeArrayBuffer)
+    {
+        bytes.data = static_cast<uint8_t*>(JSObjectGetArrayBufferBytesPtr(ctx, object, nullptr));
+        bytes.size = JSObjectGetArrayBufferByteLength(ctx, object, nullptr);
+        return true;
+    }
+
+    // Older JavaScriptCore returns the start of the whole buffer from
+    // JSObjectGetTypedArrayBytesPtr, so apply the view's offset explicitly.
+    JSObjectRef buffer = JSObjectGetTypedArrayBuffer(ctx, object, nullptr);
+    uint8_t* base = buffer ? static_cast<uint8_t*>(JSObjectGetArrayBufferBytesPtr(ctx, buffer, nullptr)) : nullptr;
+    bytes.size = JSObjectGetTypedArrayByteLength(ctx, object, nullptr);
+    bytes.data = base ? base + JSObjectGetTypedArrayByteOffset(ctx, object, nullptr) : nullptr;
+    if (!bytes.data)
+        bytes.size = 0;
+    return true;
+}
+
 JSValue JSBridge::ConvertFromJS(JSContextRef ctx, JSValueRef value)
 {
+    ConversionState state{ {}, MAX_VALUE_COUNT };
+    JSValue result = ConvertFromJS(ctx, value, state);
+    if (state.cyclic)
+        std::cerr << "[JSBridge] Value contains a reference cycle, passing null for it" << std::endl;
+    if (state.truncated)
+        std::cerr << "[JSBridge] Value has more than " << MAX_VALUE_COUNT << " elements, passing null for the rest"
+                  << std::endl;
+    return result;
+}
+
+JSValue JSBridge::ConvertFromJS(JSContextRef ctx, JSValueRef value, ConversionState& state)
+{
+    if (state.remaining == 0)
+    {
+        state.truncated = true;
+        return nullptr;
+    }
+    state.remaining--;
+
     if (JSValueIsNull(ctx, value) || JSValueIsUndefined(ctx, value))
         return nullptr;
     
@@ -51,9 +537,86 @@ JSValue JSBridge::ConvertFromJS(JSContextRef ctx, JSValueRef value)
     
     if (JSValueIsString(ctx, value))
         return GetStringFromJS(ctx, value);
-    
-    // For objects/arrays, convert to string representation
-    return GetStringFromJS(ctx, value);
+
+    JSBytes bytes;
+    if (GetBytesFromJS(ctx, value, bytes))
+        return bytes;
+
+    JSObjectRef object = JSValueToObject(ctx, value, nullptr);
+    if (!object || JSObjectIsFunction(ctx, object))
+        return GetStringFromJS(ctx, value);
+
+    if (state.path.size() >= MAX_VALUE_DEPTH)
+    {
+        std::cerr << "[JSBridge] Value nested deeper than " << MAX_VALUE_DEPTH << " levels, passing null" << std::endl;
+        return nullptr;
+    }
+
+    // Only a repeat on the current path is a cycle; an object reached twice
+    // through different fields is converted each time, like JSON.stringify
+    if (std::find(state.path.begin(), state.path.end(), object) != state.path.end())
+    {
+        state.cyclic = true;
+        return nullptr;
+    }
+    state.path.push_back(object);
+
+    if (JSValueIsArray(ctx, value))
+    {
+        static JSStringRef lengthName = JSStringCreateWithUTF8CString("length");
+        double length = JSValueToNumber(ctx, JSObjectGetProperty(ctx, object, lengthName, nullptr), nullptr);
+        unsigned count = length > 0.0 ? static_cast<unsigned>(length) : 0;
+
+        JSArray array;
+        array.reserve(std::min<size_t>(count, state.remaining));
+        for (unsigned i = 0; i < count && !state.truncated; i++)
+            array.push_back(ConvertFromJS(ctx, JSObjectGetPropertyAtIndex(ctx, object, i, nullptr), state));
+        state.path.pop_back();
+        return array;
+    }
+
+    // Own and inherited enumerable properties; functions are skipped like
+    // JSON.stringify does
+    JSPropertyNameArrayRef names = JSObjectCopyPropertyNames(ctx, object);
+    size_t count = JSPropertyNameArrayGetCount(names);
+
+    JSObject result;
+    result.fields.reserve(count);
+    for (size_t i = 0; i < count && !state.truncated; i++)
+    {
+        JSStringRef name = JSPropertyNameArrayGetNameAtIndex(names, i);
+        JSValueRef field = JSObjectGetProperty(ctx, object, name, nullptr);
+        if (JSValueIsObject(ctx, field) && JSObjectIsFunction(ctx, JSValueToObject(ctx, field, nullptr)))
+            continue;
+
+        result.fields.emplace_back(GetStringFromJS(name), ConvertFromJS(ctx, field, state));
+    }
+    JSPropertyNameArrayRelease(names);
+    state.path.pop_back();
+    return result;
+}
+
+void JSBridge::TakeOwnership(JSValue& value)
+{
+    if (auto* bytes = std::get_if<JSBytes>(&value))
+    {
+        if (!bytes->owner)
+        {
+            JSBytes owned = JSBytes::FromVector(std::vector<uint8_t>(bytes->data, bytes->data + bytes->size));
+            owned.type = bytes->type;
+            *bytes = std::move(owned);
+        }
+    }
+    else if (auto* array = std::get_if<JSArray>(&value))
+    {
+        for (JSValue& element : *array)
+            TakeOwnership(element);
+    }
+    else if (auto* object = std::get_if<JSObject>(&value))
+    {
+        for (auto& field : object->fields)
+            TakeOwnership(field.second);
+    }
 }
 
 JSValueRef JSBridge::ConvertToJS(JSContextRef ctx, const JSValue& value)
@@ -74,45 +637,311 @@ JSValueRef JSBridge::ConvertToJS(JSContextRef ctx, const JSValue& value)
         JSStringRelease(jsStr);
         return result;
     }
+
+    if (auto* bytes = std::get_if<JSBytes>(&value))
+    {
+        JSObjectRef buffer = nullptr;
+        if (bytes->owner)
+        {
+            // JS takes a reference; the storage lives until it is collected
+            auto* owner = new std::shared_ptr<void>(bytes->owner);
+            buffer = JSObjectMakeArrayBufferWithBytesNoCopy(ctx, bytes->data, bytes->size,
+                [](void*, void* context) { delete static_cast<std::shared_ptr<void>*>(context); },
+                owner, nullptr);
+            if (!buffer)
+                delete owner;
+        }
+        else
+        {
+            // Borrowed memory can't outlive the call, so JS gets a copy
+            JSObjectRef copy = JSObjectMakeTypedArray(ctx, kJSTypedArrayTypeUint8Array, bytes->size, nullptr);
+            if (copy)
+            {
+                buffer = JSObjectGetTypedArrayBuffer(ctx, copy, nullptr);
+                if (bytes->size > 0)
+                    std::memcpy(JSObjectGetArrayBufferBytesPtr(ctx, buffer, nullptr), bytes->data, bytes->size);
+            }
+        }
+
+        if (!buffer)
+            return JSValueMakeNull(ctx);
+        if (bytes->type == kJSTypedArrayTypeArrayBuffer || bytes->type == kJSTypedArrayTypeNone)
+            return buffer;
+        return JSObjectMakeTypedArrayWithArrayBuffer(ctx, bytes->type, buffer, nullptr);
+    }
+
+    if (auto* array = std::get_if<JSArray>(&value))
+    {
+        // Store each element as it is made: the collector doesn't scan
+        // values held only in native heap memory.
+        JSObjectRef result = JSObjectMakeArray(ctx, 0, nullptr, nullptr);
+        for (size_t i = 0; i < array->size(); i++)
+            JSObjectSetPropertyAtIndex(ctx, result, static_cast<unsigned>(i), ConvertToJS(ctx, (*array)[i]), nullptr);
+        return result;
+    }
+
+    if (auto* object = std::get_if<JSObject>(&value))
+    {
+        JSObjectRef result = JSObjectMake(ctx, nullptr, nullptr);
+        for (const auto& field : object->fields)
+        {
+            JSStringRef name = JSStringCreateWithUTF8CString(field.first.c_str());
+            JSObjectSetProperty(ctx, result, name, ConvertToJS(ctx, field.second), kJSPropertyAttributeNone, nullptr);
+            JSStringRelease(name);
+        }
+        return result;
+    }
     
     return JSValueMakeUndefined(ctx);
 }
 
+bool JSBridge::SampleCall(FunctionSlot& slot)
+{
+    if (!slot.bridge->m_Profiling.load(std::memory_order_relaxed))
+        return false;
+
+    // A plain load and store; the JS thread is the only writer
+    uint64_t calls = slot.stats->calls.load(std::memory_order_relaxed);
+    slot.stats->calls.store(calls + 1, std::memory_order_relaxed);
+    return calls % PROFILE_SAMPLE_INTERVAL == 0;
+}
+
+bool JSBridge::Invoke(const FunctionSlot& slot, const JSArgs& args, JSValue& result, bool timed)
+{
+    if (!slot.callback)
+    {
+        std::cerr << "[JSBridge] Function not found: " << slot.name << std::endl;
+        return false;
+    }
+
+    try
+    {
+        if (!timed)
+        {
+            result = slot.callback(args);
+            return true;
+        }
+
+        uint64_t start = CycleClock::Now();
+        result = slot.callback(args);
+        slot.stats->callback.Record(CycleClock::Now() - start);
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[JSBridge] Exception in " << slot.name << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
 JSValueRef JSBridge::JSCallHandler(JSContextRef ctx, JSObjectRef function,
                                    JSObjectRef thisObject, size_t argumentCount,
                                    const JSValueRef arguments[], JSValueRef* exception)
 {
-    if (!s_Instance)
+    FunctionSlot* slot = static_cast<FunctionSlot*>(JSObjectGetPrivate(function));
+    if (!slot)
         return JSValueMakeUndefined(ctx);
-    
-    JSStringRef nameProperty = JSStringCreateWithUTF8CString("_nativeFuncName");
-    JSValueRef nameValue = JSObjectGetProperty(ctx, function, nameProperty, nullptr);
-    JSStringRelease(nameProperty);
-    
-    std::string funcName = GetStringFromJS(ctx, nameValue);
-    
-    auto it = s_Instance->m_Functions.find(funcName);
-    if (it == s_Instance->m_Functions.end())
+
+    if (!slot->callback)
     {
-        std::cerr << "[JSBridge] Function not found: " << funcName << std::endl;
+        std::cerr << "[JSBridge] Function not found: " << slot->name << std::endl;
         return JSValueMakeUndefined(ctx);
     }
-    
+
+    // Timestamps for the three phases, only for the sampled calls
+    bool timed = SampleCall(*slot);
+    uint64_t start = timed ? CycleClock::Now() : 0;
+
+    bool dispatched = slot->bridge->m_Dispatcher && !slot->onJSThread;
+    if (slot->direct && !dispatched)
+    {
+        try
+        {
+            if (!timed)
+                return slot->direct(ctx, argumentCount, arguments, nullptr);
+
+            JSCallMarks marks;
+            JSValueRef result = slot->direct(ctx, argumentCount, arguments, &marks);
+            uint64_t end = CycleClock::Now();
+            slot->stats->arguments.Record(marks.converted - start);
+            slot->stats->callback.Record(marks.called - marks.converted);
+            slot->stats->result.Record(end - marks.called);
+            return result;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "[JSBridge] Exception in " << slot->name << ": " << e.what() << std::endl;
+            return JSValueMakeUndefined(ctx);
+        }
+    }
+
     JSArgs args;
     args.reserve(argumentCount);
     for (size_t i = 0; i < argumentCount; i++)
         args.push_back(ConvertFromJS(ctx, arguments[i]));
-    
-    try
+    if (timed)
+        slot->stats->arguments.Record(CycleClock::Now() - start);
+
+    if (slot->async)
+        return slot->bridge->StartAsync(ctx, *slot, std::move(args), timed);
+
+    if (dispatched)
     {
-        JSValue result = it->second(args);
-        return ConvertToJS(ctx, result);
+        // The call runs after JS has moved on, so borrowed buffers are copied
+        for (JSValue& arg : args)
+            TakeOwnership(arg);
+
+        // Slots outlive the call, and registration happens on the thread the
+        // dispatcher runs calls on, so the slot is read when the call runs.
+        slot->bridge->m_Dispatcher([slot, args = std::move(args), timed]()
+        {
+            JSValue result;
+            Invoke(*slot, args, result, timed);
+        });
+        return JSValueMakeUndefined(ctx);
     }
-    catch (const std::exception& e)
+    
+    JSValue result;
+    if (!Invoke(*slot, args, result, timed))
+        return JSValueMakeUndefined(ctx);
+    if (!timed)
+        return ConvertToJS(ctx, result);
+
+    uint64_t converting = CycleClock::Now();
+    JSValueRef converted = ConvertToJS(ctx, result);
+    slot->stats->result.Record(CycleClock::Now() - converting);
+    return converted;
+}
+
+bool JSBridge::DecodeBatch(const JSBytes& batch, std::vector<BatchedCall>& calls) const
+{
+    const uint8_t* cursor = batch.data;
+    const uint8_t* end = batch.data + batch.size;
+    auto read = [&cursor, end](void* out, size_t size)
+    {
+        if (static_cast<size_t>(end - cursor) < size)
+            return false;
+        std::memcpy(out, cursor, size);
+        cursor += size;
+        return true;
+    };
+
+    uint32_t commandCount = 0;
+    if (!batch.data || !read(&commandCount, sizeof(commandCount)))
+        return false;
+
+    // Every command takes at least three bytes, which bounds the reserve
+    calls.reserve(std::min<size_t>(commandCount, batch.size / 3));
+    for (uint32_t i = 0; i < commandCount; i++)
     {
-        std::cerr << "[JSBridge] Exception in " << funcName << ": " << e.what() << std::endl;
+        uint16_t functionId = 0;
+        uint8_t argCount = 0;
+        if (!read(&functionId, sizeof(functionId)) || !read(&argCount, sizeof(argCount)))
+            return false;
+        if (functionId >= m_Slots.size())
+            return false;
+
+        BatchedCall call{ m_Slots[functionId].get(), {} };
+        call.args.reserve(argCount);
+        for (uint8_t a = 0; a < argCount; a++)
+        {
+            uint8_t tag = 0;
+            if (!read(&tag, sizeof(tag)))
+                return false;
+
+            switch (tag)
+            {
+            case 0:
+                call.args.push_back(nullptr);
+                break;
+            case 1:
+            case 2:
+                call.args.push_back(tag == 2);
+                break;
+            case 3:
+            {
+                int32_t value = 0;
+                if (!read(&value, sizeof(value)))
+                    return false;
+                call.args.push_back(static_cast<double>(value));
+                break;
+            }
+            case 4:
+            {
+                double value = 0.0;
+                if (!read(&value, sizeof(value)))
+                    return false;
+                call.args.push_back(value);
+                break;
+            }
+            case 5:
+            {
+                uint32_t length = 0;
+                if (!read(&length, sizeof(length)) || static_cast<size_t>(end - cursor) < length)
+                    return false;
+                call.args.push_back(std::string(reinterpret_cast<const char*>(cursor), length));
+                cursor += length;
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+        calls.push_back(std::move(call));
+    }
+    return true;
+}
+
+JSValueRef JSBridge::JSBatchHandler(JSContextRef ctx, JSObjectRef function,
+                                    JSObjectRef thisObject, size_t argumentCount,
+                                    const JSValueRef arguments[], JSValueRef* exception)
+{
+    JSBridge* bridge = static_cast<JSBridge*>(JSObjectGetPrivate(function));
+    JSBytes batch;
+    if (!bridge || argumentCount < 1 || !GetBytesFromJS(ctx, arguments[0], batch))
         return JSValueMakeUndefined(ctx);
+
+    // Decoding copies everything out of the JS buffer, so JS may reuse it
+    // as soon as this returns.
+    std::vector<BatchedCall> calls;
+    if (!bridge->DecodeBatch(batch, calls))
+        std::cerr << "[JSBridge] Malformed batch, running the first " << calls.size() << " commands" << std::endl;
+
+    // One pass in batch order. Calls for the dispatcher are collected and
+    // handed over together at the end, still in batch order among themselves.
+    JSObjectRef results = JSObjectMakeArray(ctx, 0, nullptr, nullptr);
+    std::vector<BatchedCall> dispatched;
+    for (size_t i = 0; i < calls.size(); i++)
+    {
+        calls[i].timed = SampleCall(*calls[i].slot);
+        JSValueRef converted;
+        if (calls[i].slot->async && calls[i].slot->callback)
+        {
+            converted = bridge->StartAsync(ctx, *calls[i].slot, std::move(calls[i].args), calls[i].timed);
+        }
+        else if (bridge->m_Dispatcher && !calls[i].slot->onJSThread)
+        {
+            dispatched.push_back(std::move(calls[i]));
+            continue;
+        }
+        else
+        {
+            JSValue result;
+            converted = Invoke(*calls[i].slot, calls[i].args, result, calls[i].timed) ? ConvertToJS(ctx, result) : JSValueMakeUndefined(ctx);
+        }
+        JSObjectSetPropertyAtIndex(ctx, results, static_cast<unsigned>(i), converted, nullptr);
+    }
+
+    if (!dispatched.empty())
+    {
+        bridge->m_Dispatcher([calls = std::move(dispatched)]()
+        {
+            JSValue result;
+            for (const BatchedCall& call : calls)
+                Invoke(*call.slot, call.args, result, call.timed);
+        });
     }
+    return results;
 }
 
 void JSBridge::BindToContext(JSContextRef ctx)
@@ -125,27 +954,114 @@ void JSBridge::BindToContext(JSContextRef ctx)
     JSObjectRef nativeObj = JSObjectMake(ctx, classRef, nullptr);
     JSClassRelease(classRef);
     
-    for (const auto& [name, callback] : m_Functions)
-    {
-        JSStringRef funcNameStr = JSStringCreateWithUTF8CString(name.c_str());
-        JSObjectRef funcObj = JSObjectMakeFunctionWithCallback(ctx, funcNameStr, JSCallHandler);
-        
-        JSStringRef nameProperty = JSStringCreateWithUTF8CString("_nativeFuncName");
-        JSStringRef nameValue = JSStringCreateWithUTF8CString(name.c_str());
-        JSObjectSetProperty(ctx, funcObj, nameProperty, 
-                          JSValueMakeString(ctx, nameValue), 
-                          kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontEnum, nullptr);
-        JSStringRelease(nameProperty);
-        JSStringRelease(nameValue);
-        
+    // Class-backed functions don't inherit from Function.prototype on their
+    // own; give them call/apply/bind like any other function.
+    JSValueRef functionPrototype = nullptr;
+    JSStringRef functionName = JSStringCreateWithUTF8CString("Function");
+    JSValueRef functionConstructor = JSObjectGetProperty(ctx, globalObj, functionName, nullptr);
+    JSStringRelease(functionName);
+    if (JSValueIsObject(ctx, functionConstructor))
+    {
+        JSStringRef prototypeName = JSStringCreateWithUTF8CString("prototype");
+        functionPrototype = JSObjectGetProperty(ctx, JSValueToObject(ctx, functionConstructor, nullptr),
+                                                prototypeName, nullptr);
+        JSStringRelease(prototypeName);
+    }
+
+    // Batch ids are slot indices, which never change for a name
+    JSObjectRef functionIds = JSObjectMake(ctx, nullptr, nullptr);
+    size_t boundCount = 0;
+    for (size_t i = 0; i < m_Slots.size(); i++)
+    {
+        const FunctionSlot* slot = m_Slots[i].get();
+        if (!slot->callback)
+            continue;
+
+        JSObjectRef funcObj = JSObjectMake(ctx, m_FunctionClass, m_Slots[i].get());
+        if (functionPrototype)
+            JSObjectSetPrototype(ctx, funcObj, functionPrototype);
+
+        JSStringRef funcNameStr = JSStringCreateWithUTF8CString(slot->name.c_str());
         JSObjectSetProperty(ctx, nativeObj, funcNameStr, funcObj, kJSPropertyAttributeNone, nullptr);
+        if (i <= UINT16_MAX)
+            JSObjectSetProperty(ctx, functionIds, funcNameStr, JSValueMakeNumber(ctx, static_cast<double>(i)),
+                                kJSPropertyAttributeNone, nullptr);
         JSStringRelease(funcNameStr);
+        boundCount++;
+    }
+
+    JSObjectRef batchObj = JSObjectMake(ctx, m_BatchClass, this);
+    if (functionPrototype)
+        JSObjectSetPrototype(ctx, batchObj, functionPrototype);
+
+    const JSPropertyAttributes hidden = kJSPropertyAttributeReadOnly | kJSPropertyAttributeDontEnum;
+    JSStringRef batchName = JSStringCreateWithUTF8CString("__batch");
+    JSObjectSetProperty(ctx, nativeObj, batchName, batchObj, hidden, nullptr);
+    JSStringRelease(batchName);
+    JSStringRef idsName = JSStringCreateWithUTF8CString("__functions");
+    JSObjectSetProperty(ctx, nativeObj, idsName, functionIds, hidden, nullptr);
+    JSStringRelease(idsName);
+
+    JSObjectRef listenObj = JSObjectMake(ctx, m_ListenClass, this);
+    if (functionPrototype)
+        JSObjectSetPrototype(ctx, listenObj, functionPrototype);
+    JSStringRef listenName = JSStringCreateWithUTF8CString("__listen");
+    JSObjectSetProperty(ctx, nativeObj, listenName, listenObj, hidden, nullptr);
+    JSStringRelease(listenName);
+
+    JSObjectRef statsObj = JSObjectMake(ctx, m_StatsClass, this);
+    if (functionPrototype)
+        JSObjectSetPrototype(ctx, statsObj, functionPrototype);
+    JSStringRef statsName = JSStringCreateWithUTF8CString("__stats");
+    JSObjectSetProperty(ctx, nativeObj, statsName, statsObj, hidden, nullptr);
+    JSStringRelease(statsName);
+
+    // Each buffer holds a reference to its block, so the memory stays valid
+    // for as long as the page can reach it
+    JSObjectRef sharedObj = JSObjectMake(ctx, nullptr, nullptr);
+    for (const std::shared_ptr<SharedBlock>& block : m_SharedBlocks)
+    {
+        auto* owner = new std::shared_ptr<SharedBlock>(block);
+        JSObjectRef buffer = JSObjectMakeArrayBufferWithBytesNoCopy(
+            ctx, block->GetData(), block->GetSize(),
+            [](void*, void* context) { delete static_cast<std::shared_ptr<SharedBlock>*>(context); }, owner, nullptr);
+        if (!buffer)
+        {
+            delete owner;
+            continue;
+        }
+
+        JSObjectRef fields = JSObjectMake(ctx, nullptr, nullptr);
+        for (const SharedBlock::Field& field : block->GetFields())
+        {
+            JSObject layout;
+            layout.fields.emplace_back("offset", static_cast<double>(field.offset));
+            layout.fields.emplace_back("type", std::string(SharedBlock::FieldTypeName(field.type)));
+            JSStringRef fieldName = JSStringCreateWithUTF8CString(field.name.c_str());
+            JSObjectSetProperty(ctx, fields, fieldName, ConvertToJS(ctx, layout), kJSPropertyAttributeNone, nullptr);
+            JSStringRelease(fieldName);
+        }
+
+        JSObjectRef entry = JSObjectMake(ctx, nullptr, nullptr);
+        JSStringRef bufferName = JSStringCreateWithUTF8CString("buffer");
+        JSObjectSetProperty(ctx, entry, bufferName, buffer, kJSPropertyAttributeReadOnly, nullptr);
+        JSStringRelease(bufferName);
+        JSStringRef fieldsName = JSStringCreateWithUTF8CString("fields");
+        JSObjectSetProperty(ctx, entry, fieldsName, fields, kJSPropertyAttributeReadOnly, nullptr);
+        JSStringRelease(fieldsName);
+
+        JSStringRef blockName = JSStringCreateWithUTF8CString(block->GetName().c_str());
+        JSObjectSetProperty(ctx, sharedObj, blockName, entry, kJSPropertyAttributeReadOnly, nullptr);
+        JSStringRelease(blockName);
     }
+    JSStringRef sharedName = JSStringCreateWithUTF8CString("__shared");
+    JSObjectSetProperty(ctx, nativeObj, sharedName, sharedObj, hidden, nullptr);
+    JSStringRelease(sharedName);
     
     JSStringRef nativeName = JSStringCreateWithUTF8CString("native");
     JSObjectSetProperty(ctx, globalObj, nativeName, nativeObj, kJSPropertyAttributeNone, nullptr);
     JSStringRelease(nativeName);
     
-    std::cout << "[JSBridge] Bound " << m_Functions.size() << " functions to window.native" << std::endl;
+    std::cout << "[JSBridge] Bound " << boundCount << " functions to window.native" << std::endl;
 }
 
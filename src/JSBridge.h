@@ -1,46 +1,433 @@
 #pragma once
 
+#include "LatencyHistogram.h"
+#include "SharedBlock.h"
 #include <JavaScriptCore/JavaScript.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <functional>
+#include <iosfwd>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <variant>
 #include <optional>
 
+// Bytes of an ArrayBuffer or typed array. Arguments arrive borrowed: data
+// points straight into the JS-owned storage and is only valid until the
+// callback returns or calls back into JS, so copy what must be kept. A
+// buffer returned to JS with an owner is handed over without copying and
+// released once JS collects it; one without an owner is copied.
+struct JSBytes
+{
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    // Element type, or kJSTypedArrayTypeArrayBuffer for a plain buffer
+    JSTypedArrayType type = kJSTypedArrayTypeArrayBuffer;
+    std::shared_ptr<void> owner;
+
+    template<typename T>
+    const T* As() const { return reinterpret_cast<const T*>(data); }
+    template<typename T>
+    size_t Count() const { return size / sizeof(T); }
+
+    // Takes ownership of the vector's storage.
+    template<typename T>
+    static JSBytes FromVector(std::vector<T> values, JSTypedArrayType type = kJSTypedArrayTypeArrayBuffer)
+    {
+        auto storage = std::make_shared<std::vector<T>>(std::move(values));
+        JSBytes bytes;
+        bytes.data = reinterpret_cast<uint8_t*>(storage->data());
+        bytes.size = storage->size() * sizeof(T);
+        bytes.type = type;
+        bytes.owner = std::move(storage);
+        return bytes;
+    }
+};
+
+// JSBytes of one typed array type. As a typed parameter, any other type
+// fails the call; as a result, JS gets that typed array. The TypeScript
+// declarations name the type too.
+template<JSTypedArrayType Type>
+struct JSTypedArray : JSBytes
+{
+    JSTypedArray() { type = Type; }
+    explicit JSTypedArray(JSBytes bytes) : JSBytes(std::move(bytes)) { type = Type; }
+
+    template<typename T>
+    static JSTypedArray FromVector(std::vector<T> values) { return JSTypedArray(JSBytes::FromVector(std::move(values))); }
+};
+
+using JSUint8Array = JSTypedArray<kJSTypedArrayTypeUint8Array>;
+using JSInt32Array = JSTypedArray<kJSTypedArrayTypeInt32Array>;
+using JSUint32Array = JSTypedArray<kJSTypedArrayTypeUint32Array>;
+using JSFloat32Array = JSTypedArray<kJSTypedArrayTypeFloat32Array>;
+using JSFloat64Array = JSTypedArray<kJSTypedArrayTypeFloat64Array>;
+
+struct JSValue;
+
+using JSArray = std::vector<JSValue>;
+
+// Plain JS object as a flat list of fields in property order. One
+// allocation per object, reserved up front from the property count.
+struct JSObject
+{
+    std::vector<std::pair<std::string, JSValue>> fields;
+
+    // Linear scan; fine for the handful of lookups a callback does, iterate
+    // fields directly to read everything.
+    const JSValue* Find(const std::string& key) const;
+    // Replaces an existing field or appends a new one.
+    void Set(const std::string& key, JSValue value);
+};
+
 // Supported JS value types
-using JSValue = std::variant<std::nullptr_t, bool, double, std::string>;
+using JSValueVariant = std::variant<std::nullptr_t, bool, double, std::string, JSBytes, JSArray, JSObject>;
+
+// A variant that can nest; std::get_if and std::holds_alternative work on it
+// directly.
+struct JSValue : JSValueVariant
+{
+    using JSValueVariant::JSValueVariant;
+    using JSValueVariant::operator=;
+};
+
+inline const JSValue* JSObject::Find(const std::string& key) const
+{
+    for (const auto& field : fields)
+    {
+        if (field.first == key)
+            return &field.second;
+    }
+    return nullptr;
+}
+
+inline void JSObject::Set(const std::string& key, JSValue value)
+{
+    for (auto& field : fields)
+    {
+        if (field.first == key)
+        {
+            field.second = std::move(value);
+            return;
+        }
+    }
+    fields.emplace_back(key, std::move(value));
+}
+
 using JSArgs = std::vector<JSValue>;
 using JSCallback = std::function<JSValue(const JSArgs&)>;
+using JSDispatcher = std::function<void(std::function<void()>)>;
+// CycleClock times a typed call takes once its arguments are converted and
+// once its callback returns
+struct JSCallMarks
+{
+    uint64_t converted = 0;
+    uint64_t called = 0;
+};
+// Converts arguments straight from JS for a typed function; marks is null
+// unless the call is one of the profiled sample
+using JSDirectCallback = std::function<JSValueRef(JSContextRef, size_t, const JSValueRef[], JSCallMarks* marks)>;
+
+class ThreadPool;
+
+// Conversions for one C++ parameter or return type of a typed function;
+// specialized below for each supported type.
+template<typename T>
+struct JSConverter;
+template<typename T>
+struct JSVariantConverter;
 
 class JSBridge
 {
 private:
-    std::unordered_map<std::string, JSCallback> m_Functions;
+    // Calls made while profiling, and the time a sample of them spent in
+    // each phase, in CycleClock ticks. Only the JS thread counts calls.
+    struct CallStats
+    {
+        std::atomic<uint64_t> calls{ 0 };
+        LatencyHistogram arguments;
+        LatencyHistogram callback;
+        LatencyHistogram result;
+    };
+
+    // Each bound JS function carries a pointer to its slot as private data,
+    // so a call goes straight to the callback without any name lookup. Slots
+    // are never freed before the bridge; unregistering just empties one.
+    struct FunctionSlot
+    {
+        JSBridge* bridge;
+        std::string name;
+        JSCallback callback;
+        bool async = false;
+        // Runs on the JS thread even with a dispatcher set
+        bool onJSThread = false;
+        // Typed functions only: the fast path for calls made on the JS
+        // thread, and the TypeScript parameter list and return type
+        JSDirectCallback direct;
+        std::string signature;
+        std::unique_ptr<CallStats> stats;
+    };
+
+    // Promise of an async call, kept on the JS thread until it settles
+    struct PendingPromise
+    {
+        JSGlobalContextRef context;
+        JSObjectRef resolve;
+        JSObjectRef reject;
+    };
+
+    struct AsyncResult
+    {
+        uint64_t id;
+        bool succeeded;
+        JSValue value;
+        std::string error;
+    };
+
+    // Script-side receiver of native events in one context
+    struct EventListener
+    {
+        JSGlobalContextRef context;
+        JSObjectRef function;
+    };
+
+    struct PendingEvent
+    {
+        std::string name;
+        std::string key;
+        JSValue payload;
+    };
+
+    // Objects on the path from the root of a conversion, to cut reference
+    // cycles, and how many more values it may produce, to bound shared
+    // sub-objects that would otherwise be expanded once per reference
+    struct ConversionState
+    {
+        std::vector<JSObjectRef> path;
+        size_t remaining;
+        bool cyclic = false;
+        bool truncated = false;
+    };
+
+    struct BatchedCall
+    {
+        FunctionSlot* slot;
+        JSArgs args;
+        bool timed = false;
+    };
+
+    std::vector<std::unique_ptr<FunctionSlot>> m_Slots;
+    std::unordered_map<std::string, FunctionSlot*> m_Functions;
+    JSClassRef m_FunctionClass;
+    JSClassRef m_BatchClass;
+    JSClassRef m_ListenClass;
+    JSClassRef m_StatsClass;
+    std::atomic<bool> m_Profiling;
+    JSDispatcher m_Dispatcher;
     static JSBridge* s_Instance;
 
+    std::unordered_map<uint64_t, PendingPromise> m_PendingPromises;
+    uint64_t m_NextAsyncID;
+    std::mutex m_AsyncMutex;
+    std::vector<AsyncResult> m_AsyncResults;
+    std::function<void()> m_WakeCallback;
+
+    std::vector<EventListener> m_Listeners;
+    std::mutex m_EventMutex;
+    std::vector<PendingEvent> m_Events;
+    // Name and key of each queued event, to its index in m_Events
+    std::unordered_map<std::string, size_t> m_EventIndex;
+
+    std::vector<std::shared_ptr<SharedBlock>> m_SharedBlocks;
+    // Tasks record into m_Slots' CallStats, then post to m_AsyncResults under
+    // m_AsyncMutex and call m_WakeCallback. ~JSBridge joins the pool first,
+    // and declaring it after all of those keeps that true without the reset.
+    std::unique_ptr<ThreadPool> m_AsyncPool;
+
     static JSValueRef JSCallHandler(JSContextRef ctx, JSObjectRef function,
                                     JSObjectRef thisObject, size_t argumentCount,
                                     const JSValueRef arguments[], JSValueRef* exception);
+    static JSValueRef JSBatchHandler(JSContextRef ctx, JSObjectRef function,
+                                     JSObjectRef thisObject, size_t argumentCount,
+                                     const JSValueRef arguments[], JSValueRef* exception);
+    static JSValueRef JSListenHandler(JSContextRef ctx, JSObjectRef function,
+                                      JSObjectRef thisObject, size_t argumentCount,
+                                      const JSValueRef arguments[], JSValueRef* exception);
+    static JSValueRef JSStatsHandler(JSContextRef ctx, JSObjectRef function,
+                                     JSObjectRef thisObject, size_t argumentCount,
+                                     const JSValueRef arguments[], JSValueRef* exception);
+
+    // Runs a slot's callback, logging a missing function or an exception.
+    static bool Invoke(const FunctionSlot& slot, const JSArgs& args, JSValue& result, bool timed);
+    // Counts a call made from JS and says whether to time it. JS thread only.
+    static bool SampleCall(FunctionSlot& slot);
+    // Queues an async slot's callback on the pool and returns its promise.
+    JSValueRef StartAsync(JSContextRef ctx, FunctionSlot& slot, JSArgs args, bool timed);
+    // Decodes as many well-formed commands as the batch holds; false if it
+    // stopped early.
+    bool DecodeBatch(const JSBytes& batch, std::vector<BatchedCall>& calls) const;
 
+    // Cycles and values nested too deep become null, as does everything past
+    // a total value budget.
     static JSValue ConvertFromJS(JSContextRef ctx, JSValueRef value);
+    static JSValue ConvertFromJS(JSContextRef ctx, JSValueRef value, ConversionState& state);
     static JSValueRef ConvertToJS(JSContextRef ctx, const JSValue& value);
     static std::string GetStringFromJS(JSContextRef ctx, JSValueRef value);
+    static std::string GetStringFromJS(JSStringRef string);
+    // Deep-copies borrowed buffers so the value can outlive the JS call.
+    static void TakeOwnership(JSValue& value);
+    static bool GetBytesFromJS(JSContextRef ctx, JSValueRef value, JSBytes& bytes);
+
+    template<typename T>
+    friend struct JSConverter;
+    template<typename T>
+    friend struct JSVariantConverter;
+
+    template<typename Arguments, size_t... I>
+    static std::string ArgumentError(size_t index, std::index_sequence<I...>);
+    template<typename Arguments, size_t... I>
+    static std::string Signature(const std::vector<std::string>& argNames, const std::string& returnType,
+                                 std::index_sequence<I...>);
+    template<typename Return, typename Arguments, typename F, size_t... I>
+    void RegisterTyped(const std::string& name, F function, const std::vector<std::string>& argNames, bool async,
+                       std::index_sequence<I...>);
 
 public:
     JSBridge();
     ~JSBridge();
 
+    JSBridge(const JSBridge&) = delete;
+    JSBridge& operator=(const JSBridge&) = delete;
+
     // Register a C++ function to be callable from JavaScript
     // Usage: bridge.Register("myFunction", [](const JSArgs& args) -> JSValue { ... });
     void Register(const std::string& name, JSCallback callback);
 
+    // Register a function that runs on a native thread pool instead of the
+    // JS thread. JS gets a Promise, resolved with the result or rejected with
+    // an Error carrying the exception message, once ResolveAsyncCalls runs.
+    // The callback must not touch anything owned by the JS thread.
+    void RegisterAsync(const std::string& name, JSCallback callback);
+
+    // Register a function taking and returning plain C++ types (bool, numbers,
+    // std::string, JSBytes, JSTypedArray, JSArray, JSObject, JSValue,
+    // std::optional of those; void returns undefined). The signature is
+    // deduced, and calls on the JS thread convert each argument straight
+    // into its parameter without building JSArgs. A missing or mistyped
+    // argument, or a number out of an integer parameter's range, fails the
+    // call like an exception would. argNames only label the TypeScript
+    // declarations; "name: Type" also replaces the declared type, e.g. with
+    // a union of accepted strings. One that returns a value always runs on
+    // the JS thread, so JS gets the result it is declared to return; the
+    // callback must be safe there.
+    // Usage: bridge.Register("setSize", [](float width, float height) { ... }, { "width", "height" });
+    template<typename F, typename = std::enable_if_t<!std::is_invocable_v<F&, const JSArgs&>>>
+    void Register(const std::string& name, F function, const std::vector<std::string>& argNames = {});
+    template<typename F, typename = std::enable_if_t<!std::is_invocable_v<F&, const JSArgs&>>>
+    void RegisterAsync(const std::string& name, F function, const std::vector<std::string>& argNames = {});
+
+    // Keeps a function on the JS thread once a dispatcher is set, so it runs
+    // in step with the page and JS gets its result. The callback must be
+    // safe to call from that thread.
+    void SetRunOnJSThread(const std::string& name, bool enabled = true);
+
     // Unregister a function
     void Unregister(const std::string& name);
 
+    // Settles the promises of finished async calls. Call on the JS thread,
+    // once per update.
+    void ResolveAsyncCalls();
+    // Waits for every async call to finish and settles them all. Call on the
+    // JS thread before its contexts are destroyed.
+    void FinishAsyncCalls();
+
+    // Queues an event for every listening page. Safe from any thread. Events
+    // with the same name and key replace each other until the next
+    // DispatchEvents, keeping the first one's place and the last payload, so
+    // state that changes many times a frame is delivered once. Give each
+    // instance its own key to keep them apart.
+    void EmitEvent(const std::string& name, JSValue payload, const std::string& key = {});
+    // Delivers queued events to each listener in one call. Call on the JS
+    // thread, once per update.
+    void DispatchEvents();
+    // Drops the listener held for a page that is going away. Only compares
+    // the pointer, so the context may already be gone.
+    void ReleaseContext(JSGlobalContextRef context);
+
+    // Called from any thread whenever async results or events are waiting,
+    // so the JS thread can be woken to deliver them.
+    void SetWakeCallback(std::function<void()> callback) { m_WakeCallback = std::move(callback); }
+
+    // Route calls through a dispatcher instead of running them on the JS
+    // thread. Calls are handed over in the order JS made them and JS receives
+    // undefined, since the result is not available yet; typed functions that
+    // return a value are never dispatched. Functions must all be registered
+    // before the page loads once a dispatcher is set.
+    void SetDispatcher(JSDispatcher dispatcher) { m_Dispatcher = std::move(dispatcher); }
+
     // Bind all registered functions to a JavaScript context under window.native.*
+    // The bridge must outlive every context it is bound to.
+    //
+    // Alongside them, window.native.__batch(bytes) runs many calls in one
+    // transition and returns their results as an array (undefined for calls
+    // handed to a dispatcher; async functions always return their promise).
+    // Calls run, or async ones start, in batch order. With a dispatcher set,
+    // the dispatched calls run afterwards as one task, in batch order among
+    // themselves, so they follow every JS-thread call in the batch, even
+    // ones that came later in it. Functions are
+    // addressed by the ids in window.native.__functions. The batch is a
+    // little-endian buffer:
+    //   u32 commandCount
+    //   per command: u16 functionId, u8 argCount, then per argument a u8 tag
+    //     0 null, 1 false, 2 true, 3 i32, 4 f64, 5 string (u32 length + UTF-8)
+    //
+    // window.native.__listen(fn) sets the context's event listener (null
+    // removes it). DispatchEvents calls it with an array of
+    // { type, key, detail } objects.
+    //
+    // window.native.__stats(reset) returns GetStats(), then resets the
+    // counters if reset is true.
+    //
+    // window.native.__shared maps each shared block's name to
+    // { buffer, fields: { name: { offset, type } } }, the buffer backed by
+    // the block's own memory.
     void BindToContext(JSContextRef ctx);
 
+    // Per-function call counts and latency percentiles for argument
+    // conversion, the callback and result conversion, timed in JSCallHandler
+    // and wherever the callback runs. Off by default. While on, every call
+    // is counted but only one in PROFILE_SAMPLE_INTERVAL per function is
+    // timed, so the rest cost a flag check and a counter store.
+    void SetProfiling(bool enabled) { m_Profiling.store(enabled, std::memory_order_relaxed); }
+    bool IsProfiling() const { return m_Profiling.load(std::memory_order_relaxed); }
+    static constexpr uint64_t PROFILE_SAMPLE_INTERVAL = 16;
+    // { name: { calls, arguments, callback, result } }, each phase a
+    // { count, mean, p50, p90, p99, max } summary in nanoseconds over the
+    // timed calls. Also available to pages as window.native.__stats(reset).
+    JSValue GetStats() const;
+    void ResetStats();
+    // Table of the functions called so far, most total callback time first.
+    void PrintStats(std::ostream& out) const;
+
+    // Adds a block of native memory that pages can write without calls; see
+    // SharedBlock. Create blocks before pages load, like functions. Returns
+    // the existing block if the name is taken.
+    std::shared_ptr<SharedBlock> CreateSharedBlock(const std::string& name, std::vector<SharedBlock::Field> fields);
+
+    // Writes a TypeScript interface, NativeFunctions, declaring every
+    // registered function, and SharedBlocks, with the fields of each shared
+    // block. Functions registered with a JSCallback take and return any.
+    bool WriteTypeScript(const std::string& path) const;
+
     // Get the singleton instance
     static JSBridge* Instance() { return s_Instance; }
 
@@ -90,3 +477,412 @@ inline std::optional<std::string> JSBridge::GetArg<std::string>(const JSArgs& ar
     return std::nullopt;
 }
 
+template<>
+inline std::optional<JSBytes> JSBridge::GetArg<JSBytes>(const JSArgs& args, size_t index)
+{
+    if (index >= args.size()) return std::nullopt;
+    if (auto* val = std::get_if<JSBytes>(&args[index])) return *val;
+    return std::nullopt;
+}
+
+// The container overloads copy; use std::get_if on args[index] to read a
+// large value in place.
+template<>
+inline std::optional<JSArray> JSBridge::GetArg<JSArray>(const JSArgs& args, size_t index)
+{
+    if (index >= args.size()) return std::nullopt;
+    if (auto* val = std::get_if<JSArray>(&args[index])) return *val;
+    return std::nullopt;
+}
+
+template<>
+inline std::optional<JSObject> JSBridge::GetArg<JSObject>(const JSArgs& args, size_t index)
+{
+    if (index >= args.size()) return std::nullopt;
+    if (auto* val = std::get_if<JSObject>(&args[index])) return *val;
+    return std::nullopt;
+}
+
+
+// Typed registration
+
+template<typename F>
+struct JSFunctionTraits : JSFunctionTraits<decltype(&F::operator())> {};
+
+template<typename R, typename... Args>
+struct JSFunctionTraits<R(*)(Args...)>
+{
+    using Return = std::decay_t<R>;
+    using Arguments = std::tuple<std::decay_t<Args>...>;
+};
+
+template<typename C, typename R, typename... Args>
+struct JSFunctionTraits<R(C::*)(Args...) const> : JSFunctionTraits<R(*)(Args...)> {};
+
+template<typename C, typename R, typename... Args>
+struct JSFunctionTraits<R(C::*)(Args...)> : JSFunctionTraits<R(*)(Args...)> {};
+
+// Each JSConverter has FromJS (straight from a JSValueRef) and FromValue (from
+// JSArgs, used for batched, dispatched and async calls), both returning
+// false on a type mismatch, plus ToJS, ToValue and its TypeScript name.
+template<typename T>
+struct JSNumberConverter
+{
+    // Integers truncate toward zero; NaN and values outside T's range fail
+    static bool FromNumber(double number, T& out)
+    {
+        if constexpr (std::is_integral_v<T>)
+        {
+            if (!(number > static_cast<double>(std::numeric_limits<T>::min()) - 1.0 &&
+                  number < static_cast<double>(std::numeric_limits<T>::max()) + 1.0))
+                return false;
+        }
+        out = static_cast<T>(number);
+        return true;
+    }
+    static bool FromJS(JSContextRef ctx, JSValueRef value, T& out)
+    {
+        if (!JSValueIsNumber(ctx, value)) return false;
+        return FromNumber(JSValueToNumber(ctx, value, nullptr), out);
+    }
+    static bool FromValue(const JSValue& value, T& out)
+    {
+        auto* d = std::get_if<double>(&value);
+        if (!d) return false;
+        return FromNumber(*d, out);
+    }
+    static JSValueRef ToJS(JSContextRef ctx, T value) { return JSValueMakeNumber(ctx, static_cast<double>(value)); }
+    static JSValue ToValue(T value) { return static_cast<double>(value); }
+    static std::string TypeScript() { return "number"; }
+};
+
+template<> struct JSConverter<double> : JSNumberConverter<double> {};
+template<> struct JSConverter<float> : JSNumberConverter<float> {};
+template<> struct JSConverter<int> : JSNumberConverter<int> {};
+template<> struct JSConverter<unsigned int> : JSNumberConverter<unsigned int> {};
+
+template<>
+struct JSConverter<bool>
+{
+    static bool FromJS(JSContextRef ctx, JSValueRef value, bool& out)
+    {
+        if (!JSValueIsBoolean(ctx, value)) return false;
+        out = JSValueToBoolean(ctx, value);
+        return true;
+    }
+    static bool FromValue(const JSValue& value, bool& out)
+    {
+        auto* b = std::get_if<bool>(&value);
+        if (!b) return false;
+        out = *b;
+        return true;
+    }
+    static JSValueRef ToJS(JSContextRef ctx, bool value) { return JSValueMakeBoolean(ctx, value); }
+    static JSValue ToValue(bool value) { return value; }
+    static std::string TypeScript() { return "boolean"; }
+};
+
+template<>
+struct JSConverter<std::string>
+{
+    static bool FromJS(JSContextRef ctx, JSValueRef value, std::string& out)
+    {
+        if (!JSValueIsString(ctx, value)) return false;
+        out = JSBridge::GetStringFromJS(ctx, value);
+        return true;
+    }
+    static bool FromValue(const JSValue& value, std::string& out)
+    {
+        auto* s = std::get_if<std::string>(&value);
+        if (!s) return false;
+        out = *s;
+        return true;
+    }
+    static JSValueRef ToJS(JSContextRef ctx, const std::string& value)
+    {
+        JSStringRef jsStr = JSStringCreateWithUTF8CString(value.c_str());
+        JSValueRef result = JSValueMakeString(ctx, jsStr);
+        JSStringRelease(jsStr);
+        return result;
+    }
+    static JSValue ToValue(std::string value) { return value; }
+    static std::string TypeScript() { return "string"; }
+};
+
+// Containers and buffers share the JSValue conversions
+template<typename T>
+struct JSVariantConverter
+{
+    static bool FromJS(JSContextRef ctx, JSValueRef value, T& out)
+    {
+        JSValue converted = JSBridge::ConvertFromJS(ctx, value);
+        auto* v = std::get_if<T>(&converted);
+        if (!v) return false;
+        out = std::move(*v);
+        return true;
+    }
+    static bool FromValue(const JSValue& value, T& out)
+    {
+        auto* v = std::get_if<T>(&value);
+        if (!v) return false;
+        out = *v;
+        return true;
+    }
+    static JSValueRef ToJS(JSContextRef ctx, T value) { return JSBridge::ConvertToJS(ctx, std::move(value)); }
+    static JSValue ToValue(T value) { return value; }
+};
+
+template<>
+struct JSConverter<JSBytes> : JSVariantConverter<JSBytes>
+{
+    // Borrowed, as with JSArgs
+    static bool FromJS(JSContextRef ctx, JSValueRef value, JSBytes& out) { return JSBridge::GetBytesFromJS(ctx, value, out); }
+    static std::string TypeScript() { return "ArrayBuffer | ArrayBufferView"; }
+};
+
+template<JSTypedArrayType Type>
+struct JSConverter<JSTypedArray<Type>>
+{
+    static bool FromJS(JSContextRef ctx, JSValueRef value, JSTypedArray<Type>& out)
+    {
+        return JSBridge::GetBytesFromJS(ctx, value, out) && out.type == Type;
+    }
+    static bool FromValue(const JSValue& value, JSTypedArray<Type>& out)
+    {
+        auto* bytes = std::get_if<JSBytes>(&value);
+        if (!bytes || bytes->type != Type) return false;
+        out = JSTypedArray<Type>(*bytes);
+        return true;
+    }
+    static JSValueRef ToJS(JSContextRef ctx, JSTypedArray<Type> value)
+    {
+        return JSBridge::ConvertToJS(ctx, JSBytes(std::move(value)));
+    }
+    static JSValue ToValue(JSTypedArray<Type> value) { return JSBytes(std::move(value)); }
+    static std::string TypeScript()
+    {
+        switch (Type)
+        {
+        case kJSTypedArrayTypeInt8Array: return "Int8Array";
+        case kJSTypedArrayTypeInt16Array: return "Int16Array";
+        case kJSTypedArrayTypeInt32Array: return "Int32Array";
+        case kJSTypedArrayTypeUint8Array: return "Uint8Array";
+        case kJSTypedArrayTypeUint8ClampedArray: return "Uint8ClampedArray";
+        case kJSTypedArrayTypeUint16Array: return "Uint16Array";
+        case kJSTypedArrayTypeUint32Array: return "Uint32Array";
+        case kJSTypedArrayTypeFloat32Array: return "Float32Array";
+        case kJSTypedArrayTypeFloat64Array: return "Float64Array";
+        default: return "ArrayBuffer";
+        }
+    }
+};
+
+template<>
+struct JSConverter<JSArray> : JSVariantConverter<JSArray>
+{
+    static std::string TypeScript() { return "unknown[]"; }
+};
+
+template<>
+struct JSConverter<JSObject> : JSVariantConverter<JSObject>
+{
+    static std::string TypeScript() { return "Record<string, unknown>"; }
+};
+
+template<>
+struct JSConverter<JSValue>
+{
+    static bool FromJS(JSContextRef ctx, JSValueRef value, JSValue& out)
+    {
+        out = JSBridge::ConvertFromJS(ctx, value);
+        return true;
+    }
+    static bool FromValue(const JSValue& value, JSValue& out)
+    {
+        out = value;
+        return true;
+    }
+    static JSValueRef ToJS(JSContextRef ctx, const JSValue& value) { return JSBridge::ConvertToJS(ctx, value); }
+    static JSValue ToValue(JSValue value) { return value; }
+    static std::string TypeScript() { return "unknown"; }
+};
+
+// null and undefined, including a missing argument, become std::nullopt
+template<typename T>
+struct JSConverter<std::optional<T>>
+{
+    static bool FromJS(JSContextRef ctx, JSValueRef value, std::optional<T>& out)
+    {
+        if (JSValueIsNull(ctx, value) || JSValueIsUndefined(ctx, value))
+        {
+            out.reset();
+            return true;
+        }
+        out.emplace();
+        return JSConverter<T>::FromJS(ctx, value, *out);
+    }
+    static bool FromValue(const JSValue& value, std::optional<T>& out)
+    {
+        if (std::holds_alternative<std::nullptr_t>(value))
+        {
+            out.reset();
+            return true;
+        }
+        out.emplace();
+        return JSConverter<T>::FromValue(value, *out);
+    }
+    static JSValueRef ToJS(JSContextRef ctx, std::optional<T> value)
+    {
+        return value ? JSConverter<T>::ToJS(ctx, std::move(*value)) : JSValueMakeNull(ctx);
+    }
+    static JSValue ToValue(std::optional<T> value)
+    {
+        return value ? JSConverter<T>::ToValue(std::move(*value)) : JSValue(nullptr);
+    }
+    static std::string TypeScript() { return JSConverter<T>::TypeScript() + " | null"; }
+};
+
+template<typename T>
+struct JSIsOptional : std::false_type {};
+template<typename T>
+struct JSIsOptional<std::optional<T>> : std::true_type {};
+
+template<typename Arguments, size_t... I>
+std::string JSBridge::ArgumentError(size_t index, std::index_sequence<I...>)
+{
+    const std::array<std::string, sizeof...(I)> types = { JSConverter<std::tuple_element_t<I, Arguments>>::TypeScript()... };
+    return "argument " + std::to_string(index) + " must be " + types[index];
+}
+
+template<typename Arguments, size_t... I>
+std::string JSBridge::Signature(const std::vector<std::string>& argNames, const std::string& returnType,
+                                std::index_sequence<I...>)
+{
+    const std::array<std::string, sizeof...(I)> types = { JSConverter<std::tuple_element_t<I, Arguments>>::TypeScript()... };
+    const std::array<bool, sizeof...(I)> optional = { JSIsOptional<std::tuple_element_t<I, Arguments>>::value... };
+
+    // Only trailing optional parameters can be left out
+    size_t required = types.size();
+    while (required > 0 && optional[required - 1])
+        required--;
+
+    std::string signature = "(";
+    for (size_t i = 0; i < types.size(); i++)
+    {
+        std::string label = i < argNames.size() ? argNames[i] : "arg" + std::to_string(i);
+        std::string type = types[i];
+        size_t colon = label.find(':');
+        if (colon != std::string::npos)
+        {
+            size_t begin = label.find_first_not_of(' ', colon + 1);
+            type = begin != std::string::npos ? label.substr(begin) : type;
+            label.erase(label.find_last_not_of(' ', colon - 1) + 1);
+        }
+
+        if (i > 0)
+            signature += ", ";
+        signature += label;
+        signature += i >= required ? "?: " : ": ";
+        signature += type;
+    }
+    return signature + "): " + returnType;
+}
+
+template<typename Return, typename Arguments, typename F, size_t... I>
+void JSBridge::RegisterTyped(const std::string& name, F function, const std::vector<std::string>& argNames,
+                             bool async, std::index_sequence<I...> indices)
+{
+    constexpr size_t count = sizeof...(I);
+    auto shared = std::make_shared<F>(std::move(function));
+
+    // Used by batched, dispatched and async calls, which already hold JSArgs
+    JSCallback callback = [shared, indices](const JSArgs& args) -> JSValue
+    {
+        Arguments values;
+        size_t failed = count;
+        static const JSValue missing = nullptr;
+        ((failed == count &&
+          !JSConverter<std::tuple_element_t<I, Arguments>>::FromValue(I < args.size() ? args[I] : missing, std::get<I>(values)) &&
+          (failed = I)), ...);
+        if (failed < count)
+            throw std::invalid_argument(ArgumentError<Arguments>(failed, indices));
+
+        if constexpr (std::is_void_v<Return>)
+        {
+            std::apply(*shared, std::move(values));
+            return nullptr;
+        }
+        else
+        {
+            return JSConverter<Return>::ToValue(std::apply(*shared, std::move(values)));
+        }
+    };
+
+    JSDirectCallback direct = [shared, indices](JSContextRef ctx, size_t argumentCount,
+                                                const JSValueRef arguments[], JSCallMarks* marks) -> JSValueRef
+    {
+        Arguments values;
+        size_t failed = count;
+        ((failed == count &&
+          !JSConverter<std::tuple_element_t<I, Arguments>>::FromJS(
+              ctx, I < argumentCount ? arguments[I] : JSValueMakeUndefined(ctx), std::get<I>(values)) &&
+          (failed = I)), ...);
+        if (failed < count)
+            throw std::invalid_argument(ArgumentError<Arguments>(failed, indices));
+
+        if (marks)
+            marks->converted = CycleClock::Now();
+        if constexpr (std::is_void_v<Return>)
+        {
+            std::apply(*shared, std::move(values));
+            if (marks)
+                marks->called = CycleClock::Now();
+            return JSValueMakeUndefined(ctx);
+        }
+        else
+        {
+            Return result = std::apply(*shared, std::move(values));
+            if (marks)
+                marks->called = CycleClock::Now();
+            return JSConverter<Return>::ToJS(ctx, std::move(result));
+        }
+    };
+
+    std::string returnType;
+    if constexpr (std::is_void_v<Return>)
+        returnType = "void";
+    else
+        returnType = JSConverter<Return>::TypeScript();
+
+    if (async)
+        RegisterAsync(name, std::move(callback));
+    else
+        Register(name, std::move(callback));
+
+    FunctionSlot* slot = m_Functions[name];
+    if (!async)
+        slot->direct = std::move(direct);
+    // A dispatched call can only return undefined, which the declared type
+    // would not admit
+    if constexpr (!std::is_void_v<Return>)
+        slot->onJSThread = !async;
+    slot->signature = Signature<Arguments>(argNames, async ? "Promise<" + returnType + ">" : returnType, indices);
+}
+
+template<typename F, typename>
+void JSBridge::Register(const std::string& name, F function, const std::vector<std::string>& argNames)
+{
+    using Traits = JSFunctionTraits<F>;
+    RegisterTyped<typename Traits::Return, typename Traits::Arguments>(
+        name, std::move(function), argNames, false,
+        std::make_index_sequence<std::tuple_size_v<typename Traits::Arguments>>());
+}
+
+template<typename F, typename>
+void JSBridge::RegisterAsync(const std::string& name, F function, const std::vector<std::string>& argNames)
+{
+    using Traits = JSFunctionTraits<F>;
+    RegisterTyped<typename Traits::Return, typename Traits::Arguments>(
+        name, std::move(function), argNames, true,
+        std::make_index_sequence<std::tuple_size_v<typename Traits::Arguments>>());
+}
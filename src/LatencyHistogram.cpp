@@ -0,0 +1,99 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace CycleClock
+{
+    // Reference point for calibration, taken during static initialization
+    static const auto s_StartTime = std::chrono::steady_clock::now();
+#ifdef LATENCYHISTOGRAM_TSC
+    static const uint64_t s_StartTicks = __rdtsc();
+#else
+    uint64_t Now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+#endif
+
+    double NanosecondsPerTick()
+    {
+#ifdef LATENCYHISTOGRAM_TSC
+        static const double nanosecondsPerTick = []()
+        {
+            // Long enough for the ratio to be accurate to well under 1%
+            const auto minimum = std::chrono::milliseconds(10);
+            auto elapsed = std::chrono::steady_clock::now() - s_StartTime;
+            if (elapsed < minimum)
+                std::this_thread::sleep_for(minimum - elapsed);
+
+            uint64_t ticks = __rdtsc() - s_StartTicks;
+            double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - s_StartTime).count();
+            return ticks > 0 ? nanoseconds / static_cast<double>(ticks) : 1.0;
+        }();
+        return nanosecondsPerTick;
+#else
+        return 1.0;
+#endif
+    }
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    Reset();
+}
+
+double LatencyHistogram::BucketValue(size_t index)
+{
+    if (index < SUB_BUCKETS)
+        return static_cast<double>(index);
+
+    int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+    uint64_t lowest = (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    return static_cast<double>(lowest) + static_cast<double>((1ull << shift) - 1) / 2.0;
+}
+
+LatencyHistogram::Summary LatencyHistogram::Summarize(double unitsPerTick) const
+{
+    std::array<uint64_t, BUCKET_COUNT> counts;
+    uint64_t total = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++)
+    {
+        counts[i] = m_Buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    Summary summary;
+    summary.count = total;
+    if (total == 0)
+        return summary;
+
+    summary.mean = static_cast<double>(m_Sum.load(std::memory_order_relaxed)) / static_cast<double>(total) * unitsPerTick;
+    summary.max = static_cast<double>(m_Max.load(std::memory_order_relaxed)) * unitsPerTick;
+
+    // Smallest bucket holding at least the given share of values
+    const double fractions[] = { 0.50, 0.90, 0.99 };
+    double* outputs[] = { &summary.p50, &summary.p90, &summary.p99 };
+    uint64_t seen = 0;
+    size_t next = 0;
+    for (size_t i = 0; i < BUCKET_COUNT && next < 3; i++)
+    {
+        seen += counts[i];
+        while (next < 3 && static_cast<double>(seen) >= fractions[next] * static_cast<double>(total))
+        {
+            // A bucket's midpoint can overshoot the largest value recorded
+            *outputs[next] = std::min(BucketValue(i) * unitsPerTick, summary.max);
+            next++;
+        }
+    }
+    return summary;
+}
+
+void LatencyHistogram::Reset()
+{
+    for (std::atomic<uint64_t>& bucket : m_Buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    m_Sum.store(0, std::memory_order_relaxed);
+    m_Max.store(0, std::memory_order_relaxed);
+}
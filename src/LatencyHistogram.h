@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define LATENCYHISTOGRAM_TSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+// Cheapest monotonic timestamp available: the TSC on x86, where reading it
+// costs a few nanoseconds instead of a clock call, steady_clock nanoseconds
+// elsewhere. Convert with NanosecondsPerTick.
+namespace CycleClock
+{
+#ifdef LATENCYHISTOGRAM_TSC
+    inline uint64_t Now() { return __rdtsc(); }
+#else
+    uint64_t Now();
+#endif
+
+    // Measured against steady_clock since startup; waits up to 10 ms on the
+    // first call if the process has only just started.
+    double NanosecondsPerTick();
+}
+
+// Log-linear histogram of durations in the spirit of HdrHistogram: values
+// below 16 have their own bucket and every power of two above is split into
+// 16 linear buckets, so a reported value is within 1/16 of what was
+// recorded. Recording is a few relaxed atomic operations, safe from any
+// thread; readers see a slightly torn but never corrupt picture.
+class LatencyHistogram
+{
+public:
+    struct Summary
+    {
+        uint64_t count = 0;
+        double mean = 0.0;
+        double p50 = 0.0;
+        double p90 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+private:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS;
+    // Values up to 2^48 ticks, a day or so of TSC; anything longer is clamped
+    static constexpr int MAX_BITS = 48;
+    static constexpr size_t BUCKET_COUNT = (MAX_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_Buckets;
+    // The count is the sum of the buckets, so it costs nothing to record
+    std::atomic<uint64_t> m_Sum;
+    std::atomic<uint64_t> m_Max;
+
+    static size_t BucketIndex(uint64_t value);
+    // Midpoint of the values a bucket covers
+    static double BucketValue(size_t index);
+
+public:
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void Record(uint64_t ticks)
+    {
+        m_Buckets[BucketIndex(ticks)].fetch_add(1, std::memory_order_relaxed);
+        m_Sum.fetch_add(ticks, std::memory_order_relaxed);
+
+        uint64_t max = m_Max.load(std::memory_order_relaxed);
+        while (ticks > max && !m_Max.compare_exchange_weak(max, ticks, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // Values are scaled by unitsPerTick, e.g. CycleClock::NanosecondsPerTick().
+    Summary Summarize(double unitsPerTick) const;
+    void Reset();
+};
+
+inline size_t LatencyHistogram::BucketIndex(uint64_t value)
+{
+    if (value < SUB_BUCKETS)
+        return static_cast<size_t>(value);
+    if (value >= (1ull << MAX_BITS))
+        return BUCKET_COUNT - 1;
+
+    int bits = 63;
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long highest;
+    _BitScanReverse64(&highest, value);
+    bits = static_cast<int>(highest);
+#else
+    bits -= __builtin_clzll(value);
+#endif
+
+    int shift = bits - SUB_BUCKET_BITS;
+    return static_cast<size_t>(shift + 1) * SUB_BUCKETS + ((value >> shift) & (SUB_BUCKETS - 1));
+}
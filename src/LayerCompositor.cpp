@@ -0,0 +1,78 @@
+#include "LayerCompositor.h"
+#include "UltralightRenderer.h"
+#include "Primitives.h"
+
+LayerCompositor::LayerCompositor()
+    : m_TextureLocation(-1)
+    , m_UVRectLocation(-1)
+{
+    Mesh quad = Primitives::CreateQuadFlippedUV();
+
+    m_VAO = std::make_unique<VertexArray>();
+    m_VBO = std::make_unique<VertexBuffer>(quad.vertices.data(), quad.vertices.size() * sizeof(Vertex));
+    m_IBO = std::make_unique<IndexBuffer>(quad.indices.data(), static_cast<uint32_t>(quad.indices.size()));
+    m_VAO->Bind();
+    m_VAO->AddVertexBuffer(*m_VBO);
+    m_VAO->SetIndexBuffer(*m_IBO);
+    m_VAO->Unbind();
+
+    m_Shader = std::make_unique<Shader>("assets/TextureShader.vert", "assets/TextureShader.frag");
+    m_TextureLocation = glGetUniformLocation(m_Shader->GetID(), "u_Texture");
+    m_UVRectLocation = glGetUniformLocation(m_Shader->GetID(), "u_UVRect");
+}
+
+uint32_t LayerCompositor::Composite(UltralightRenderer& renderer, int framebufferHeight)
+{
+    if (renderer.GetLayers().empty())
+        return 0;
+
+    renderer.UploadLayers();
+
+    GLint viewport[4];
+    GLint blendSrc, blendDst;
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetIntegerv(GL_BLEND_SRC_RGB, &blendSrc);
+    glGetIntegerv(GL_BLEND_DST_RGB, &blendDst);
+    GLboolean blendEnabled = glIsEnabled(GL_BLEND);
+
+    m_Shader->Bind();
+    if (m_TextureLocation != -1)
+        glUniform1i(m_TextureLocation, 0);
+    m_VAO->Bind();
+
+    uint32_t drawn = 0;
+    for (const UltralightLayer& layer : renderer.GetLayers())
+    {
+        UVRect uv;
+        if (!layer.visible || !renderer.BindLayer(layer, 0, &uv))
+            continue;
+        if (m_UVRectLocation != -1)
+            glUniform4f(m_UVRectLocation, uv.left, uv.top, uv.right, uv.bottom);
+
+        // Ultralight produces premultiplied alpha
+        if (layer.transparent)
+        {
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        }
+        else
+        {
+            glDisable(GL_BLEND);
+        }
+
+        glViewport(layer.x, framebufferHeight - layer.y - static_cast<int>(layer.height),
+                   static_cast<GLsizei>(layer.width), static_cast<GLsizei>(layer.height));
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+        drawn++;
+    }
+
+    m_VAO->Unbind();
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glBlendFunc(blendSrc, blendDst);
+    if (blendEnabled)
+        glEnable(GL_BLEND);
+    else
+        glDisable(GL_BLEND);
+
+    return drawn;
+}
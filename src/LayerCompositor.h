@@ -0,0 +1,34 @@
+#pragma once
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include <cstdint>
+#include <memory>
+
+class UltralightRenderer;
+
+// Draws an UltralightRenderer's layers over the current framebuffer in one
+// pass, bottom layer first, with a single program and quad.
+class LayerCompositor
+{
+private:
+    std::unique_ptr<Shader> m_Shader;
+    std::unique_ptr<VertexArray> m_VAO;
+    std::unique_ptr<VertexBuffer> m_VBO;
+    std::unique_ptr<IndexBuffer> m_IBO;
+    int m_TextureLocation;
+    int m_UVRectLocation;
+
+public:
+    LayerCompositor();
+    ~LayerCompositor() = default;
+
+    LayerCompositor(const LayerCompositor&) = delete;
+    LayerCompositor& operator=(const LayerCompositor&) = delete;
+
+    // Uploads dirty layers, then composites every visible one. Returns the
+    // number of layers drawn.
+    uint32_t Composite(UltralightRenderer& renderer, int framebufferHeight);
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Capacity is rounded up to a power of two; one slot is kept free to
+// tell a full queue from an empty one.
+template<typename T>
+class SPSCQueue
+{
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::vector<T> m_Slots;
+    size_t m_Mask;
+
+    alignas(CACHE_LINE) std::atomic<size_t> m_Head;
+    alignas(CACHE_LINE) std::atomic<size_t> m_Tail;
+
+    static size_t RoundUpPow2(size_t value)
+    {
+        size_t result = 2;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+
+public:
+    explicit SPSCQueue(size_t capacity = 1024)
+        : m_Slots(RoundUpPow2(capacity + 1))
+        , m_Mask(m_Slots.size() - 1)
+        , m_Head(0)
+        , m_Tail(0)
+    {
+    }
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    // Producer only. Returns false if the queue is full.
+    bool TryPush(T&& value)
+    {
+        const size_t tail = m_Tail.load(std::memory_order_relaxed);
+        const size_t next = (tail + 1) & m_Mask;
+        if (next == m_Head.load(std::memory_order_acquire))
+            return false;
+
+        m_Slots[tail] = std::move(value);
+        m_Tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns false if the queue is empty.
+    bool TryPop(T& out)
+    {
+        const size_t head = m_Head.load(std::memory_order_relaxed);
+        if (head == m_Tail.load(std::memory_order_acquire))
+            return false;
+
+        out = std::move(m_Slots[head]);
+        m_Slots[head] = T();
+        m_Head.store((head + 1) & m_Mask, std::memory_order_release);
+        return true;
+    }
+
+    bool IsEmpty() const
+    {
+        return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire);
+    }
+};
@@ -0,0 +1,80 @@
+#include "SharedBlock.h"
+
+// A write is a handful of stores; if it is still in progress after this
+// many tries the page is mid-update, so keep the old snapshot this frame.
+static constexpr int MAX_READ_ATTEMPTS = 64;
+
+SharedBlock::SharedBlock(std::string name, std::vector<Field> fields)
+    : m_Name(std::move(name))
+    , m_Fields(std::move(fields))
+    , m_LastSequence(0)
+{
+    size_t offset = SEQUENCE_OFFSET + sizeof(uint32_t);
+    for (Field& field : m_Fields)
+    {
+        size_t size = FieldSize(field.type);
+        offset = (offset + size - 1) / size * size;
+        field.offset = offset;
+        offset += size;
+    }
+
+    m_Size = offset;
+    m_Storage.assign((m_Size + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+    m_Snapshot.assign(m_Size, 0);
+    m_Scratch.assign(m_Size, 0);
+}
+
+bool SharedBlock::Poll()
+{
+    // The common case, nothing written since the last poll, costs one load
+    std::atomic<uint32_t>& sequence = Sequence();
+    if (sequence.load(std::memory_order_acquire) == m_LastSequence)
+        return false;
+
+    const uint8_t* data = GetData();
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++)
+    {
+        uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before == m_LastSequence)
+            return false;
+        if (before & 1)
+            continue;
+
+        std::memcpy(m_Scratch.data(), data, m_Size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) != before)
+            continue;
+
+        m_Snapshot.swap(m_Scratch);
+        m_LastSequence = before;
+        return true;
+    }
+    return false;
+}
+
+int SharedBlock::FindField(const std::string& name) const
+{
+    for (size_t i = 0; i < m_Fields.size(); i++)
+    {
+        if (m_Fields[i].name == name)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+size_t SharedBlock::FieldSize(FieldType type)
+{
+    return type == FieldType::Float64 ? 8 : 4;
+}
+
+const char* SharedBlock::FieldTypeName(FieldType type)
+{
+    switch (type)
+    {
+    case FieldType::Float32: return "f32";
+    case FieldType::Float64: return "f64";
+    case FieldType::Int32: return "i32";
+    case FieldType::Uint32: return "u32";
+    }
+    return "f32";
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Named block of native memory that pages write directly through an
+// ArrayBuffer, for state JS changes far more often than native needs to
+// hear about it. The block starts with a u32 sequence counter followed by
+// the schema's fields, each aligned to its size, little-endian.
+//
+// JS is the only writer and brackets every update with a sequence bump
+// (odd while writing, even when done, via Atomics so the bumps are ordered
+// around the field stores). Native reads with Poll, a seqlock read that
+// retries while a write is in progress, so it never sees half an update
+// even when the page runs on another thread.
+class SharedBlock
+{
+public:
+    enum class FieldType
+    {
+        Float32,
+        Float64,
+        Int32,
+        Uint32
+    };
+
+    struct Field
+    {
+        std::string name;
+        FieldType type;
+        size_t offset = 0;
+    };
+
+    static constexpr size_t SEQUENCE_OFFSET = 0;
+
+private:
+    std::string m_Name;
+    std::vector<Field> m_Fields;
+    // uint64_t storage keeps every field naturally aligned
+    std::vector<uint64_t> m_Storage;
+    size_t m_Size;
+    std::vector<uint8_t> m_Snapshot;
+    // Poll copies into this and swaps it with m_Snapshot once the copy holds
+    std::vector<uint8_t> m_Scratch;
+    uint32_t m_LastSequence;
+
+    std::atomic<uint32_t>& Sequence()
+    {
+        return *reinterpret_cast<std::atomic<uint32_t>*>(reinterpret_cast<uint8_t*>(m_Storage.data()) + SEQUENCE_OFFSET);
+    }
+
+public:
+    // Offsets are assigned in order; fields are zero until JS writes them.
+    SharedBlock(std::string name, std::vector<Field> fields);
+
+    SharedBlock(const SharedBlock&) = delete;
+    SharedBlock& operator=(const SharedBlock&) = delete;
+
+    // Copies the fields out if JS has finished a write since the last call.
+    // Returns false when nothing changed, or when a write kept being in
+    // progress; the previous snapshot stays valid either way.
+    bool Poll();
+
+    // Index of a field for Get, or -1
+    int FindField(const std::string& name) const;
+
+    // Field value from the last snapshot Poll took
+    template<typename T>
+    T Get(int index) const
+    {
+        if (index < 0 || static_cast<size_t>(index) >= m_Fields.size())
+            return T();
+
+        const Field& field = m_Fields[index];
+        switch (field.type)
+        {
+        case FieldType::Float32: return static_cast<T>(Load<float>(field.offset));
+        case FieldType::Float64: return static_cast<T>(Load<double>(field.offset));
+        case FieldType::Int32: return static_cast<T>(Load<int32_t>(field.offset));
+        case FieldType::Uint32: return static_cast<T>(Load<uint32_t>(field.offset));
+        }
+        return T();
+    }
+
+    const std::string& GetName() const { return m_Name; }
+    const std::vector<Field>& GetFields() const { return m_Fields; }
+    uint8_t* GetData() { return reinterpret_cast<uint8_t*>(m_Storage.data()); }
+    size_t GetSize() const { return m_Size; }
+
+    static size_t FieldSize(FieldType type);
+    // Names used in the JS schema and the TypeScript declarations
+    static const char* FieldTypeName(FieldType type);
+
+private:
+    template<typename T>
+    T Load(size_t offset) const
+    {
+        T value;
+        std::memcpy(&value, m_Snapshot.data() + offset, sizeof(T));
+        return value;
+    }
+};
@@ -1,8 +1,22 @@
 #include "Texture.h"
+#include <cstring>
+#include <iostream>
+
+static uint32_t GetBytesPerPixel(uint32_t dataFormat)
+{
+    switch (dataFormat)
+    {
+        case GL_RED:  return 1;
+        case GL_RG:   return 2;
+        case GL_RGB:
+        case GL_BGR:  return 3;
+        default:      return 4;
+    }
+}
 
 Texture::Texture()
     : m_RendererID(0), m_Width(0), m_Height(0),
-      m_InternalFormat(GL_RGBA8), m_DataFormat(GL_BGRA)
+      m_InternalFormat(GL_RGBA8), m_DataFormat(GL_BGRA), m_StreamIndex(0)
 {
     glGenTextures(1, &m_RendererID);
 }
@@ -10,7 +24,7 @@ Texture::Texture()
 Texture::Texture(uint32_t width, uint32_t height, const void* data,
                  uint32_t internalFormat, uint32_t dataFormat)
     : m_Width(width), m_Height(height),
-      m_InternalFormat(internalFormat), m_DataFormat(dataFormat)
+      m_InternalFormat(internalFormat), m_DataFormat(dataFormat), m_StreamIndex(0)
 {
     glGenTextures(1, &m_RendererID);
     glBindTexture(GL_TEXTURE_2D, m_RendererID);
@@ -28,6 +42,7 @@ Texture::Texture(uint32_t width, uint32_t height, const void* data,
 
 Texture::~Texture()
 {
+    ReleaseStreamBuffers();
     glDeleteTextures(1, &m_RendererID);
 }
 
@@ -37,7 +52,10 @@ Texture::Texture(Texture&& other) noexcept
     , m_Height(other.m_Height)
     , m_InternalFormat(other.m_InternalFormat)
     , m_DataFormat(other.m_DataFormat)
+    , m_StreamBuffers(std::move(other.m_StreamBuffers))
+    , m_StreamIndex(other.m_StreamIndex)
 {
+    other.m_StreamBuffers.clear();
     other.m_RendererID = 0;
     other.m_Width = 0;
     other.m_Height = 0;
@@ -47,12 +65,16 @@ Texture& Texture::operator=(Texture&& other) noexcept
 {
     if (this != &other)
     {
+        ReleaseStreamBuffers();
         glDeleteTextures(1, &m_RendererID);
         m_RendererID = other.m_RendererID;
         m_Width = other.m_Width;
         m_Height = other.m_Height;
         m_InternalFormat = other.m_InternalFormat;
         m_DataFormat = other.m_DataFormat;
+        m_StreamBuffers = std::move(other.m_StreamBuffers);
+        m_StreamIndex = other.m_StreamIndex;
+        other.m_StreamBuffers.clear();
         other.m_RendererID = 0;
         other.m_Width = 0;
         other.m_Height = 0;
@@ -78,9 +100,65 @@ void Texture::UpdateData(const void* data, uint32_t width, uint32_t height)
         Resize(width, height);
     }
 
+    UpdateSubData(data, 0, 0, width, height, width * GetBytesPerPixel(m_DataFormat));
+}
+
+void Texture::UpdateSubData(const void* data, uint32_t x, uint32_t y,
+                            uint32_t width, uint32_t height, uint32_t rowBytes)
+{
+    if (x >= m_Width || y >= m_Height)
+        return;
+
+    if (x + width > m_Width)
+        width = m_Width - x;
+    if (y + height > m_Height)
+        height = m_Height - y;
+
+    if (width == 0 || height == 0)
+        return;
+
+    if (IsStreaming())
+        StreamSubData(data, x, y, width, height, rowBytes);
+    else
+        UploadRegion(data, x, y, width, height, rowBytes);
+}
+
+void Texture::UpdateSubDataFromBuffer(uint32_t pixelBuffer, uint32_t x, uint32_t y,
+                                      uint32_t width, uint32_t height, uint32_t rowBytes,
+                                      size_t offset)
+{
+    if (x >= m_Width || y >= m_Height)
+        return;
+
+    if (x + width > m_Width)
+        width = m_Width - x;
+    if (y + height > m_Height)
+        height = m_Height - y;
+
+    if (width == 0 || height == 0)
+        return;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+    UploadRegion(reinterpret_cast<const void*>(offset), x, y, width, height, rowBytes);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void Texture::UploadRegion(const void* data, uint32_t x, uint32_t y,
+                           uint32_t width, uint32_t height, uint32_t rowBytes)
+{
     glBindTexture(GL_TEXTURE_2D, m_RendererID);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height,
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, rowBytes / GetBytesPerPixel(m_DataFormat));
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, x);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, y);
+
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height,
                     m_DataFormat, GL_UNSIGNED_BYTE, data);
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
@@ -94,3 +172,101 @@ void Texture::Resize(uint32_t width, uint32_t height)
                  m_DataFormat, GL_UNSIGNED_BYTE, nullptr);
     glBindTexture(GL_TEXTURE_2D, 0);
 }
+
+void Texture::EnableStreaming(uint32_t bufferCount)
+{
+    if (!GLAD_GL_VERSION_3_2)
+    {
+        std::cerr << "Texture: streaming uploads need OpenGL 3.2 fences, using direct uploads" << std::endl;
+        return;
+    }
+
+    ReleaseStreamBuffers();
+    m_StreamBuffers.resize(bufferCount > 0 ? bufferCount : 1);
+    for (StreamBuffer& buffer : m_StreamBuffers)
+        glGenBuffers(1, &buffer.id);
+    m_StreamIndex = 0;
+}
+
+void Texture::DisableStreaming()
+{
+    ReleaseStreamBuffers();
+}
+
+void Texture::ReleaseStreamBuffers()
+{
+    for (StreamBuffer& buffer : m_StreamBuffers)
+    {
+        if (buffer.fence)
+            glDeleteSync(buffer.fence);
+        if (buffer.id)
+            glDeleteBuffers(1, &buffer.id);
+    }
+    m_StreamBuffers.clear();
+    m_StreamIndex = 0;
+}
+
+void Texture::StreamSubData(const void* data, uint32_t x, uint32_t y,
+                            uint32_t width, uint32_t height, uint32_t rowBytes)
+{
+    StreamBuffer& buffer = m_StreamBuffers[m_StreamIndex];
+    m_StreamIndex = (m_StreamIndex + 1) % static_cast<uint32_t>(m_StreamBuffers.size());
+
+    const uint32_t bpp = GetBytesPerPixel(m_DataFormat);
+    const size_t packedRowBytes = static_cast<size_t>(width) * bpp;
+    const size_t size = packedRowBytes * height;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+
+    // If the GPU has not finished the transfer that last used this buffer,
+    // orphan it instead of waiting so the driver hands us fresh storage.
+    bool reusable = size <= buffer.capacity;
+    if (buffer.fence)
+    {
+        GLenum status = glClientWaitSync(buffer.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            reusable = false;
+        glDeleteSync(buffer.fence);
+        buffer.fence = nullptr;
+    }
+
+    if (!reusable)
+    {
+        if (size > buffer.capacity)
+            buffer.capacity = size;
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, buffer.capacity, nullptr, GL_STREAM_DRAW);
+    }
+
+    void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (!mapped)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return;
+    }
+
+    const uint8_t* src = static_cast<const uint8_t*>(data) + static_cast<size_t>(y) * rowBytes + static_cast<size_t>(x) * bpp;
+    uint8_t* dst = static_cast<uint8_t*>(mapped);
+    if (rowBytes == packedRowBytes)
+    {
+        std::memcpy(dst, src, size);
+    }
+    else
+    {
+        for (uint32_t row = 0; row < height; row++)
+            std::memcpy(dst + row * packedRowBytes, src + static_cast<size_t>(row) * rowBytes, packedRowBytes);
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    // The copy into the texture is queued on the GPU timeline after any draw
+    // still sampling it, so the CPU never waits on the previous frame.
+    glBindTexture(GL_TEXTURE_2D, m_RendererID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height,
+                    m_DataFormat, GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
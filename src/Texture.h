@@ -3,6 +3,7 @@
 #include <glad/glad.h>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 class Texture
 {
@@ -12,6 +13,21 @@ private:
     uint32_t m_Height;
     uint32_t m_InternalFormat;
     uint32_t m_DataFormat;
+
+    struct StreamBuffer
+    {
+        uint32_t id = 0;
+        size_t capacity = 0;
+        GLsync fence = nullptr;
+    };
+    std::vector<StreamBuffer> m_StreamBuffers;
+    uint32_t m_StreamIndex;
+
+    void UploadRegion(const void* data, uint32_t x, uint32_t y,
+                      uint32_t width, uint32_t height, uint32_t rowBytes);
+    void ReleaseStreamBuffers();
+    void StreamSubData(const void* data, uint32_t x, uint32_t y,
+                       uint32_t width, uint32_t height, uint32_t rowBytes);
 public:
     Texture();
     Texture(uint32_t width, uint32_t height, const void* data = nullptr, 
@@ -28,8 +44,23 @@ public:
     void Unbind() const;
 
     void UpdateData(const void* data, uint32_t width, uint32_t height);
+    // Uploads only the (x, y, width, height) region of a larger image.
+    // data points at the image origin and rowBytes is its stride.
+    void UpdateSubData(const void* data, uint32_t x, uint32_t y,
+                       uint32_t width, uint32_t height, uint32_t rowBytes);
+    // Same as UpdateSubData, but the pixels are read from a GL pixel-unpack
+    // buffer with the image origin at byte offset.
+    void UpdateSubDataFromBuffer(uint32_t pixelBuffer, uint32_t x, uint32_t y,
+                                 uint32_t width, uint32_t height, uint32_t rowBytes,
+                                 size_t offset = 0);
     void Resize(uint32_t width, uint32_t height);
 
+    // Streaming mode stages uploads through a ring of pixel-unpack buffers so
+    // the caller only pays for a memcpy; the GPU copies into the texture later.
+    void EnableStreaming(uint32_t bufferCount = 3);
+    void DisableStreaming();
+    bool IsStreaming() const { return !m_StreamBuffers.empty(); }
+
     uint32_t GetID() const { return m_RendererID; }
     uint32_t GetWidth() const { return m_Width; }
     uint32_t GetHeight() const { return m_Height; }
@@ -0,0 +1,85 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+ThreadPool::ThreadPool(size_t threadCount, size_t maxQueued)
+    : m_MaxQueued(maxQueued)
+    , m_Running(0)
+    , m_Stopping(false)
+{
+    threadCount = std::max<size_t>(threadCount, 1);
+    m_Workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++)
+        m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_TaskAvailable.notify_all();
+
+    for (std::thread& worker : m_Workers)
+        worker.join();
+}
+
+bool ThreadPool::Submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_Stopping || (m_MaxQueued > 0 && m_Tasks.size() >= m_MaxQueued))
+            return false;
+        m_Tasks.push_back(std::move(task));
+    }
+    m_TaskAvailable.notify_one();
+    return true;
+}
+
+void ThreadPool::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Idle.wait(lock, [this]() { return m_Tasks.empty() && m_Running == 0; });
+}
+
+size_t ThreadPool::GetQueuedCount()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Tasks.size();
+}
+
+void ThreadPool::WorkerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_TaskAvailable.wait(lock, [this]() { return m_Stopping || !m_Tasks.empty(); });
+            if (m_Tasks.empty())
+                return;
+
+            task = std::move(m_Tasks.front());
+            m_Tasks.pop_front();
+            m_Running++;
+        }
+
+        try
+        {
+            task();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "[ThreadPool] Task threw: " << e.what() << std::endl;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Running--;
+            if (m_Tasks.empty() && m_Running == 0)
+                m_Idle.notify_all();
+        }
+    }
+}
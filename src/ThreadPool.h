@@ -0,0 +1,42 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads draining a shared FIFO of tasks.
+class ThreadPool
+{
+private:
+    std::vector<std::thread> m_Workers;
+    std::deque<std::function<void()>> m_Tasks;
+    std::mutex m_Mutex;
+    std::condition_variable m_TaskAvailable;
+    std::condition_variable m_Idle;
+    size_t m_MaxQueued;
+    size_t m_Running;
+    bool m_Stopping;
+
+    void WorkerLoop();
+
+public:
+    // maxQueued bounds the backlog; 0 leaves it unbounded.
+    explicit ThreadPool(size_t threadCount, size_t maxQueued = 0);
+    // Finishes queued tasks, then joins the workers.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Returns false without queuing when the backlog is full.
+    bool Submit(std::function<void()> task);
+    // Blocks until the queue is empty and no task is running.
+    void WaitIdle();
+
+    size_t GetQueuedCount();
+    size_t GetThreadCount() const { return m_Workers.size(); }
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free triple buffer for handing whole frames from one writer thread to
+// one reader thread. The writer always has a private slot to fill, the reader
+// always has a stable slot to read, and the third slot holds the most
+// recently published frame. Frames the reader never picked up are dropped.
+template<typename T>
+class TripleBuffer
+{
+private:
+    // Low two bits: index of the shared back slot. FRESH_BIT: the back slot
+    // holds a frame the reader has not acquired yet.
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH_BIT = 0x4;
+
+    std::array<T, 3> m_Slots;
+    std::atomic<uint8_t> m_BackState;
+    uint8_t m_WriteIndex;
+    uint8_t m_ReadIndex;
+
+public:
+    TripleBuffer()
+        : m_BackState(1)
+        , m_WriteIndex(0)
+        , m_ReadIndex(2)
+    {
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer side
+    T& GetWriteBuffer() { return m_Slots[m_WriteIndex]; }
+    uint32_t GetWriteIndex() const { return m_WriteIndex; }
+
+    void Publish()
+    {
+        uint8_t previous = m_BackState.exchange(static_cast<uint8_t>(m_WriteIndex | FRESH_BIT),
+                                                std::memory_order_acq_rel);
+        m_WriteIndex = previous & INDEX_MASK;
+    }
+
+    // True while a published frame is waiting for the reader. From the writer
+    // this may be stale in one direction only: it can report a frame the
+    // reader is just about to take, never miss one.
+    bool HasFreshFrame() const
+    {
+        return (m_BackState.load(std::memory_order_acquire) & FRESH_BIT) != 0;
+    }
+
+    // Reader side. Swaps in the newest frame if there is one.
+    bool Acquire()
+    {
+        if (!HasFreshFrame())
+            return false;
+
+        uint8_t previous = m_BackState.exchange(m_ReadIndex, std::memory_order_acq_rel);
+        m_ReadIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T& GetReadBuffer() const { return m_Slots[m_ReadIndex]; }
+};
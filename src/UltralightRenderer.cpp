@@ -1,10 +1,26 @@
 #include "UltralightRenderer.h"
 #include "JSBridge.h"
+#include "GLSurface.h"
+#include "GPUDriverGL.h"
+#include "BundleFileSystem.h"
+#include "FontCache.h"
+#include "Texture.h"
+#include "SPSCQueue.h"
+#include "TripleBuffer.h"
 #include <JavaScriptCore/JavaScript.h>
 #include <iostream>
 #include <filesystem>
 #include <algorithm>
 #include <string>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -12,10 +28,117 @@
 
 static UltralightRenderer* g_CurrentRenderer = nullptr;
 
+// A finished view bitmap handed from the worker thread to the GL thread.
+// dirty covers everything that changed since the last frame the GL thread
+// acquired, so skipped frames are still uploaded correctly.
+struct UltralightFrame
+{
+    std::vector<uint8_t> pixels;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t rowBytes = 0;
+    ultralight::IntRect dirty = ultralight::IntRect::MakeEmpty();
+    // Component slots as of this frame's layout
+    ComponentSlotSnapshot slots;
+};
+
+struct UltralightWorker
+{
+    std::thread thread;
+    std::atomic<bool> running{ false };
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    bool wakePending = false;
+
+    SPSCQueue<std::function<void()>> commands;
+    SPSCQueue<std::function<void()>> mainThreadCalls;
+
+    // Commands that found the queue full, e.g. while a long JS task runs.
+    // Once anything is here, later commands follow it until the worker
+    // drains both, so none are dropped or reordered. Mouse moves and
+    // scrolls merge with the command before them.
+    struct OverflowCommand
+    {
+        enum class Kind
+        {
+            Call,
+            MouseMove,
+            Scroll
+        };
+
+        Kind kind = Kind::Call;
+        std::function<void()> call;
+        // What a scroll's call fires, so merging can add to its deltas
+        std::shared_ptr<ultralight::ScrollEvent> scroll;
+    };
+    std::mutex overflowMutex;
+    std::deque<OverflowCommand> overflow;
+    // Set by the main thread, cleared by the worker, both under the mutex
+    std::atomic<bool> overflowing{ false };
+    TripleBuffer<UltralightFrame> frames;
+
+    // Worker-only bookkeeping: the region each frame slot is missing since it
+    // was last written, and the region changed since the reader last acquired.
+    std::array<ultralight::IntRect, 3> slotPending;
+    ultralight::IntRect unreadDirty = ultralight::IntRect::MakeEmpty();
+    uint64_t publishedSlots = 0;
+
+    UltralightWorker()
+    {
+        slotPending.fill(ultralight::IntRect::MakeEmpty());
+    }
+};
+
+static void JoinRect(ultralight::IntRect& target, const ultralight::IntRect& rect)
+{
+    if (target.IsEmpty())
+        target = rect;
+    else if (!rect.IsEmpty())
+        target.Join(rect);
+}
+
+static const char* const FONT_FAMILY_STANDARD = "Arial";
+static const char* const FONT_FAMILY_SERIF = "Times New Roman";
+static const char* const FONT_FAMILY_FIXED = "Courier New";
+
+static void UploadPixels(Texture& texture, const void* pixels, uint32_t width, uint32_t height,
+                         uint32_t rowBytes, const ultralight::IntRect& dirty)
+{
+    if (width != texture.GetWidth() || height != texture.GetHeight())
+    {
+        texture.Resize(width, height);
+        texture.UpdateSubData(pixels, 0, 0, width, height, rowBytes);
+        return;
+    }
+
+    // Only the region Ultralight repainted since the last upload
+    uint32_t x = static_cast<uint32_t>(std::max(dirty.left, 0));
+    uint32_t y = static_cast<uint32_t>(std::max(dirty.top, 0));
+    texture.UpdateSubData(pixels, x, y,
+                          static_cast<uint32_t>(std::max(dirty.right, 0)) - x,
+                          static_cast<uint32_t>(std::max(dirty.bottom, 0)) - y,
+                          rowBytes);
+}
+
 UltralightRenderer::UltralightRenderer()
     : m_Initialized(false)
     , m_Width(0)
     , m_Height(0)
+    , m_FontCache(std::make_unique<FontCache>())
+    , m_UseGLSurfaces(false)
+    , m_UseGPURendering(false)
+    , m_RenderTargetDirty(false)
+    , m_UseWorkerThread(false)
+    , m_WorkerTickRate(60.0)
+    , m_NextLayerID(1)
+    , m_FocusedLayer(0)
+    , m_MouseLayer(0)
+    , m_MouseCaptured(false)
+    , m_MouseX(0)
+    , m_MouseY(0)
+    , m_ViewPoolSize(2)
+    , m_PoolClock(0)
 {
 }
 
@@ -28,6 +151,31 @@ UltralightRenderer::UltralightRenderer(UltralightRenderer&& other) noexcept
     : m_Renderer(std::move(other.m_Renderer))
     , m_View(std::move(other.m_View))
     , m_Initialized(other.m_Initialized)
+    , m_SurfaceFactory(std::move(other.m_SurfaceFactory))
+    , m_GPUDriver(std::move(other.m_GPUDriver))
+    , m_BundleFileSystem(std::move(other.m_BundleFileSystem))
+    , m_BundlePath(std::move(other.m_BundlePath))
+    , m_FontCache(std::move(other.m_FontCache))
+    , m_UseGLSurfaces(other.m_UseGLSurfaces)
+    , m_UseGPURendering(other.m_UseGPURendering)
+    , m_RenderTargetDirty(other.m_RenderTargetDirty)
+    , m_UseWorkerThread(other.m_UseWorkerThread)
+    , m_WorkerTickRate(other.m_WorkerTickRate)
+    , m_FrameReadyCallback(std::move(other.m_FrameReadyCallback))
+    , m_Layers(std::move(other.m_Layers))
+    , m_NextLayerID(other.m_NextLayerID)
+    , m_FocusedLayer(other.m_FocusedLayer)
+    , m_MouseLayer(other.m_MouseLayer)
+    , m_MouseCaptured(other.m_MouseCaptured)
+    , m_MouseX(other.m_MouseX)
+    , m_MouseY(other.m_MouseY)
+    , m_Routes(std::move(other.m_Routes))
+    , m_ViewPool(std::move(other.m_ViewPool))
+    , m_BoundContexts(std::move(other.m_BoundContexts))
+    , m_CurrentRoute(std::move(other.m_CurrentRoute))
+    , m_PendingRoute(std::move(other.m_PendingRoute))
+    , m_ViewPoolSize(other.m_ViewPoolSize)
+    , m_PoolClock(other.m_PoolClock)
 {
     other.m_Initialized = false;
 }
@@ -40,11 +188,46 @@ UltralightRenderer& UltralightRenderer::operator=(UltralightRenderer&& other) no
         m_Renderer = std::move(other.m_Renderer);
         m_View = std::move(other.m_View);
         m_Initialized = other.m_Initialized;
+        m_SurfaceFactory = std::move(other.m_SurfaceFactory);
+        m_GPUDriver = std::move(other.m_GPUDriver);
+        m_BundleFileSystem = std::move(other.m_BundleFileSystem);
+        m_BundlePath = std::move(other.m_BundlePath);
+        m_FontCache = std::move(other.m_FontCache);
+        m_UseGLSurfaces = other.m_UseGLSurfaces;
+        m_UseGPURendering = other.m_UseGPURendering;
+        m_RenderTargetDirty = other.m_RenderTargetDirty;
+        m_UseWorkerThread = other.m_UseWorkerThread;
+        m_WorkerTickRate = other.m_WorkerTickRate;
+        m_FrameReadyCallback = std::move(other.m_FrameReadyCallback);
+        m_Layers = std::move(other.m_Layers);
+        m_NextLayerID = other.m_NextLayerID;
+        m_FocusedLayer = other.m_FocusedLayer;
+        m_MouseLayer = other.m_MouseLayer;
+        m_MouseCaptured = other.m_MouseCaptured;
+        m_MouseX = other.m_MouseX;
+        m_MouseY = other.m_MouseY;
+        m_Routes = std::move(other.m_Routes);
+        m_ViewPool = std::move(other.m_ViewPool);
+        m_BoundContexts = std::move(other.m_BoundContexts);
+        m_CurrentRoute = std::move(other.m_CurrentRoute);
+        m_PendingRoute = std::move(other.m_PendingRoute);
+        m_ViewPoolSize = other.m_ViewPoolSize;
+        m_PoolClock = other.m_PoolClock;
         other.m_Initialized = false;
     }
     return *this;
 }
 
+void UltralightRenderer::DeclareFont(const std::string& family, int weight, bool italic, const std::string& path)
+{
+    m_FontCache->Declare(family, weight, italic, path);
+}
+
+void UltralightRenderer::DeclareFallbackFont(uint32_t first, uint32_t last, const std::string& family)
+{
+    m_FontCache->DeclareFallback(first, last, family);
+}
+
 bool UltralightRenderer::Initialize(uint32_t width, uint32_t height)
 {
     if (m_Initialized)
@@ -53,6 +236,14 @@ bool UltralightRenderer::Initialize(uint32_t width, uint32_t height)
         return false;
     }
 
+    if (m_UseWorkerThread)
+        return StartWorker(width, height);
+
+    return CreateRenderer(width, height);
+}
+
+bool UltralightRenderer::CreateRenderer(uint32_t width, uint32_t height)
+{
     try
     {
         std::cout << "  Setting up Ultralight config..." << std::endl;
@@ -62,9 +253,6 @@ bool UltralightRenderer::Initialize(uint32_t width, uint32_t height)
         std::cout << "  Setting platform config..." << std::endl;
         ultralight::Platform::instance().set_config(config);
         
-        std::cout << "  Setting font loader..." << std::endl;
-        ultralight::Platform::instance().set_font_loader(ultralight::GetPlatformFontLoader());
-        
         std::cout << "  Setting file system..." << std::endl;
         std::filesystem::path currentDir = std::filesystem::current_path();
         std::cout << "    Current working directory: " << currentDir << std::endl;
@@ -85,8 +273,53 @@ bool UltralightRenderer::Initialize(uint32_t width, uint32_t height)
         std::replace(fileSystemBase.begin(), fileSystemBase.end(), '\\', '/');
         std::cout << "    File system base (normalized): " << fileSystemBase << std::endl;
 #endif
-        ultralight::Platform::instance().set_file_system(ultralight::GetPlatformFileSystem(fileSystemBase.c_str()));
+        ultralight::FileSystem* platformFileSystem = ultralight::GetPlatformFileSystem(fileSystemBase.c_str());
+        if (!m_BundlePath.empty())
+        {
+            m_BundleFileSystem = std::make_unique<BundleFileSystem>();
+            if (m_BundleFileSystem->Open(m_BundlePath))
+            {
+                std::cout << "    Serving files from bundle: " << m_BundlePath << std::endl;
+                m_BundleFileSystem->SetFallback(platformFileSystem);
+            }
+            else
+            {
+                std::cerr << "    WARNING: Could not open bundle " << m_BundlePath << ", using loose files" << std::endl;
+                m_BundleFileSystem.reset();
+            }
+        }
+
+        if (m_BundleFileSystem)
+            ultralight::Platform::instance().set_file_system(m_BundleFileSystem.get());
+        else
+            ultralight::Platform::instance().set_file_system(platformFileSystem);
+
+        std::cout << "  Setting font loader..." << std::endl;
+        for (const char* family : { FONT_FAMILY_STANDARD, FONT_FAMILY_SERIF, FONT_FAMILY_FIXED })
+        {
+            for (int weight : { 400, 700 })
+            {
+                m_FontCache->Declare(family, weight, false);
+                m_FontCache->Declare(family, weight, true);
+            }
+        }
+        m_FontCache->SetFallbackFont(FONT_FAMILY_STANDARD);
+        m_FontCache->Preload(ultralight::Platform::instance().file_system(), ultralight::GetPlatformFontLoader());
+        ultralight::Platform::instance().set_font_loader(m_FontCache.get());
         
+        if (m_UseGPURendering)
+        {
+            std::cout << "  Setting GPU driver..." << std::endl;
+            m_GPUDriver = std::make_unique<GPUDriverGL>();
+            ultralight::Platform::instance().set_gpu_driver(m_GPUDriver.get());
+        }
+        else if (m_UseGLSurfaces)
+        {
+            std::cout << "  Setting GL surface factory..." << std::endl;
+            m_SurfaceFactory = std::make_unique<GLSurfaceFactory>();
+            ultralight::Platform::instance().set_surface_factory(m_SurfaceFactory.get());
+        }
+
         std::cout << "  Setting logger..." << std::endl;
         ultralight::Platform::instance().set_logger(ultralight::GetDefaultLogger("ultralight.log"));
         std::cout << "    Logger will write to: ultralight.log (check this file for detailed errors)" << std::endl;
@@ -185,14 +418,7 @@ bool UltralightRenderer::Initialize(uint32_t width, uint32_t height)
         std::cout << "    Renderer created successfully!" << std::endl;
 
         std::cout << "  Configuring view..." << std::endl;
-        ultralight::ViewConfig view_config;
-        view_config.is_accelerated = false;
-        view_config.initial_device_scale = 1.0;
-        view_config.is_transparent = false;
-        view_config.font_family_standard = "Arial";
-        view_config.font_family_serif = "Times New Roman";
-        view_config.font_family_sans_serif = "Arial";
-        view_config.font_family_fixed = "Courier New";
+        ultralight::ViewConfig view_config = MakeViewConfig(false);
 
         std::cout << "  Creating view..." << std::endl;
         m_View = m_Renderer->CreateView(width, height, view_config, nullptr);
@@ -229,51 +455,378 @@ bool UltralightRenderer::Initialize(uint32_t width, uint32_t height)
     }
 }
 
+ultralight::ViewConfig UltralightRenderer::MakeViewConfig(bool transparent) const
+{
+    ultralight::ViewConfig view_config;
+    view_config.is_accelerated = m_GPUDriver != nullptr;
+    view_config.initial_device_scale = 1.0;
+    view_config.is_transparent = transparent;
+    view_config.font_family_standard = FONT_FAMILY_STANDARD;
+    view_config.font_family_serif = FONT_FAMILY_SERIF;
+    view_config.font_family_sans_serif = FONT_FAMILY_STANDARD;
+    view_config.font_family_fixed = FONT_FAMILY_FIXED;
+    return view_config;
+}
+
+bool UltralightRenderer::StartWorker(uint32_t width, uint32_t height)
+{
+    if (m_UseGPURendering || m_UseGLSurfaces)
+    {
+        std::cout << "  GL surfaces and GPU rendering are not available on a worker thread, using bitmaps" << std::endl;
+        m_UseGPURendering = false;
+        m_UseGLSurfaces = false;
+    }
+
+    m_Worker = std::make_unique<UltralightWorker>();
+    m_Worker->running.store(true);
+
+    std::promise<bool> ready;
+    std::future<bool> result = ready.get_future();
+    m_Worker->thread = std::thread([this, width, height, ready = std::move(ready)]() mutable
+    {
+        RunWorker(width, height, ready);
+    });
+
+    if (!result.get())
+    {
+        m_Worker->running.store(false);
+        m_Worker->thread.join();
+        m_Worker.reset();
+        return false;
+    }
+
+    std::cout << "  Ultralight is running on a worker thread" << std::endl;
+    return true;
+}
+
+void UltralightRenderer::StopWorker()
+{
+    m_Worker->running.store(false);
+    WakeWorker();
+    m_Worker->thread.join();
+    m_Worker.reset();
+}
+
+void UltralightRenderer::RunWorker(uint32_t width, uint32_t height, std::promise<bool>& ready)
+{
+    // Everything Ultralight owns is created, used and destroyed on this thread.
+    bool created = CreateRenderer(width, height);
+    ready.set_value(created);
+    if (!created)
+        return;
+
+    UltralightWorker& worker = *m_Worker;
+    auto tick = std::chrono::duration<double>(1.0 / std::max(m_WorkerTickRate, 1.0));
+
+    while (worker.running.load())
+    {
+        std::function<void()> command;
+        while (worker.commands.TryPop(command))
+            command();
+
+        if (worker.overflowing.load(std::memory_order_acquire))
+        {
+            // Whatever reached the queue meanwhile was posted before the rest
+            // of the overflow, so it goes first
+            std::deque<UltralightWorker::OverflowCommand> overflow;
+            {
+                std::lock_guard<std::mutex> lock(worker.overflowMutex);
+                while (worker.commands.TryPop(command))
+                    overflow.push_back({ UltralightWorker::OverflowCommand::Kind::Call, std::move(command), nullptr });
+                for (UltralightWorker::OverflowCommand& entry : worker.overflow)
+                    overflow.push_back(std::move(entry));
+                worker.overflow.clear();
+                worker.overflowing.store(false, std::memory_order_release);
+            }
+            for (UltralightWorker::OverflowCommand& entry : overflow)
+                entry.call();
+        }
+
+        if (m_JSBridge)
+        {
+            m_JSBridge->ResolveAsyncCalls();
+            m_JSBridge->DispatchEvents();
+        }
+        m_Renderer->Update();
+        RenderVisibleViews();
+        PublishFrame();
+
+        std::unique_lock<std::mutex> lock(worker.wakeMutex);
+        worker.wakeCondition.wait_for(lock, tick, [&worker]()
+        {
+            return worker.wakePending;
+        });
+        worker.wakePending = false;
+    }
+
+    ReleaseJSContexts();
+    m_View = nullptr;
+    m_Renderer = nullptr;
+}
+
+void UltralightRenderer::PublishFrame()
+{
+    ultralight::Surface* surface = m_View->surface();
+    if (!surface)
+        return;
+
+    // A slot can move without repainting anything, and still needs a frame
+    // to reach the main thread
+    UltralightWorker& worker = *m_Worker;
+    ultralight::IntRect dirty = surface->dirty_bounds();
+    uint64_t slotVersion = m_ComponentSlots.GetVersion();
+    if (dirty.IsEmpty() && slotVersion == worker.publishedSlots)
+        return;
+
+    ultralight::RefPtr<ultralight::Bitmap> bitmap = static_cast<ultralight::BitmapSurface*>(surface)->bitmap();
+    if (!bitmap)
+        return;
+
+    for (ultralight::IntRect& pending : worker.slotPending)
+        JoinRect(pending, dirty);
+
+    uint32_t index = worker.frames.GetWriteIndex();
+    UltralightFrame& frame = worker.frames.GetWriteBuffer();
+    ultralight::IntRect copyRect = worker.slotPending[index];
+    worker.slotPending[index] = ultralight::IntRect::MakeEmpty();
+
+    const ultralight::IntRect full = { 0, 0, static_cast<int>(bitmap->width()), static_cast<int>(bitmap->height()) };
+    bool resized = frame.width != bitmap->width() || frame.height != bitmap->height() ||
+                   frame.rowBytes != bitmap->row_bytes();
+    if (resized)
+    {
+        frame.width = bitmap->width();
+        frame.height = bitmap->height();
+        frame.rowBytes = bitmap->row_bytes();
+        frame.pixels.resize(static_cast<size_t>(frame.rowBytes) * frame.height);
+        copyRect = full;
+    }
+
+    const uint8_t* src = static_cast<const uint8_t*>(bitmap->LockPixels());
+    if (!src)
+        return;
+
+    int left = std::max(copyRect.left, 0);
+    int right = std::min(copyRect.right, full.right);
+    int top = std::max(copyRect.top, 0);
+    int bottom = std::min(copyRect.bottom, full.bottom);
+    if (left < right)
+    {
+        size_t offset = static_cast<size_t>(left) * 4;
+        size_t length = static_cast<size_t>(right - left) * 4;
+        for (int row = top; row < bottom; row++)
+        {
+            size_t rowStart = static_cast<size_t>(row) * frame.rowBytes + offset;
+            std::memcpy(frame.pixels.data() + rowStart, src + rowStart, length);
+        }
+    }
+    bitmap->UnlockPixels();
+
+    // A frame the GL thread never acquired is replaced by this one, so its
+    // changes have to be carried over.
+    if (resized)
+        worker.unreadDirty = full;
+    else if (worker.frames.HasFreshFrame())
+        JoinRect(worker.unreadDirty, dirty);
+    else
+        worker.unreadDirty = dirty;
+
+    frame.dirty = worker.unreadDirty;
+    m_ComponentSlots.CopyTo(frame.slots);
+    worker.publishedSlots = frame.slots.version;
+    worker.frames.Publish();
+    surface->ClearDirtyBounds();
+
+    if (m_FrameReadyCallback)
+        m_FrameReadyCallback();
+}
+
+// Queues the command, or appends it to the overflow once the queue has
+// filled. A mouse move or scroll that follows one of its kind in the
+// overflow replaces or adds to it instead.
+static void PostCommand(UltralightWorker& worker, UltralightWorker::OverflowCommand command)
+{
+    using Kind = UltralightWorker::OverflowCommand::Kind;
+    // A failed push leaves the call intact
+    if (!worker.overflowing.load(std::memory_order_relaxed) && worker.commands.TryPush(std::move(command.call)))
+        return;
+
+    std::lock_guard<std::mutex> lock(worker.overflowMutex);
+    if (worker.overflow.empty() && worker.commands.TryPush(std::move(command.call)))
+        return;
+
+    UltralightWorker::OverflowCommand* last = worker.overflow.empty() ? nullptr : &worker.overflow.back();
+    if (last && last->kind == command.kind && command.kind == Kind::MouseMove)
+    {
+        *last = std::move(command);
+        return;
+    }
+    if (last && last->kind == command.kind && command.kind == Kind::Scroll && last->scroll->type == command.scroll->type)
+    {
+        last->scroll->delta_x += command.scroll->delta_x;
+        last->scroll->delta_y += command.scroll->delta_y;
+        return;
+    }
+
+    worker.overflow.push_back(std::move(command));
+    worker.overflowing.store(true, std::memory_order_release);
+}
+
+void UltralightRenderer::PostToWorker(std::function<void()> command)
+{
+    PostCommand(*m_Worker, { UltralightWorker::OverflowCommand::Kind::Call, std::move(command), nullptr });
+    WakeWorker();
+}
+
+void UltralightRenderer::PostMouseMoveToWorker(const ultralight::MouseEvent& evt)
+{
+    PostCommand(*m_Worker, { UltralightWorker::OverflowCommand::Kind::MouseMove,
+                             [this, evt]() { m_View->FireMouseEvent(evt); }, nullptr });
+    WakeWorker();
+}
+
+void UltralightRenderer::PostScrollToWorker(const ultralight::ScrollEvent& evt)
+{
+    auto scroll = std::make_shared<ultralight::ScrollEvent>(evt);
+    PostCommand(*m_Worker, { UltralightWorker::OverflowCommand::Kind::Scroll,
+                             [this, scroll]() { m_View->FireScrollEvent(*scroll); }, scroll });
+    WakeWorker();
+}
+
+void UltralightRenderer::WakeWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Worker->wakeMutex);
+        m_Worker->wakePending = true;
+    }
+    m_Worker->wakeCondition.notify_one();
+}
+
+void UltralightRenderer::PostToMainThread(std::function<void()> call)
+{
+    // Bridge calls must not be dropped or reordered, so wait for room.
+    while (!m_Worker->mainThreadCalls.TryPush(std::move(call)))
+    {
+        if (!m_Worker->running.load())
+            return;
+        std::this_thread::yield();
+    }
+
+    if (m_FrameReadyCallback)
+        m_FrameReadyCallback();
+}
+
 void UltralightRenderer::Shutdown()
 {
     if (!m_Initialized)
         return;
 
+    if (m_Worker)
+        StopWorker();
+    else
+        ReleaseJSContexts();
+
+    m_Layers.clear();
+    m_ViewPool.clear();
     m_View = nullptr;
     m_Renderer = nullptr;
+    m_GPUDriver.reset();
+    if (m_FontCache)
+        m_FontCache->Clear();
+    m_BundleFileSystem.reset();
     m_Initialized = false;
 }
 
 void UltralightRenderer::Update()
 {
-    if (!m_Initialized || !m_Renderer)
+    if (!m_Initialized)
+        return;
+
+    // Requested by a page, which must be off the stack before its view can go
+    if (!m_PendingRoute.empty())
+    {
+        std::string route = std::move(m_PendingRoute);
+        m_PendingRoute.clear();
+        SwitchToRoute(route);
+    }
+
+    if (m_Worker)
+    {
+        std::function<void()> call;
+        while (m_Worker->mainThreadCalls.TryPop(call))
+            call();
+        return;
+    }
+
+    if (!m_Renderer)
         return;
 
+    if (m_JSBridge)
+    {
+        m_JSBridge->ResolveAsyncCalls();
+        m_JSBridge->DispatchEvents();
+    }
     m_Renderer->Update();
 }
 
 void UltralightRenderer::Render()
 {
-    if (!m_Initialized || !m_Renderer || !m_View)
+    if (!m_Initialized || m_Worker || !m_Renderer || !m_View)
         return;
 
-    m_Renderer->Render();
+    RenderVisibleViews();
+    m_ComponentSlots.CopyTo(m_SlotSnapshot);
+
+    if (m_GPUDriver && m_GPUDriver->DrawCommandList())
+        m_RenderTargetDirty = true;
 }
 
 void UltralightRenderer::LoadHTML(const std::string& html)
 {
-    if (!m_Initialized || !m_View)
+    if (!m_Initialized)
+        return;
+
+    if (m_Worker)
+    {
+        PostToWorker([this, html]() { m_View->LoadHTML(html.c_str()); });
+        return;
+    }
+
+    if (!m_View)
         return;
 
+    // Not a route, so a later switch must not pool it under the previous one
+    m_CurrentRoute.clear();
     m_View->LoadHTML(html.c_str());
 }
 
 void UltralightRenderer::LoadURL(const std::string& url)
 {
-    if (!m_Initialized || !m_View)
+    if (!m_Initialized)
+        return;
+
+    if (m_Worker)
+    {
+        PostToWorker([this, url]() { m_View->LoadURL(url.c_str()); });
+        return;
+    }
+
+    if (!m_View)
         return;
 
+    m_CurrentRoute.clear();
+    for (const auto& [route, routeURL] : m_Routes)
+    {
+        if (routeURL == url)
+            m_CurrentRoute = route;
+    }
+
     m_View->LoadURL(url.c_str());
 }
 
 ultralight::Bitmap* UltralightRenderer::GetBitmap() const
 {
-    if (!m_Initialized || !m_View)
+    if (!m_Initialized || !m_View || m_SurfaceFactory || m_Worker)
         return nullptr;
 
     ultralight::Surface* surface = m_View->surface();
@@ -289,93 +842,828 @@ ultralight::Bitmap* UltralightRenderer::GetBitmap() const
 
 bool UltralightRenderer::IsDirty() const
 {
-    if (!m_Initialized || !m_View)
+    if (!m_Initialized)
         return false;
 
+    if (m_Worker)
+        return m_Worker->frames.HasFreshFrame();
+
+    if (!m_View)
+        return false;
+
+    if (m_GPUDriver)
+        return m_RenderTargetDirty;
+
+    ultralight::Surface* surface = m_View->surface();
+    if (surface && !surface->dirty_bounds().IsEmpty())
+        return true;
+
+    for (const UltralightLayer& layer : m_Layers)
+    {
+        ultralight::Surface* layerSurface = layer.view->surface();
+        if (layer.visible && layerSurface && !layerSurface->dirty_bounds().IsEmpty())
+            return true;
+    }
+
+    return false;
+}
+
+ultralight::IntRect UltralightRenderer::GetDirtyBounds() const
+{
+    if (!m_Initialized || !m_View || m_Worker)
+        return ultralight::IntRect::MakeEmpty();
+
     ultralight::Surface* surface = m_View->surface();
     if (!surface)
-        return false;
+        return ultralight::IntRect::MakeEmpty();
 
-    return !surface->dirty_bounds().IsEmpty();
+    return surface->dirty_bounds();
 }
 
 void UltralightRenderer::ClearDirty()
 {
-    if (!m_Initialized || !m_View)
+    if (!m_Initialized || !m_View || m_Worker)
         return;
 
+    m_RenderTargetDirty = false;
+
     ultralight::Surface* surface = m_View->surface();
     if (!surface)
         return;
 
-    ultralight::BitmapSurface* bitmap_surface = static_cast<ultralight::BitmapSurface*>(surface);
-    if (bitmap_surface)
-        bitmap_surface->ClearDirtyBounds();
+    surface->ClearDirtyBounds();
 }
 
-void UltralightRenderer::ForceRepaint()
+bool UltralightRenderer::UploadSurface(Texture& texture)
 {
-    if (!m_Initialized || !m_View)
-        return;
+    if (!m_Initialized)
+        return false;
 
-    m_View->set_needs_paint(true);
-}
+    if (m_Worker)
+    {
+        if (!m_Worker->frames.Acquire())
+            return false;
 
-void UltralightRenderer::SetupJSBridge()
-{
-    m_JSBridge = std::make_unique<JSBridge>();
-    
-    m_JSBridge->Register("setComponentSlot", [this](const JSArgs& args) -> JSValue {
-        auto name = JSBridge::GetArg<std::string>(args, 0);
-        auto x = JSBridge::GetArg<float>(args, 1);
-        auto y = JSBridge::GetArg<float>(args, 2);
-        auto width = JSBridge::GetArg<float>(args, 3);
-        auto height = JSBridge::GetArg<float>(args, 4);
-        auto visible = JSBridge::GetArg<bool>(args, 5);
-        
-        if (name && x && y && width && height && visible)
-            SetComponentSlot(*name, *x, *y, *width, *height, *visible);
-        
-        return nullptr;
-    });
-}
+        const UltralightFrame& frame = m_Worker->frames.GetReadBuffer();
+        if (frame.slots.version != m_SlotSnapshot.version)
+            m_SlotSnapshot = frame.slots;
+        if (frame.pixels.empty() || frame.dirty.IsEmpty())
+            return false;
 
-void UltralightRenderer::BindJavaScriptAPI()
-{
-    if (!m_Initialized || !m_View || !m_JSBridge)
-        return;
+        UploadPixels(texture, frame.pixels.data(), frame.width, frame.height, frame.rowBytes, frame.dirty);
+        return true;
+    }
 
-    auto scoped_context = m_View->LockJSContext();
-    JSContextRef ctx = (*scoped_context);
-    
-    m_JSBridge->BindToContext(ctx);
+    return UploadViewSurface(m_View.get(), texture);
 }
 
-void UltralightRenderer::SetComponentSlot(const std::string& name, float x, float y, 
-                                          float width, float height, bool visible)
+bool UltralightRenderer::UploadViewSurface(ultralight::View* view, Texture& texture)
 {
-    m_ComponentSlots[name] = { x, y, width, height, visible };
+    if (!view)
+        return false;
+
+    ultralight::Surface* surface = view->surface();
+    if (!surface)
+        return false;
+
+    if (m_SurfaceFactory)
+        return static_cast<GLSurface*>(surface)->UploadTo(texture);
+
+    ultralight::RefPtr<ultralight::Bitmap> bitmap = static_cast<ultralight::BitmapSurface*>(surface)->bitmap();
+    if (!bitmap)
+        return false;
+
+    bool sizeChanged = bitmap->width() != texture.GetWidth() || bitmap->height() != texture.GetHeight();
+    if (!sizeChanged && surface->dirty_bounds().IsEmpty())
+        return false;
+
+    void* pixels = bitmap->LockPixels();
+    if (!pixels)
+        return false;
+
+    UploadPixels(texture, pixels, bitmap->width(), bitmap->height(), bitmap->row_bytes(), surface->dirty_bounds());
+
+    bitmap->UnlockPixels();
+    surface->ClearDirtyBounds();
+    return true;
 }
 
-const ComponentSlot* UltralightRenderer::GetComponentSlot(const std::string& name) const
+bool UltralightRenderer::BindRenderTarget(uint32_t slot, UVRect* uv) const
 {
-    auto it = m_ComponentSlots.find(name);
-    if (it != m_ComponentSlots.end())
-        return &it->second;
-    return nullptr;
+    if (!m_Initialized)
+        return false;
+
+    return BindViewRenderTarget(m_View.get(), slot, uv);
 }
 
-void UltralightRenderer::Resize(uint32_t width, uint32_t height)
+bool UltralightRenderer::BindViewRenderTarget(ultralight::View* view, uint32_t slot, UVRect* uv) const
 {
-    if (!m_Initialized || !m_View)
-        return;
+    if (!view || !m_GPUDriver)
+        return false;
 
-    if (width == m_Width && height == m_Height)
+    ultralight::RenderTarget target = view->render_target();
+    if (target.is_empty)
+        return false;
+
+    if (uv)
+        *uv = { target.uv_coords.left, target.uv_coords.top, target.uv_coords.right, target.uv_coords.bottom };
+    return m_GPUDriver->BindTexture(target.texture_id, slot);
+}
+
+void UltralightRenderer::ForceRepaint()
+{
+    if (!m_Initialized)
+        return;
+
+    if (m_Worker)
+    {
+        PostToWorker([this]() { m_View->set_needs_paint(true); });
+        return;
+    }
+
+    if (m_View)
+        m_View->set_needs_paint(true);
+}
+
+void UltralightRenderer::FireMouseEvent(const ultralight::MouseEvent& evt)
+{
+    if (!m_Initialized)
+        return;
+
+    if (m_Worker)
+    {
+        if (evt.type == ultralight::MouseEvent::kType_MouseMoved)
+            PostMouseMoveToWorker(evt);
+        else
+            PostToWorker([this, evt]() { m_View->FireMouseEvent(evt); });
+        return;
+    }
+
+    if (!m_View)
+        return;
+
+    m_MouseX = evt.x;
+    m_MouseY = evt.y;
+
+    // A button press captures the mouse for the layer under it until release,
+    // so drags that leave the layer keep going to it.
+    UltralightLayer* layer = m_MouseCaptured ? FindLayer(m_MouseLayer) : HitTestLayer(evt.x, evt.y);
+    uint32_t layerID = layer ? layer->id : 0;
+    if (evt.type == ultralight::MouseEvent::kType_MouseDown)
+    {
+        m_MouseCaptured = true;
+        m_MouseLayer = layerID;
+        FocusLayer(layerID);
+    }
+    else if (evt.type == ultralight::MouseEvent::kType_MouseUp)
+    {
+        m_MouseCaptured = false;
+    }
+
+    if (!layer)
+    {
+        m_View->FireMouseEvent(evt);
+        return;
+    }
+
+    ultralight::MouseEvent local = evt;
+    local.x -= layer->x;
+    local.y -= layer->y;
+    layer->view->FireMouseEvent(local);
+}
+
+void UltralightRenderer::FireScrollEvent(const ultralight::ScrollEvent& evt)
+{
+    if (!m_Initialized)
+        return;
+
+    if (m_Worker)
+    {
+        PostScrollToWorker(evt);
+        return;
+    }
+
+    UltralightLayer* layer = HitTestLayer(m_MouseX, m_MouseY);
+    if (layer)
+        layer->view->FireScrollEvent(evt);
+    else if (m_View)
+        m_View->FireScrollEvent(evt);
+}
+
+void UltralightRenderer::FireKeyEvent(const ultralight::KeyEvent& evt)
+{
+    if (!m_Initialized)
+        return;
+
+    if (m_Worker)
+    {
+        PostToWorker([this, evt]() { m_View->FireKeyEvent(evt); });
+        return;
+    }
+
+    if (ultralight::View* view = GetLayerView(m_FocusedLayer))
+        view->FireKeyEvent(evt);
+}
+
+void UltralightRenderer::SetFocus(bool focused)
+{
+    if (!m_Initialized)
+        return;
+
+    if (m_Worker)
+    {
+        PostToWorker([this, focused]()
+        {
+            if (focused)
+                m_View->Focus();
+            else
+                m_View->Unfocus();
+        });
+        return;
+    }
+
+    ultralight::View* view = GetLayerView(m_FocusedLayer);
+    if (!view)
+        return;
+
+    if (focused)
+        view->Focus();
+    else
+        view->Unfocus();
+}
+
+void UltralightRenderer::SetupJSBridge()
+{
+    m_JSBridge = std::make_unique<JSBridge>();
+
+    // JS runs on the worker; hand bridge calls to the main thread in order.
+    if (m_Worker)
+    {
+        m_JSBridge->SetDispatcher([this](std::function<void()> call)
+        {
+            PostToMainThread(std::move(call));
+        });
+    }
+
+    // Async results and events are delivered on the JS thread, so wake
+    // whichever loop runs it. Called from any thread.
+    m_JSBridge->SetWakeCallback([this]()
+    {
+        if (m_Worker)
+            WakeWorker();
+        else if (m_FrameReadyCallback)
+            m_FrameReadyCallback();
+    });
+    
+    // Slots are written on the JS thread in every mode, so a worker frame
+    // carries the slots its page was laid out with when it was painted.
+    m_JSBridge->Register("acquireComponentSlot", [this](const std::string& name) {
+        return m_ComponentSlots.Acquire(name);
+    }, { "name" });
+
+    // Float32Array of (handle, x, y, width, height, visible) per changed slot
+    m_JSBridge->Register("updateComponentSlots", [this](const JSFloat32Array& slots) {
+        if (slots.Count<float>() % 6 != 0)
+            return false;
+
+        const float* values = slots.As<float>();
+        for (size_t i = 0; i < slots.Count<float>(); i += 6)
+        {
+            ComponentSlot slot{ values[i + 1], values[i + 2], values[i + 3], values[i + 4], values[i + 5] != 0.0f };
+            if (!(values[i] >= 1.0f) || !m_ComponentSlots.Set(static_cast<uint32_t>(values[i]), slot))
+                return false;
+        }
+        return true;
+    }, { "slots" });
+    m_JSBridge->SetRunOnJSThread("acquireComponentSlot");
+    m_JSBridge->SetRunOnJSThread("updateComponentSlots");
+
+    // Switching can release the calling page's view, so it waits for Update().
+    // This runs on the JS thread, the worker's in threaded mode, where the
+    // pool isn't available.
+    m_JSBridge->Register("switchRoute", [this](const std::string& route) {
+        if (m_Worker)
+        {
+            std::cerr << "[Ultralight] View pool is not supported with a worker thread" << std::endl;
+            return false;
+        }
+        if (!FindRouteURL(route))
+        {
+            std::cerr << "[Ultralight] Unknown route: " << route << std::endl;
+            return false;
+        }
+        m_PendingRoute = route;
+        return true;
+    }, { "route" });
+}
+
+void UltralightRenderer::BindJavaScriptAPI()
+{
+    BindJavaScriptAPI(m_View.get());
+}
+
+void UltralightRenderer::BindJavaScriptAPI(ultralight::View* view)
+{
+    if (!m_Initialized || !view || !m_JSBridge)
+        return;
+
+    auto scoped_context = view->LockJSContext();
+    JSContextRef ctx = (*scoped_context);
+
+    // A new page: whatever the view's previous page listened with is gone
+    ReleaseViewContext(view);
+    JSGlobalContextRef context = JSContextGetGlobalContext(ctx);
+    m_JSBridge->ReleaseContext(context);
+    m_BoundContexts[view] = context;
+
+    m_JSBridge->BindToContext(ctx);
+}
+
+void UltralightRenderer::ReleaseViewContext(ultralight::View* view)
+{
+    auto it = m_BoundContexts.find(view);
+    if (it == m_BoundContexts.end())
+        return;
+
+    if (m_JSBridge)
+        m_JSBridge->ReleaseContext(it->second);
+    m_BoundContexts.erase(it);
+}
+
+void UltralightRenderer::ReleaseJSContexts()
+{
+    if (m_JSBridge)
+    {
+        m_JSBridge->FinishAsyncCalls();
+        for (const auto& entry : m_BoundContexts)
+            m_JSBridge->ReleaseContext(entry.second);
+    }
+    m_BoundContexts.clear();
+}
+
+void UltralightRenderer::Resize(uint32_t width, uint32_t height)
+{
+    if (!m_Initialized)
+        return;
+
+    if (width == m_Width && height == m_Height)
         return;
 
     m_Width = width;
     m_Height = height;
-    m_View->Resize(width, height);
+
+    if (m_Worker)
+    {
+        PostToWorker([this, width, height]() { m_View->Resize(width, height); });
+        EmitResize(width, height);
+        return;
+    }
+
+    if (m_View)
+        m_View->Resize(width, height);
+
+    // Pooled views must match so a switch never needs a relayout
+    for (PooledView& pooled : m_ViewPool)
+        pooled.view->Resize(width, height);
+
+    EmitResize(width, height);
+}
+
+void UltralightRenderer::EmitResize(uint32_t width, uint32_t height)
+{
+    if (!m_JSBridge)
+        return;
+
+    JSObject size;
+    size.Set("width", static_cast<double>(width));
+    size.Set("height", static_cast<double>(height));
+    m_JSBridge->EmitEvent("resize", std::move(size));
+}
+
+void UltralightRenderer::DeclareRoute(const std::string& route, const std::string& url)
+{
+    for (auto& entry : m_Routes)
+    {
+        if (entry.first == route)
+        {
+            entry.second = url;
+            return;
+        }
+    }
+    m_Routes.emplace_back(route, url);
+}
+
+void UltralightRenderer::SetViewPoolSize(size_t size)
+{
+    m_ViewPoolSize = size;
+    TrimViewPool();
+}
+
+void UltralightRenderer::PrewarmRoutes()
+{
+    if (!m_Initialized || !m_Renderer || m_Worker)
+        return;
+
+    for (const auto& [route, url] : m_Routes)
+    {
+        if (m_ViewPool.size() >= m_ViewPoolSize)
+            break;
+
+        bool pooled = route == m_CurrentRoute;
+        for (const PooledView& entry : m_ViewPool)
+            pooled = pooled || entry.route == route;
+        if (pooled)
+            continue;
+
+        PooledView entry;
+        entry.route = route;
+        entry.view = CreatePooledView(url);
+        entry.lastUsed = ++m_PoolClock;
+        if (entry.view)
+            m_ViewPool.push_back(std::move(entry));
+    }
+}
+
+bool UltralightRenderer::SwitchToRoute(const std::string& route)
+{
+    if (!m_Initialized || !m_Renderer || !m_View)
+        return false;
+
+    if (m_Worker)
+    {
+        std::cerr << "[Ultralight] View pool is not supported with a worker thread" << std::endl;
+        return false;
+    }
+
+    if (route == m_CurrentRoute)
+        return true;
+
+    const std::string* url = FindRouteURL(route);
+    if (!url)
+    {
+        std::cerr << "[Ultralight] Unknown route: " << route << std::endl;
+        return false;
+    }
+
+    auto it = std::find_if(m_ViewPool.begin(), m_ViewPool.end(),
+                           [&route](const PooledView& entry) { return entry.route == route; });
+
+    ultralight::RefPtr<ultralight::View> next;
+    if (it != m_ViewPool.end())
+    {
+        next = it->view;
+        m_ViewPool.erase(it);
+    }
+    else
+    {
+        // Cold switch: the page loads as it would have before the pool
+        next = CreatePooledView(*url);
+        if (!next)
+            return false;
+    }
+
+    // The outgoing page stays loaded and bridged for the next switch back
+    SetViewHidden(m_View.get(), true);
+    if (m_FocusedLayer == 0)
+        m_View->Unfocus();
+
+    PooledView previous;
+    previous.route = m_CurrentRoute;
+    previous.view = m_View;
+    previous.lastUsed = ++m_PoolClock;
+    if (!previous.route.empty())
+        m_ViewPool.push_back(std::move(previous));
+    else
+        ReleaseViewContext(previous.view.get());
+
+    m_View = next;
+    m_CurrentRoute = route;
+    SetViewHidden(m_View.get(), false);
+    m_View->set_needs_paint(true);
+    if (m_FocusedLayer == 0)
+        m_View->Focus();
+
+    // The composited texture still holds the old page
+    if (ultralight::Surface* surface = m_View->surface())
+        surface->set_dirty_bounds({ 0, 0, static_cast<int>(surface->width()), static_cast<int>(surface->height()) });
+    m_RenderTargetDirty = true;
+
+    TrimViewPool();
+    return true;
+}
+
+const std::string* UltralightRenderer::FindRouteURL(const std::string& route) const
+{
+    for (const auto& entry : m_Routes)
+    {
+        if (entry.first == route)
+            return &entry.second;
+    }
+    return nullptr;
+}
+
+ultralight::RefPtr<ultralight::View> UltralightRenderer::CreatePooledView(const std::string& url)
+{
+    ultralight::RefPtr<ultralight::View> view = m_Renderer->CreateView(m_Width, m_Height, MakeViewConfig(false), nullptr);
+    if (!view)
+    {
+        std::cerr << "[Ultralight] Failed to create pooled view for " << url << std::endl;
+        return nullptr;
+    }
+
+    // DOM ready binds the JS bridge, so the page is fully usable when swapped in
+    view->set_load_listener(&m_LoadListener);
+    view->set_view_listener(&m_ViewListener);
+    view->LoadURL(url.c_str());
+    return view;
+}
+
+void UltralightRenderer::SetViewHidden(ultralight::View* view, bool hidden)
+{
+    // Painting is already skipped by RenderVisibleViews. Ultralight 1.3 can't
+    // suspend a view's timers or animations, so the gate installed before
+    // the page's scripts holds their callbacks; the event is informational.
+    std::string script = "if (window.__nativeSetHidden) window.__nativeSetHidden(";
+    script += hidden ? "true" : "false";
+    script += "); document.dispatchEvent(new CustomEvent('nativevisibilitychange', { detail: { hidden: ";
+    script += hidden ? "true" : "false";
+    script += " } }));";
+    view->EvaluateScript(script.c_str());
+}
+
+void UltralightRenderer::InstallVisibilityGate(ultralight::View* view)
+{
+    // While hidden, timer and animation frame callbacks are held (an interval
+    // at most once) and run on show; CSS and Web Animations are paused.
+    static const char* gate = R"JS((function() {
+  if (window.__nativeSetHidden) return;
+  var hidden = false, held = [], paused = [];
+  function hold(fn) {
+    if (typeof fn !== "function") return fn;
+    var waiting = false;
+    return function() {
+      if (!hidden) return fn.apply(this, arguments);
+      if (waiting) return;
+      waiting = true;
+      var self = this, args = arguments;
+      held.push(function() { waiting = false; fn.apply(self, args); });
+    };
+  }
+  var setTimeout = window.setTimeout, setInterval = window.setInterval;
+  var requestAnimationFrame = window.requestAnimationFrame;
+  window.setTimeout = function(fn) {
+    var args = Array.prototype.slice.call(arguments);
+    args[0] = hold(fn);
+    return setTimeout.apply(window, args);
+  };
+  window.setInterval = function(fn) {
+    var args = Array.prototype.slice.call(arguments);
+    args[0] = hold(fn);
+    return setInterval.apply(window, args);
+  };
+  if (requestAnimationFrame)
+    window.requestAnimationFrame = function(fn) { return requestAnimationFrame.call(window, hold(fn)); };
+  window.__nativeSetHidden = function(value) {
+    if (hidden === !!value) return;
+    hidden = !!value;
+    var animations = document.getAnimations ? document.getAnimations() : [];
+    if (hidden) {
+      paused = animations.filter(function(a) { return a.playState === "running"; });
+      paused.forEach(function(a) { a.pause(); });
+      return;
+    }
+    paused.forEach(function(a) { a.play(); });
+    paused = [];
+    var run = held;
+    held = [];
+    run.forEach(function(fn) { fn(); });
+  };
+})();)JS";
+    view->EvaluateScript(gate);
+
+    bool pooled = false;
+    for (const PooledView& entry : m_ViewPool)
+        pooled = pooled || entry.view.get() == view;
+    if (pooled)
+        view->EvaluateScript("window.__nativeSetHidden(true);");
+}
+
+void UltralightRenderer::RenderVisibleViews()
+{
+    std::vector<ultralight::View*> views;
+    views.reserve(m_Layers.size() + 1);
+    if (m_View)
+        views.push_back(m_View.get());
+    for (const UltralightLayer& layer : m_Layers)
+    {
+        if (layer.visible && layer.view)
+            views.push_back(layer.view.get());
+    }
+    m_Renderer->RenderOnly(views.data(), views.size());
+}
+
+void UltralightRenderer::TrimViewPool()
+{
+    while (m_ViewPool.size() > m_ViewPoolSize)
+    {
+        auto oldest = std::min_element(m_ViewPool.begin(), m_ViewPool.end(),
+                                       [](const PooledView& a, const PooledView& b) { return a.lastUsed < b.lastUsed; });
+        ReleaseViewContext(oldest->view.get());
+        m_ViewPool.erase(oldest);
+    }
+}
+
+uint32_t UltralightRenderer::CreateLayer(const std::string& name, int x, int y, uint32_t width, uint32_t height,
+                                         int zOrder, bool transparent)
+{
+    if (!m_Initialized || !m_Renderer)
+        return 0;
+
+    if (m_Worker)
+    {
+        std::cerr << "[Ultralight] Layers are not supported with a worker thread" << std::endl;
+        return 0;
+    }
+
+    UltralightLayer layer;
+    layer.id = m_NextLayerID++;
+    layer.name = name;
+    layer.x = x;
+    layer.y = y;
+    layer.width = std::max(width, 1u);
+    layer.height = std::max(height, 1u);
+    layer.zOrder = zOrder;
+    layer.transparent = transparent;
+    layer.view = m_Renderer->CreateView(layer.width, layer.height, MakeViewConfig(transparent), nullptr);
+    if (!layer.view)
+    {
+        std::cerr << "[Ultralight] Failed to create view for layer " << name << std::endl;
+        return 0;
+    }
+
+    layer.view->set_load_listener(&m_LoadListener);
+    layer.view->set_view_listener(&m_ViewListener);
+
+    uint32_t id = layer.id;
+    auto position = std::upper_bound(m_Layers.begin(), m_Layers.end(), zOrder,
+                                     [](int z, const UltralightLayer& other) { return z < other.zOrder; });
+    m_Layers.insert(position, std::move(layer));
+    return id;
+}
+
+void UltralightRenderer::DestroyLayer(uint32_t id)
+{
+    auto it = std::find_if(m_Layers.begin(), m_Layers.end(),
+                           [id](const UltralightLayer& layer) { return layer.id == id; });
+    if (it == m_Layers.end())
+        return;
+
+    if (m_FocusedLayer == id)
+        m_FocusedLayer = 0;
+    if (m_MouseLayer == id)
+        m_MouseCaptured = false;
+
+    ReleaseViewContext(it->view.get());
+    m_Layers.erase(it);
+}
+
+void UltralightRenderer::SetLayerRect(uint32_t id, int x, int y, uint32_t width, uint32_t height)
+{
+    UltralightLayer* layer = FindLayer(id);
+    if (!layer)
+        return;
+
+    layer->x = x;
+    layer->y = y;
+
+    width = std::max(width, 1u);
+    height = std::max(height, 1u);
+    if (width != layer->width || height != layer->height)
+    {
+        layer->width = width;
+        layer->height = height;
+        layer->view->Resize(width, height);
+    }
+}
+
+void UltralightRenderer::SetLayerZOrder(uint32_t id, int zOrder)
+{
+    UltralightLayer* layer = FindLayer(id);
+    if (!layer || layer->zOrder == zOrder)
+        return;
+
+    layer->zOrder = zOrder;
+    std::stable_sort(m_Layers.begin(), m_Layers.end(),
+                     [](const UltralightLayer& a, const UltralightLayer& b) { return a.zOrder < b.zOrder; });
+}
+
+void UltralightRenderer::SetLayerVisible(uint32_t id, bool visible)
+{
+    if (UltralightLayer* layer = FindLayer(id))
+        layer->visible = visible;
+}
+
+void UltralightRenderer::SetLayerInteractive(uint32_t id, bool interactive)
+{
+    if (UltralightLayer* layer = FindLayer(id))
+        layer->interactive = interactive;
+}
+
+void UltralightRenderer::LoadLayerURL(uint32_t id, const std::string& url)
+{
+    if (UltralightLayer* layer = FindLayer(id))
+        layer->view->LoadURL(url.c_str());
+}
+
+void UltralightRenderer::LoadLayerHTML(uint32_t id, const std::string& html)
+{
+    if (UltralightLayer* layer = FindLayer(id))
+        layer->view->LoadHTML(html.c_str());
+}
+
+bool UltralightRenderer::UploadLayers()
+{
+    if (!m_Initialized || m_GPUDriver)
+        return false;
+
+    bool uploaded = false;
+    for (UltralightLayer& layer : m_Layers)
+    {
+        if (!layer.visible)
+            continue;
+
+        if (!layer.texture)
+        {
+            layer.texture = std::make_unique<Texture>(layer.width, layer.height, nullptr, GL_RGBA8, GL_BGRA);
+            layer.texture->EnableStreaming(3);
+        }
+
+        // Clean surfaces keep the texture from their last upload
+        if (UploadViewSurface(layer.view.get(), *layer.texture))
+            uploaded = true;
+    }
+
+    return uploaded;
+}
+
+bool UltralightRenderer::BindLayer(const UltralightLayer& layer, uint32_t slot, UVRect* uv) const
+{
+    if (m_GPUDriver)
+        return BindViewRenderTarget(layer.view.get(), slot, uv);
+
+    if (!layer.texture)
+        return false;
+
+    if (uv)
+        *uv = UVRect();
+    layer.texture->Bind(slot);
+    return true;
+}
+
+UltralightLayer* UltralightRenderer::FindLayer(uint32_t id)
+{
+    for (UltralightLayer& layer : m_Layers)
+    {
+        if (layer.id == id)
+            return &layer;
+    }
+    return nullptr;
+}
+
+UltralightLayer* UltralightRenderer::HitTestLayer(int x, int y)
+{
+    for (auto it = m_Layers.rbegin(); it != m_Layers.rend(); ++it)
+    {
+        if (!it->visible || !it->interactive)
+            continue;
+
+        if (x >= it->x && y >= it->y &&
+            x < it->x + static_cast<int>(it->width) && y < it->y + static_cast<int>(it->height))
+            return &*it;
+    }
+    return nullptr;
+}
+
+ultralight::View* UltralightRenderer::GetLayerView(uint32_t id)
+{
+    if (id == 0)
+        return m_View.get();
+
+    UltralightLayer* layer = FindLayer(id);
+    return layer ? layer->view.get() : nullptr;
+}
+
+void UltralightRenderer::FocusLayer(uint32_t id)
+{
+    if (id == m_FocusedLayer)
+        return;
+
+    if (ultralight::View* previous = GetLayerView(m_FocusedLayer))
+        previous->Unfocus();
+
+    m_FocusedLayer = id;
+    if (ultralight::View* view = GetLayerView(id))
+        view->Focus();
 }
 
 void UltralightLoadListener::OnBeginLoading(ultralight::View* caller, uint64_t frame_id, bool is_main_frame,
@@ -405,6 +1693,13 @@ void UltralightLoadListener::OnFailLoading(ultralight::View* caller, uint64_t fr
     }
 }
 
+void UltralightLoadListener::OnWindowObjectReady(ultralight::View* caller, uint64_t frame_id, bool is_main_frame,
+                                                 const ultralight::String& url)
+{
+    if (is_main_frame && g_CurrentRenderer)
+        g_CurrentRenderer->InstallVisibilityGate(caller);
+}
+
 void UltralightLoadListener::OnDOMReady(ultralight::View* caller, uint64_t frame_id, bool is_main_frame,
                                         const ultralight::String& url)
 {
@@ -413,7 +1708,7 @@ void UltralightLoadListener::OnDOMReady(ultralight::View* caller, uint64_t frame
         std::cout << "[Load] DOM ready for: " << url.utf8().data() << std::endl;
         
         if (g_CurrentRenderer)
-            g_CurrentRenderer->BindJavaScriptAPI();
+            g_CurrentRenderer->BindJavaScriptAPI(caller);
         
         caller->set_needs_paint(true);
     }
@@ -3,23 +3,50 @@
 #include <Ultralight/Ultralight.h>
 #include <Ultralight/Listener.h>
 #include <AppCore/Platform.h>
+#include "ComponentSlots.h"
 #include <cstdint>
 #include <string>
 #include <functional>
 #include <unordered_map>
+#include <vector>
 #include <memory>
+#include <future>
 
 class JSBridge;
+class Texture;
+class GLSurfaceFactory;
+class GPUDriverGL;
+class BundleFileSystem;
+class FontCache;
+struct UltralightWorker;
 
-struct ComponentSlot
+// Region of a bound texture that holds the page, normalized. Ultralight pads
+// its GPU render targets, so there it is usually less than the whole texture.
+struct UVRect
 {
-    float x = 0;
-    float y = 0;
-    float width = 0;
-    float height = 0;
-    bool visible = false;
+    float left = 0.0f;
+    float top = 0.0f;
+    float right = 1.0f;
+    float bottom = 1.0f;
 };
 
+// An additional view composited over the main one, e.g. a HUD or popup.
+// Position and size are in main-view pixels, higher zOrder draws on top.
+struct UltralightLayer
+{
+    uint32_t id = 0;
+    std::string name;
+    ultralight::RefPtr<ultralight::View> view;
+    int x = 0;
+    int y = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int zOrder = 0;
+    bool transparent = true;
+    bool visible = true;
+    bool interactive = true;
+    std::unique_ptr<Texture> texture;
+};
 
 class UltralightLoadListener : public ultralight::LoadListener
 {
@@ -31,6 +58,8 @@ public:
     void OnFailLoading(ultralight::View* caller, uint64_t frame_id, bool is_main_frame,
                        const ultralight::String& url, const ultralight::String& description,
                        const ultralight::String& error_domain, int error_code) override;
+    void OnWindowObjectReady(ultralight::View* caller, uint64_t frame_id, bool is_main_frame,
+                             const ultralight::String& url) override;
     void OnDOMReady(ultralight::View* caller, uint64_t frame_id, bool is_main_frame,
                     const ultralight::String& url) override;
 };
@@ -52,13 +81,84 @@ private:
     uint32_t m_Height;
     UltralightLoadListener m_LoadListener;
     UltralightViewListener m_ViewListener;
-    std::unordered_map<std::string, ComponentSlot> m_ComponentSlots;
+    // Written from the JS thread; the snapshot is what the last frame
+    // handed to the main thread was laid out with
+    ComponentSlotRegistry m_ComponentSlots;
+    ComponentSlotSnapshot m_SlotSnapshot;
     std::unique_ptr<JSBridge> m_JSBridge;
+    std::unique_ptr<GLSurfaceFactory> m_SurfaceFactory;
+    std::unique_ptr<GPUDriverGL> m_GPUDriver;
+    std::unique_ptr<BundleFileSystem> m_BundleFileSystem;
+    std::string m_BundlePath;
+    std::unique_ptr<FontCache> m_FontCache;
+    bool m_UseGLSurfaces;
+    bool m_UseGPURendering;
+    bool m_RenderTargetDirty;
+    bool m_UseWorkerThread;
+    double m_WorkerTickRate;
+    std::unique_ptr<UltralightWorker> m_Worker;
+    std::function<void()> m_FrameReadyCallback;
+    std::vector<UltralightLayer> m_Layers;
+    uint32_t m_NextLayerID;
+    uint32_t m_FocusedLayer;
+    uint32_t m_MouseLayer;
+    bool m_MouseCaptured;
+    int m_MouseX;
+    int m_MouseY;
+
+    struct PooledView
+    {
+        std::string route;
+        ultralight::RefPtr<ultralight::View> view;
+        uint64_t lastUsed = 0;
+    };
+    std::vector<std::pair<std::string, std::string>> m_Routes;
+    std::vector<PooledView> m_ViewPool;
+    // Page context last bound in each view, so its listener can be dropped
+    std::unordered_map<ultralight::View*, JSGlobalContextRef> m_BoundContexts;
+    std::string m_CurrentRoute;
+    // Switch requested from JS, applied at the start of the next Update()
+    std::string m_PendingRoute;
+    size_t m_ViewPoolSize;
+    uint64_t m_PoolClock;
 
     void SetupJSBridge();
+    bool CreateRenderer(uint32_t width, uint32_t height);
+    bool StartWorker(uint32_t width, uint32_t height);
+    void StopWorker();
+    void WakeWorker();
+    void RunWorker(uint32_t width, uint32_t height, std::promise<bool>& ready);
+    void PublishFrame();
+    // Runs the command on the thread that owns the renderer and view.
+    void PostToWorker(std::function<void()> command);
+    // Input that can merge with the previous one while the worker is behind
+    void PostMouseMoveToWorker(const ultralight::MouseEvent& evt);
+    void PostScrollToWorker(const ultralight::ScrollEvent& evt);
+    void PostToMainThread(std::function<void()> call);
+    void EmitResize(uint32_t width, uint32_t height);
+    void ReleaseViewContext(ultralight::View* view);
+    // Settles async calls and drops event listeners; before views go away.
+    void ReleaseJSContexts();
+    ultralight::ViewConfig MakeViewConfig(bool transparent) const;
+    bool UploadViewSurface(ultralight::View* view, Texture& texture);
+    bool BindViewRenderTarget(ultralight::View* view, uint32_t slot, UVRect* uv) const;
+    UltralightLayer* FindLayer(uint32_t id);
+    UltralightLayer* HitTestLayer(int x, int y);
+    // Layer 0 is the main view.
+    ultralight::View* GetLayerView(uint32_t id);
+    void FocusLayer(uint32_t id);
+    const std::string* FindRouteURL(const std::string& route) const;
+    ultralight::RefPtr<ultralight::View> CreatePooledView(const std::string& url);
+    void SetViewHidden(ultralight::View* view, bool hidden);
+    void TrimViewPool();
+    // Paints the main view and visible layers only, never pooled views
+    void RenderVisibleViews();
 
 public:
     void BindJavaScriptAPI();
+    void BindJavaScriptAPI(ultralight::View* view);
+    // Runs before the page's scripts, so its timers can be held while pooled
+    void InstallVisibilityGate(ultralight::View* view);
     
     JSBridge* GetJSBridge() const { return m_JSBridge.get(); }
     UltralightRenderer();
@@ -70,6 +170,37 @@ public:
     UltralightRenderer(UltralightRenderer&& other) noexcept;
     UltralightRenderer& operator=(UltralightRenderer&& other) noexcept;
 
+    // Paint views into persistently mapped GL buffers instead of heap bitmaps.
+    // Must be called before Initialize, on the thread that owns the GL context.
+    void EnableGLSurfaces(bool enable) { m_UseGLSurfaces = enable; }
+    // Render views on the GPU through GPUDriverGL instead of rasterizing on
+    // the CPU. Takes precedence over GL surfaces. Must be called before Initialize.
+    void EnableGPURendering(bool enable) { m_UseGPURendering = enable; }
+    // Serve files from an archive built by scripts/pack_bundle.py, falling
+    // back to the working directory for anything not in it. Must be called
+    // before Initialize.
+    void SetBundlePath(const std::string& path) { m_BundlePath = path; }
+    // Load a font face during Initialize instead of on first use. An empty
+    // path resolves the face through the platform; otherwise the path is
+    // looked up in the bundle, then on disk. The default families are always
+    // preloaded at regular and bold weights.
+    void DeclareFont(const std::string& family, int weight, bool italic, const std::string& path = "");
+    // Use a family for characters in [first, last] without asking the platform.
+    void DeclareFallbackFont(uint32_t first, uint32_t last, const std::string& family);
+    // Host the renderer and view on a dedicated thread. Input and load
+    // requests are queued to it, finished bitmaps come back through
+    // UploadSurface() and JSBridge callbacks run on the caller's thread during
+    // Update(). GL surfaces and GPU rendering are unavailable in this mode.
+    // Must be called before Initialize; a threaded renderer must not be moved.
+    void EnableWorkerThread(bool enable) { m_UseWorkerThread = enable; }
+    // How often the worker ticks Ultralight when it is not woken by input.
+    void SetWorkerTickRate(double hz) { m_WorkerTickRate = hz; }
+    // Called from the worker thread whenever a frame or a JSBridge call is
+    // ready for the main thread, and, without a worker, from any thread when
+    // async results or events are waiting to be delivered in Update().
+    // Must be set before Initialize.
+    void SetFrameReadyCallback(std::function<void()> callback) { m_FrameReadyCallback = std::move(callback); }
+
     bool Initialize(uint32_t width, uint32_t height);
     void Shutdown();
 
@@ -79,19 +210,72 @@ public:
     void LoadHTML(const std::string& html);
     void LoadURL(const std::string& url);
 
-    ultralight::View* GetView() const { return m_View.get(); }
+    // Null when the view lives on a worker thread; use the Fire*/Load*
+    // methods instead, which work in both modes.
+    ultralight::View* GetView() const { return m_Worker ? nullptr : m_View.get(); }
     bool IsInitialized() const { return m_Initialized; }
+    bool IsThreaded() const { return m_Worker != nullptr; }
+    bool IsAccelerated() const { return m_GPUDriver != nullptr; }
+    GPUDriverGL* GetGPUDriver() const { return m_GPUDriver.get(); }
     uint32_t GetWidth() const { return m_Width; }
     uint32_t GetHeight() const { return m_Height; }
 
     ultralight::Bitmap* GetBitmap() const;
     bool IsDirty() const;
+    ultralight::IntRect GetDirtyBounds() const;
     void ClearDirty();
+    // Uploads whatever changed since the last call into the texture.
+    bool UploadSurface(Texture& texture);
+    // Binds the view's GPU render target for compositing (accelerated mode
+    // only). uv receives the part of the texture to sample.
+    bool BindRenderTarget(uint32_t slot = 0, UVRect* uv = nullptr) const;
     void ForceRepaint();
 
-    void SetComponentSlot(const std::string& name, float x, float y, float width, float height, bool visible);
-    const ComponentSlot* GetComponentSlot(const std::string& name) const;
-    const std::unordered_map<std::string, ComponentSlot>& GetAllSlots() const { return m_ComponentSlots; }
+    void FireMouseEvent(const ultralight::MouseEvent& evt);
+    void FireScrollEvent(const ultralight::ScrollEvent& evt);
+    void FireKeyEvent(const ultralight::KeyEvent& evt);
+    void SetFocus(bool focused);
+
+    // Handle of a named component slot, the same one pages get for the name,
+    // so it can be looked up once instead of every frame.
+    uint32_t DeclareComponentSlot(const std::string& name) { return m_ComponentSlots.Acquire(name); }
+    // Slots as laid out in the UI frame last produced by Render() or, with a
+    // worker, taken by UploadSurface(), so components line up with it.
+    const ComponentSlotSnapshot& GetComponentSlots() const { return m_SlotSnapshot; }
 
     void Resize(uint32_t width, uint32_t height);
+
+    // Named pages that can be kept preloaded in hidden views. Switching to a
+    // pooled route swaps it in as the main view without reloading. Not
+    // available with a worker thread.
+    void DeclareRoute(const std::string& route, const std::string& url);
+    // Maximum number of hidden views kept warm, not counting the visible one.
+    void SetViewPoolSize(size_t size);
+    // Creates and loads hidden views for declared routes until the pool is full.
+    void PrewarmRoutes();
+    // Not from inside a bridge callback: the calling page's view may be
+    // released. Pages call switchRoute, which is applied on the next Update().
+    bool SwitchToRoute(const std::string& route);
+    const std::string& GetCurrentRoute() const { return m_CurrentRoute; }
+
+    // Extra views sharing this renderer, composited over the main view by
+    // LayerCompositor. Not available with a worker thread. Returns 0 on failure.
+    uint32_t CreateLayer(const std::string& name, int x, int y, uint32_t width, uint32_t height,
+                         int zOrder, bool transparent = true);
+    void DestroyLayer(uint32_t id);
+    void SetLayerRect(uint32_t id, int x, int y, uint32_t width, uint32_t height);
+    void SetLayerZOrder(uint32_t id, int zOrder);
+    void SetLayerVisible(uint32_t id, bool visible);
+    // Non-interactive layers let mouse input fall through to what is below.
+    void SetLayerInteractive(uint32_t id, bool interactive);
+    void LoadLayerURL(uint32_t id, const std::string& url);
+    void LoadLayerHTML(uint32_t id, const std::string& html);
+    // Sorted by zOrder, bottom first.
+    const std::vector<UltralightLayer>& GetLayers() const { return m_Layers; }
+    // Uploads the dirty region of every visible layer into its texture,
+    // skipping clean ones. Returns true if anything was uploaded.
+    bool UploadLayers();
+    // Binds the layer's texture or, when accelerated, its render target. uv
+    // receives the part of the texture to sample.
+    bool BindLayer(const UltralightLayer& layer, uint32_t slot = 0, UVRect* uv = nullptr) const;
 };
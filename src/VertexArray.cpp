@@ -64,6 +64,23 @@ void VertexArray::AddVertexBuffer(const VertexBuffer& vertexBuffer)
     m_VertexBufferIndex++;
 }
 
+void VertexArray::AddVertexBuffer(const VertexBuffer& vertexBuffer, const std::vector<VertexAttribute>& layout, uint32_t stride)
+{
+    Bind();
+    vertexBuffer.Bind();
+
+    for (uint32_t i = 0; i < layout.size(); i++)
+    {
+        const VertexAttribute& attribute = layout[i];
+        glEnableVertexAttribArray(i);
+        glVertexAttribPointer(i, attribute.componentCount, attribute.type,
+                              attribute.normalized ? GL_TRUE : GL_FALSE, stride,
+                              (const void*)(static_cast<uintptr_t>(attribute.offset)));
+    }
+
+    m_VertexBufferIndex++;
+}
+
 void VertexArray::SetIndexBuffer(const IndexBuffer& indexBuffer)
 {
     Bind();
@@ -3,10 +3,19 @@
 #include <glad/glad.h>
 #include <memory>
 #include <cstdint>
+#include <vector>
 
 class VertexBuffer;
 class IndexBuffer;
 
+struct VertexAttribute
+{
+    uint32_t componentCount;
+    uint32_t type;
+    bool normalized;
+    uint32_t offset;
+};
+
 class VertexArray
 {
 private:
@@ -26,6 +35,8 @@ public:
     void Unbind() const;
 
     void AddVertexBuffer(const VertexBuffer& vertexBuffer);
+    // Binds a buffer with an arbitrary interleaved layout; attribute i goes to location i.
+    void AddVertexBuffer(const VertexBuffer& vertexBuffer, const std::vector<VertexAttribute>& layout, uint32_t stride);
     void SetIndexBuffer(const IndexBuffer& indexBuffer);
 
     uint32_t GetID() const { return m_RendererID; }
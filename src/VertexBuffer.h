@@ -21,5 +21,8 @@ public:
     void Bind() const;
     void Unbind() const;
 
+    // Replaces the contents, reallocating the storage as GL_DYNAMIC_DRAW.
+    void SetData(const void* data, size_t size);
+
     uint32_t GetID() const { return m_RendererID; }
 };
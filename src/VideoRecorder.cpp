@@ -0,0 +1,336 @@
+#include "VideoRecorder.h"
+#include "ColorConvert.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#define POPEN_WRITE_MODE "wb"
+#else
+#include <csignal>
+#define POPEN_WRITE_MODE "w"
+#endif
+
+// Upper bound on the frames repeated to cover a single gap, so one long
+// stall cannot turn into seconds of writer work.
+static constexpr uint32_t MAX_REPEAT_SECONDS = 2;
+
+VideoRecorder::Container VideoRecorder::ContainerFromString(const std::string& name)
+{
+    if (name == "raw" || name == "yuv" || name == "i420")
+        return Container::Raw;
+    return Container::Y4M;
+}
+
+VideoRecorder::VideoRecorder(size_t latency, size_t frameCount, size_t converterThreads)
+    : m_Readback(latency)
+    , m_Output(nullptr)
+    , m_IsPipe(false)
+    , m_Container(Container::Y4M)
+    , m_Width(0)
+    , m_Height(0)
+    , m_FrameRate(0)
+    , m_LastIndex(-1)
+    , m_NextSequence(0)
+    , m_NextWrite(0)
+    , m_Stopping(false)
+    , m_Written(0)
+    , m_Duplicated(0)
+    , m_Failed(false)
+    , m_Converters(converterThreads)
+{
+    for (size_t i = 0; i < std::max<size_t>(frameCount, 1); i++)
+        m_Frames.push_back(std::make_unique<Frame>());
+
+    m_OnReadback = [this](const uint8_t* pixels, uint32_t width, uint32_t height, uint64_t index)
+    {
+        Receive(pixels, width, height, index);
+    };
+}
+
+VideoRecorder::~VideoRecorder()
+{
+    Stop();
+}
+
+bool VideoRecorder::Start(const std::string& output, uint32_t width, uint32_t height, uint32_t frameRate,
+                          Container container)
+{
+    if (IsRecording())
+    {
+        std::cerr << "Already recording" << std::endl;
+        return false;
+    }
+
+    // I420 subsamples chroma 2x2
+    width &= ~1u;
+    height &= ~1u;
+    if (width == 0 || height == 0 || frameRate == 0)
+    {
+        std::cerr << "Invalid recording size " << width << "x" << height << " at " << frameRate << " fps" << std::endl;
+        return false;
+    }
+
+    m_IsPipe = !output.empty() && output[0] == '|';
+    if (m_IsPipe)
+    {
+#ifndef _WIN32
+        // A consumer that exits early should fail the write, not kill us
+        std::signal(SIGPIPE, SIG_IGN);
+#endif
+        m_Output = popen(output.c_str() + 1, POPEN_WRITE_MODE);
+    }
+    else
+    {
+        m_Output = std::fopen(output.c_str(), "wb");
+    }
+
+    if (!m_Output)
+    {
+        std::cerr << "Failed to open recording output: " << output << std::endl;
+        return false;
+    }
+
+    m_Container = container;
+    m_Width = width;
+    m_Height = height;
+    m_FrameRate = frameRate;
+    m_LastIndex = -1;
+    m_NextSequence = 0;
+    m_NextWrite = 0;
+    m_Stopping = false;
+    m_Stats = Stats();
+    m_Written = 0;
+    m_Duplicated = 0;
+    m_Failed = false;
+
+    size_t pixelCount = static_cast<size_t>(width) * height;
+    m_FreeFrames.clear();
+    for (const std::unique_ptr<Frame>& frame : m_Frames)
+    {
+        frame->bgra.resize(pixelCount * 4);
+        frame->i420.resize(pixelCount * 3 / 2);
+        m_FreeFrames.push_back(frame.get());
+    }
+
+    if (m_Container == Container::Y4M)
+    {
+        std::fprintf(m_Output, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n",
+                     width, height, frameRate);
+    }
+
+    m_StartTime = std::chrono::steady_clock::now();
+    m_Writer = std::thread(&VideoRecorder::WriterLoop, this);
+
+    std::cout << "Recording " << width << "x" << height << " at " << frameRate << " fps to "
+              << (m_IsPipe ? output.substr(1) : output) << std::endl;
+    return true;
+}
+
+void VideoRecorder::Stop()
+{
+    if (!IsRecording())
+        return;
+
+    // Drain the pipeline in order: readbacks, conversions, then the writer
+    m_Readback.Flush(m_OnReadback);
+    m_Converters.WaitIdle();
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_FrameReady.notify_all();
+    m_Writer.join();
+
+    if (m_IsPipe)
+        pclose(m_Output);
+    else
+        std::fclose(m_Output);
+    m_Output = nullptr;
+
+    Stats stats = GetStats();
+    std::cout << "Recording stopped: " << stats.written << " frames written, " << stats.duplicated
+              << " repeated, " << stats.dropped << " dropped" << std::endl;
+}
+
+bool VideoRecorder::IsDue() const
+{
+    if (!IsRecording())
+        return false;
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_StartTime).count();
+    return static_cast<int64_t>(elapsed * m_FrameRate) > m_LastIndex;
+}
+
+bool VideoRecorder::CaptureIfDue(uint32_t framebufferID, uint32_t width, uint32_t height)
+{
+    if (!IsRecording())
+        return false;
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_StartTime).count();
+    int64_t index = static_cast<int64_t>(elapsed * m_FrameRate);
+    if (index <= m_LastIndex)
+        return false;
+    m_LastIndex = index;
+
+    if (!m_Readback.Issue(framebufferID, width, height, static_cast<uint64_t>(index)))
+    {
+        m_Stats.dropped++;
+        return false;
+    }
+
+    m_Stats.captured++;
+    return true;
+}
+
+void VideoRecorder::Poll()
+{
+    m_Readback.Poll(m_OnReadback);
+}
+
+void VideoRecorder::Receive(const uint8_t* pixels, uint32_t width, uint32_t height, uint64_t index)
+{
+    Frame* frame = nullptr;
+    if (pixels)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_FreeFrames.empty())
+        {
+            frame = m_FreeFrames.back();
+            m_FreeFrames.pop_back();
+        }
+    }
+
+    if (!frame)
+    {
+        // Converters or consumer are behind
+        m_Stats.dropped++;
+        return;
+    }
+
+    // Keep GL's bottom-up row order; the converter flips for free
+    size_t rowBytes = static_cast<size_t>(m_Width) * 4;
+    if (width == m_Width && height == m_Height)
+    {
+        std::memcpy(frame->bgra.data(), pixels, rowBytes * m_Height);
+    }
+    else
+    {
+        // Resized window: keep the top-left corner, pad with black
+        size_t copyBytes = static_cast<size_t>(std::min(width, m_Width)) * 4;
+        for (uint32_t top = 0; top < m_Height; top++)
+        {
+            uint8_t* destination = frame->bgra.data() + (m_Height - 1 - top) * rowBytes;
+            if (top < height)
+            {
+                std::memcpy(destination, pixels + static_cast<size_t>(height - 1 - top) * width * 4, copyBytes);
+                std::memset(destination + copyBytes, 0, rowBytes - copyBytes);
+            }
+            else
+            {
+                std::memset(destination, 0, rowBytes);
+            }
+        }
+    }
+
+    frame->index = index;
+    uint64_t sequence = m_NextSequence++;
+    m_Converters.Submit([this, frame, sequence]() { Convert(frame, sequence); });
+}
+
+void VideoRecorder::Convert(Frame* frame, uint64_t sequence)
+{
+    size_t pixelCount = static_cast<size_t>(m_Width) * m_Height;
+    ptrdiff_t rowBytes = static_cast<ptrdiff_t>(m_Width) * 4;
+    // The writer swaps buffers with its last frame, which may not be sized yet
+    frame->i420.resize(pixelCount * 3 / 2);
+    uint8_t* y = frame->i420.data();
+    uint8_t* u = y + pixelCount;
+    uint8_t* v = u + pixelCount / 4;
+
+    ColorConvert::BGRAToI420(frame->bgra.data() + (m_Height - 1) * rowBytes, -rowBytes, m_Width, m_Height,
+                             y, m_Width, u, v, m_Width / 2);
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Converted[sequence] = frame;
+    }
+    m_FrameReady.notify_one();
+}
+
+bool VideoRecorder::WriteFrame(const std::vector<uint8_t>& i420)
+{
+    if (m_Container == Container::Y4M && std::fwrite("FRAME\n", 1, 6, m_Output) != 6)
+        return false;
+    return std::fwrite(i420.data(), 1, i420.size(), m_Output) == i420.size();
+}
+
+void VideoRecorder::WriterLoop()
+{
+    // Last frame written, kept to fill gaps left by dropped frames
+    std::vector<uint8_t> previous;
+    uint64_t previousIndex = 0;
+    bool hasPrevious = false;
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    for (;;)
+    {
+        m_FrameReady.wait(lock, [this]()
+        {
+            return m_Stopping || (!m_Converted.empty() && m_Converted.begin()->first == m_NextWrite);
+        });
+
+        if (m_Converted.empty() || m_Converted.begin()->first != m_NextWrite)
+        {
+            // Stopping, and every converted frame has been written
+            break;
+        }
+
+        Frame* frame = m_Converted.begin()->second;
+        m_Converted.erase(m_Converted.begin());
+        m_NextWrite++;
+        lock.unlock();
+
+        if (!m_Failed)
+        {
+            bool ok = true;
+            if (hasPrevious && frame->index > previousIndex + 1)
+            {
+                uint64_t repeats = std::min<uint64_t>(frame->index - previousIndex - 1,
+                                                      static_cast<uint64_t>(m_FrameRate) * MAX_REPEAT_SECONDS);
+                for (uint64_t i = 0; i < repeats && ok; i++)
+                {
+                    ok = WriteFrame(previous);
+                    m_Duplicated++;
+                }
+            }
+
+            if (ok && WriteFrame(frame->i420))
+            {
+                m_Written++;
+                std::swap(previous, frame->i420);
+                previousIndex = frame->index;
+                hasPrevious = true;
+            }
+            else
+            {
+                m_Failed = true;
+                std::cerr << "Recording output stopped accepting frames" << std::endl;
+            }
+        }
+
+        lock.lock();
+        m_FreeFrames.push_back(frame);
+    }
+}
+
+VideoRecorder::Stats VideoRecorder::GetStats() const
+{
+    Stats stats = m_Stats;
+    stats.written = m_Written.load();
+    stats.duplicated = m_Duplicated.load();
+    stats.failed = m_Failed.load();
+    return stats;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "AsyncReadback.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records the composited window to an uncompressed I420 stream. Frames are
+// read back through an AsyncReadback ring, converted from BGRA on a small
+// worker pool and written in order by a dedicated writer thread, either to a
+// file or to the stdin of an external encoder. A fixed pool of frame buffers
+// bounds memory: when the converters or the consumer fall behind, new frames
+// are dropped rather than stalling the render thread, and the writer repeats
+// the previous frame to keep the stream's timing intact.
+class VideoRecorder
+{
+public:
+    enum class Container
+    {
+        Y4M,
+        Raw
+    };
+
+    struct Stats
+    {
+        uint64_t captured = 0;
+        uint64_t dropped = 0;
+        uint64_t written = 0;
+        uint64_t duplicated = 0;
+        bool failed = false;
+    };
+
+    static Container ContainerFromString(const std::string& name);
+
+private:
+    struct Frame
+    {
+        std::vector<uint8_t> bgra;
+        std::vector<uint8_t> i420;
+        uint64_t index = 0;
+    };
+
+    AsyncReadback m_Readback;
+    AsyncReadback::Callback m_OnReadback;
+
+    std::FILE* m_Output;
+    bool m_IsPipe;
+    Container m_Container;
+    uint32_t m_Width;
+    uint32_t m_Height;
+    uint32_t m_FrameRate;
+    std::chrono::steady_clock::time_point m_StartTime;
+    // Timestamp index of the last frame issued for readback
+    int64_t m_LastIndex;
+    uint64_t m_NextSequence;
+
+    std::vector<std::unique_ptr<Frame>> m_Frames;
+    // Everything below is shared with the converters and the writer
+    std::mutex m_Mutex;
+    std::condition_variable m_FrameReady;
+    std::vector<Frame*> m_FreeFrames;
+    std::map<uint64_t, Frame*> m_Converted;
+    uint64_t m_NextWrite;
+    bool m_Stopping;
+
+    Stats m_Stats;
+    std::atomic<uint64_t> m_Written;
+    std::atomic<uint64_t> m_Duplicated;
+    std::atomic<bool> m_Failed;
+
+    std::thread m_Writer;
+    // Last, so its workers are joined before anything they touch goes away
+    ThreadPool m_Converters;
+
+    void Receive(const uint8_t* pixels, uint32_t width, uint32_t height, uint64_t index);
+    void Convert(Frame* frame, uint64_t sequence);
+    void WriterLoop();
+    bool WriteFrame(const std::vector<uint8_t>& i420);
+
+public:
+    // latency is the number of readbacks in flight; frameCount bounds how
+    // many frames may be converting or waiting on the writer at once.
+    explicit VideoRecorder(size_t latency = 3, size_t frameCount = 6, size_t converterThreads = 2);
+    // Stops recording. Requires the GL context to still be current.
+    ~VideoRecorder();
+
+    VideoRecorder(const VideoRecorder&) = delete;
+    VideoRecorder& operator=(const VideoRecorder&) = delete;
+
+    // output is a file path, or "|command" to pipe the stream into a
+    // command's stdin. Odd dimensions are rounded down to even.
+    bool Start(const std::string& output, uint32_t width, uint32_t height, uint32_t frameRate,
+               Container container = Container::Y4M);
+    // Writes out every frame already captured, then closes the output.
+    void Stop();
+
+    bool IsRecording() const { return m_Output != nullptr; }
+    double GetInterval() const { return m_FrameRate > 0 ? 1.0 / m_FrameRate : 0.0; }
+    // True when the next frame of the stream is due.
+    bool IsDue() const;
+
+    // Reads the framebuffer back if a stream frame is due. Framebuffer 0
+    // reads the back buffer, so call this after compositing and before
+    // swapping. A framebuffer of a different size is cropped or padded.
+    bool CaptureIfDue(uint32_t framebufferID, uint32_t width, uint32_t height);
+    // Hands finished readbacks to the converters. Never blocks; call once a
+    // frame.
+    void Poll();
+
+    Stats GetStats() const;
+};
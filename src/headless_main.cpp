@@ -0,0 +1,505 @@
+#include <glad/glad.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Vertex.h"
+#include "Primitives.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "Framebuffer.h"
+#include "Component.h"
+#include "UltralightRenderer.h"
+#include "JSBridge.h"
+#include "HeadlessContext.h"
+#include "ImageWriter.h"
+
+// Renders a queue of pages, with the native cube composited into its slot,
+// to image files without a window. One job per line:
+//
+//   url <TAB> output [<TAB> WIDTHxHEIGHT [<TAB> state]]
+//
+// state is a JSON value delivered to the page as the detail of a
+// 'nativestate' event before capture; a job whose state is not valid JSON
+// fails. Consecutive jobs for the same URL reuse the loaded page and only
+// deliver the new state.
+
+static constexpr uint32_t DEFAULT_WIDTH = 1280;
+static constexpr uint32_t DEFAULT_HEIGHT = 720;
+
+struct RenderJob
+{
+    std::string url;
+    std::string output;
+    uint32_t width = DEFAULT_WIDTH;
+    uint32_t height = DEFAULT_HEIGHT;
+    std::string state;
+};
+
+struct ComponentState
+{
+    glm::vec3 rotation = glm::vec3(0.0f);
+    PrimitiveType primitive = PrimitiveType::Cube;
+    bool primitiveChanged = false;
+};
+
+static bool ParseJob(const std::string& line, RenderJob& job)
+{
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (fields.size() < 3 && std::getline(stream, field, '\t'))
+        fields.push_back(field);
+    // The state is everything after the third tab, tabs included
+    if (fields.size() == 3 && std::getline(stream, field, '\0'))
+        job.state = field;
+
+    if (fields.size() < 2 || fields[0].empty() || fields[1].empty())
+        return false;
+
+    job.url = fields[0];
+    job.output = fields[1];
+    if (fields.size() >= 3 && !fields[2].empty())
+    {
+        unsigned width = 0, height = 0;
+        if (std::sscanf(fields[2].c_str(), "%ux%u", &width, &height) != 2 || width == 0 || height == 0)
+            return false;
+        job.width = width;
+        job.height = height;
+    }
+    return true;
+}
+
+static bool ReadJobs(std::istream& input, const std::filesystem::path& baseDir, std::vector<RenderJob>& jobs)
+{
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(input, line))
+    {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        RenderJob job;
+        if (!ParseJob(line, job))
+        {
+            std::cerr << "Skipping malformed job on line " << lineNumber << std::endl;
+            continue;
+        }
+
+        // Outputs are relative to where we were started, not the exe dir
+        if (std::filesystem::path(job.output).is_relative())
+            job.output = (baseDir / job.output).string();
+        jobs.push_back(std::move(job));
+    }
+    return !jobs.empty();
+}
+
+// Ticks Ultralight until the page has loaded, then a few more times so
+// scripts and layout triggered by the load can settle.
+static bool SettlePage(UltralightRenderer& ultralight, double timeoutSeconds, int settleFrames, bool waitForLoad)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeoutSeconds);
+    while (waitForLoad && ultralight.GetView()->is_loading())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        ultralight.Update();
+        ultralight.Render();
+        std::this_thread::yield();
+    }
+
+    for (int i = 0; i < settleFrames; i++)
+    {
+        ultralight.Update();
+        ultralight.Render();
+    }
+    return true;
+}
+
+// Quotes text as a JS string literal. Line and paragraph separators are
+// escaped too since older engines reject them inside literals.
+static std::string ToJSStringLiteral(const std::string& text)
+{
+    std::string literal = "\"";
+    literal.reserve(text.size() + 2);
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c == '"' || c == '\\')
+        {
+            literal += '\\';
+            literal += static_cast<char>(c);
+        }
+        else if (c < 0x20)
+        {
+            char escaped[7];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            literal += escaped;
+        }
+        else if (c == 0xE2 && i + 2 < text.size() && text[i + 1] == '\x80' && (text[i + 2] == '\xA8' || text[i + 2] == '\xA9'))
+        {
+            literal += text[i + 2] == '\xA8' ? "\\u2028" : "\\u2029";
+            i += 2;
+        }
+        else
+        {
+            literal += static_cast<char>(c);
+        }
+    }
+    literal += '"';
+    return literal;
+}
+
+// The state goes in as a string and through JSON.parse, so a job can only
+// deliver data. Returns false if it is not valid JSON.
+static bool DeliverState(UltralightRenderer& ultralight, const std::string& state)
+{
+    std::string script =
+        "window.dispatchEvent(new CustomEvent('nativestate', { detail: JSON.parse(" + ToJSStringLiteral(state) + ") }));";
+    ultralight::String exception;
+    ultralight.GetView()->EvaluateScript(script.c_str(), &exception);
+    if (!exception.empty())
+    {
+        std::cerr << "State script failed: " << exception.utf8().data() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    std::filesystem::path startDir = std::filesystem::current_path();
+
+    std::string jobsPath;
+    RenderJob singleJob;
+    bool useGPURendering = false;
+    float componentScale = 2.0f;
+    double loadTimeout = 30.0;
+    int settleFrames = 3;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+            jobsPath = argv[++i];
+        else if (std::strcmp(argv[i], "--url") == 0 && i + 1 < argc)
+            singleJob.url = argv[++i];
+        else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            singleJob.output = argv[++i];
+        else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+            std::sscanf(argv[++i], "%ux%u", &singleJob.width, &singleJob.height);
+        else if (std::strcmp(argv[i], "--state") == 0 && i + 1 < argc)
+            singleJob.state = argv[++i];
+        else if (std::strcmp(argv[i], "--gpu") == 0)
+            useGPURendering = true;
+        else if (std::strcmp(argv[i], "--component-scale") == 0 && i + 1 < argc)
+            componentScale = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--timeout") == 0 && i + 1 < argc)
+            loadTimeout = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--settle") == 0 && i + 1 < argc)
+            settleFrames = std::atoi(argv[++i]);
+    }
+
+    std::vector<RenderJob> jobs;
+    if (!jobsPath.empty())
+    {
+        if (jobsPath == "-")
+        {
+            ReadJobs(std::cin, startDir, jobs);
+        }
+        else
+        {
+            std::ifstream jobsFile(jobsPath);
+            if (!jobsFile)
+            {
+                std::cerr << "Could not open job file: " << jobsPath << std::endl;
+                return 1;
+            }
+            ReadJobs(jobsFile, startDir, jobs);
+        }
+    }
+    else if (!singleJob.url.empty() && !singleJob.output.empty())
+    {
+        if (std::filesystem::path(singleJob.output).is_relative())
+            singleJob.output = (startDir / singleJob.output).string();
+        jobs.push_back(singleJob);
+    }
+
+    if (jobs.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " --jobs FILE|- [options]" << std::endl;
+        std::cerr << "       " << argv[0] << " --url URL --out FILE [--size WxH] [--state JSON] [options]" << std::endl;
+        std::cerr << "Options: --gpu --component-scale S --timeout SECONDS --settle FRAMES" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        // Resources, assets and file:/// URLs resolve against the exe dir
+        std::filesystem::path exePath = std::filesystem::canonical("/proc/self/exe");
+        std::filesystem::current_path(exePath.parent_path());
+
+        HeadlessContext context;
+        if (!context.Initialize(4, 5) && !context.Initialize(3, 3))
+            return 1;
+
+        Component primitiveComponent(DEFAULT_WIDTH, DEFAULT_HEIGHT);
+        primitiveComponent.SetClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        primitiveComponent.EnableDepthTest(true);
+        primitiveComponent.SetShader("assets/Shader.vert", "assets/Shader.frag");
+
+        ComponentState componentState;
+        Mesh currentMesh = Primitives::CreatePrimitive(componentState.primitive);
+        primitiveComponent.SetGeometry(currentMesh.vertices.data(),
+                                       static_cast<uint32_t>(currentMesh.vertices.size()),
+                                       currentMesh.indices.data(),
+                                       static_cast<uint32_t>(currentMesh.indices.size()));
+
+        Mesh quadMesh = Primitives::CreateQuad();
+        VertexArray screenQuadVAO;
+        VertexBuffer screenQuadVBO(quadMesh.vertices.data(), quadMesh.vertices.size() * sizeof(Vertex));
+        IndexBuffer screenQuadIBO(quadMesh.indices.data(), static_cast<uint32_t>(quadMesh.indices.size()));
+        screenQuadVAO.Bind();
+        screenQuadVAO.AddVertexBuffer(screenQuadVBO);
+        screenQuadVAO.SetIndexBuffer(screenQuadIBO);
+
+        Mesh flippedQuadMesh = Primitives::CreateQuadFlippedUV();
+        VertexArray flippedQuadVAO;
+        VertexBuffer flippedQuadVBO(flippedQuadMesh.vertices.data(), flippedQuadMesh.vertices.size() * sizeof(Vertex));
+        IndexBuffer flippedQuadIBO(flippedQuadMesh.indices.data(), static_cast<uint32_t>(flippedQuadMesh.indices.size()));
+        flippedQuadVAO.Bind();
+        flippedQuadVAO.AddVertexBuffer(flippedQuadVBO);
+        flippedQuadVAO.SetIndexBuffer(flippedQuadIBO);
+
+        Shader textureShader("assets/TextureShader.vert", "assets/TextureShader.frag");
+        int texLoc = glGetUniformLocation(textureShader.GetID(), "u_Texture");
+        int uvRectLoc = glGetUniformLocation(textureShader.GetID(), "u_UVRect");
+
+        uint32_t width = jobs.front().width;
+        uint32_t height = jobs.front().height;
+
+        UltralightRenderer ultralight;
+        ultralight.EnableGLSurfaces(true);
+        ultralight.EnableGPURendering(useGPURendering);
+        if (std::filesystem::exists("app.bundle"))
+            ultralight.SetBundlePath("app.bundle");
+        if (!ultralight.Initialize(width, height))
+        {
+            std::cerr << "Failed to initialize Ultralight!" << std::endl;
+            return 1;
+        }
+
+        if (auto* bridge = ultralight.GetJSBridge())
+        {
+            bridge->Register("setRotation", [&componentState](const JSArgs& args) -> JSValue {
+                auto x = JSBridge::GetArg<float>(args, 0);
+                auto y = JSBridge::GetArg<float>(args, 1);
+                auto z = JSBridge::GetArg<float>(args, 2);
+                if (x && y && z)
+                    componentState.rotation = glm::vec3(*x, *y, *z);
+                return nullptr;
+            });
+
+            bridge->Register("setPrimitive", [&componentState](const JSArgs& args) -> JSValue {
+                auto type = JSBridge::GetArg<std::string>(args, 0);
+                if (type)
+                {
+                    PrimitiveType newType = StringToPrimitiveType(*type);
+                    if (newType != componentState.primitive)
+                    {
+                        componentState.primitive = newType;
+                        componentState.primitiveChanged = true;
+                    }
+                }
+                return nullptr;
+            });
+
+            bridge->Register("print", [](const JSArgs& args) -> JSValue {
+                auto message = JSBridge::GetArg<std::string>(args, 0);
+                if (message)
+                    std::cout << "JS: " << *message << std::endl;
+                return nullptr;
+            });
+        }
+
+        Texture ultralightTexture(width, height, nullptr, GL_RGBA8, GL_BGRA);
+        Framebuffer output(width, height);
+        std::vector<uint8_t> pixels;
+        std::vector<uint8_t> flipped;
+        std::string loadedURL;
+        size_t failures = 0;
+        uint32_t cubeSlotHandle = ultralight.DeclareComponentSlot("cube");
+
+        auto batchStart = std::chrono::steady_clock::now();
+        for (size_t jobIndex = 0; jobIndex < jobs.size(); jobIndex++)
+        {
+            const RenderJob& job = jobs[jobIndex];
+            auto jobStart = std::chrono::steady_clock::now();
+
+            if (job.width != width || job.height != height)
+            {
+                width = job.width;
+                height = job.height;
+                ultralight.Resize(width, height);
+                output.Resize(width, height);
+            }
+
+            bool reload = job.url != loadedURL;
+            if (reload)
+            {
+                ultralight.LoadURL(job.url);
+                loadedURL = job.url;
+            }
+
+            // Let the load begin before waiting for it to finish
+            ultralight.Update();
+            if (!SettlePage(ultralight, loadTimeout, settleFrames, reload))
+            {
+                std::cerr << "[" << jobIndex + 1 << "/" << jobs.size() << "] Timed out loading " << job.url << std::endl;
+                loadedURL.clear();
+                failures++;
+                continue;
+            }
+
+            if (!job.state.empty())
+            {
+                if (!DeliverState(ultralight, job.state))
+                {
+                    std::cerr << "[" << jobIndex + 1 << "/" << jobs.size() << "] Invalid state for " << job.output << std::endl;
+                    failures++;
+                    continue;
+                }
+                SettlePage(ultralight, loadTimeout, settleFrames, false);
+            }
+
+            if (componentState.primitiveChanged)
+            {
+                currentMesh = Primitives::CreatePrimitive(componentState.primitive);
+                primitiveComponent.SetGeometry(currentMesh.vertices.data(),
+                                               static_cast<uint32_t>(currentMesh.vertices.size()),
+                                               currentMesh.indices.data(),
+                                               static_cast<uint32_t>(currentMesh.indices.size()));
+                componentState.primitiveChanged = false;
+            }
+
+            const ComponentSlot* cubeSlot = ultralight.GetComponentSlots().Get(cubeSlotHandle);
+            bool drawComponent = cubeSlot && cubeSlot->visible && cubeSlot->width > 0 && cubeSlot->height > 0;
+            if (drawComponent)
+            {
+                uint32_t targetWidth = std::max(1u, static_cast<uint32_t>(cubeSlot->width * componentScale));
+                uint32_t targetHeight = std::max(1u, static_cast<uint32_t>(cubeSlot->height * componentScale));
+                if (targetWidth != primitiveComponent.GetWidth() || targetHeight != primitiveComponent.GetHeight())
+                    primitiveComponent.Resize(targetWidth, targetHeight);
+
+                float aspect = static_cast<float>(targetWidth) / static_cast<float>(targetHeight);
+                glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+                glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -3.0f));
+                glm::mat4 model = glm::mat4(1.0f);
+                model = glm::rotate(model, glm::radians(componentState.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+                model = glm::rotate(model, glm::radians(componentState.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+                model = glm::rotate(model, glm::radians(componentState.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+                glm::mat4 mvp = projection * view * model;
+                primitiveComponent.SetMVP(glm::value_ptr(mvp));
+                primitiveComponent.Render();
+            }
+
+            if (!ultralight.IsAccelerated())
+                ultralight.UploadSurface(ultralightTexture);
+
+            // Same composition as the windowed app, into an offscreen target.
+            // Alpha writes are masked so the image stays opaque.
+            output.Bind();
+            glViewport(0, 0, width, height);
+            glDisable(GL_DEPTH_TEST);
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_FALSE);
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+            textureShader.Bind();
+            UVRect uiRect;
+            if (ultralight.IsAccelerated())
+            {
+                ultralight.BindRenderTarget(0, &uiRect);
+                ultralight.ClearDirty();
+            }
+            else
+            {
+                ultralightTexture.Bind(0);
+            }
+            if (texLoc != -1)
+                glUniform1i(texLoc, 0);
+            glUniform4f(uvRectLoc, uiRect.left, uiRect.top, uiRect.right, uiRect.bottom);
+            flippedQuadVAO.Bind();
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+            glUniform4f(uvRectLoc, 0.0f, 0.0f, 1.0f, 1.0f);
+
+            if (drawComponent)
+            {
+                int x = static_cast<int>(cubeSlot->x);
+                int y = static_cast<int>(height - cubeSlot->y - cubeSlot->height);
+                glViewport(x, y, static_cast<int>(cubeSlot->width), static_cast<int>(cubeSlot->height));
+                primitiveComponent.BindTexture(0);
+                screenQuadVAO.Bind();
+                glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+            }
+
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+            size_t rowBytes = static_cast<size_t>(width) * 4;
+            pixels.resize(rowBytes * height);
+            flipped.resize(rowBytes * height);
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glReadPixels(0, 0, width, height, GL_BGRA, GL_UNSIGNED_BYTE, pixels.data());
+            output.Unbind();
+
+            // GL rows are bottom-up
+            for (uint32_t row = 0; row < height; row++)
+                std::memcpy(&flipped[row * rowBytes], &pixels[(height - 1 - row) * rowBytes], rowBytes);
+
+            std::filesystem::path outputPath(job.output);
+            if (outputPath.has_parent_path())
+                std::filesystem::create_directories(outputPath.parent_path());
+
+            if (!ImageWriter::Write(job.output, flipped.data(), width, height, static_cast<uint32_t>(rowBytes)))
+            {
+                failures++;
+                continue;
+            }
+
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - jobStart).count();
+            std::cout << "[" << jobIndex + 1 << "/" << jobs.size() << "] " << job.output
+                      << " (" << width << "x" << height << ", " << ms << " ms)" << std::endl;
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - batchStart).count();
+        std::cout << "Rendered " << jobs.size() - failures << "/" << jobs.size() << " jobs in "
+                  << seconds << " s" << std::endl;
+
+        ultralight.Shutdown();
+        return failures == 0 ? 0 : 2;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -10,8 +10,15 @@
 #include <iostream>
 #include <cstdio>
 #include <cstring>
+#include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <vector>
 #include <stdexcept>
 
 #include <glm/glm.hpp>
@@ -30,6 +37,11 @@
 #include "UltralightRenderer.h"
 #include "InputEvent.h"
 #include "JSBridge.h"
+#include "FrameScheduler.h"
+#include "DynamicResolution.h"
+#include "LayerCompositor.h"
+#include "FrameCapture.h"
+#include "VideoRecorder.h"
 
 static constexpr uint32_t INITIAL_WINDOW_WIDTH = 1280;
 static constexpr uint32_t INITIAL_WINDOW_HEIGHT = 720;
@@ -37,6 +49,11 @@ static constexpr uint32_t INITIAL_WINDOW_HEIGHT = 720;
 static glm::vec3 g_Rotation = glm::vec3(0.0f);
 static PrimitiveType g_PrimitiveType = PrimitiveType::Cube;
 static bool g_PrimitiveChanged = false;
+static bool g_ComponentChanged = true;
+// Set by setGeometry, which returns a result and so runs on the JS thread;
+// uploaded by the main loop
+static std::mutex g_GeometryMutex;
+static std::optional<Mesh> g_PendingGeometry;
 
 void CheckGLError(const char* location)
 {
@@ -45,15 +62,18 @@ void CheckGLError(const char* location)
         std::cerr << "OpenGL Error at " << location << ": " << error << std::endl;
 }
 
-int main(void)
+int main(int argc, char** argv)
 {
 #ifdef _WIN32
     setvbuf(stdout, NULL, _IONBF, 0);
     setvbuf(stderr, NULL, _IONBF, 0);
 #endif
 
+    // Relative paths given on the command line refer to where we were started
+    std::filesystem::path startDirectory;
     try
     {
+        startDirectory = std::filesystem::current_path();
         std::filesystem::path exePath;
 #ifdef _WIN32
         char exePathBuf[MAX_PATH];
@@ -75,6 +95,87 @@ int main(void)
     }
     catch (...) {}
 
+    bool useGPURendering = false;
+    bool continuousRendering = false;
+    bool useWorkerThread = false;
+    std::string overlayURL;
+    std::vector<std::pair<std::string, std::string>> routes;
+    int viewPoolSize = -1;
+    std::string bundlePath = "app.bundle";
+    std::vector<std::string> fontDeclarations;
+    int swapInterval = 1;
+    double targetFrameRate = 0.0;
+    double uiRate = 0.0;
+    double componentRate = 0.0;
+    float minResolutionScale = 0.5f;
+    float maxResolutionScale = 2.0f;
+    double componentBudget = 4.0;
+    double captureRate = 0.0;
+    std::string captureDirectory = "captures";
+    std::string captureFormat = "png";
+    std::string recordOutput;
+    int recordFrameRate = 60;
+    std::string recordFormat = "y4m";
+    std::string bridgeTypesPath;
+    double bridgeStatsInterval = 0.0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--gpu") == 0)
+            useGPURendering = true;
+        else if (std::strcmp(argv[i], "--continuous") == 0)
+            continuousRendering = true;
+        else if (std::strcmp(argv[i], "--threaded") == 0)
+            useWorkerThread = true;
+        else if (std::strcmp(argv[i], "--overlay") == 0 && i + 1 < argc)
+            overlayURL = argv[++i];
+        else if (std::strcmp(argv[i], "--route") == 0 && i + 1 < argc)
+        {
+            // --route name=url
+            std::string route = argv[++i];
+            size_t separator = route.find('=');
+            if (separator != std::string::npos)
+                routes.emplace_back(route.substr(0, separator), route.substr(separator + 1));
+        }
+        else if (std::strcmp(argv[i], "--pool") == 0 && i + 1 < argc)
+            viewPoolSize = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--bundle") == 0 && i + 1 < argc)
+            bundlePath = argv[++i];
+        else if (std::strcmp(argv[i], "--no-bundle") == 0)
+            bundlePath.clear();
+        else if (std::strcmp(argv[i], "--font") == 0 && i + 1 < argc)
+            fontDeclarations.push_back(argv[++i]);
+        else if (std::strcmp(argv[i], "--no-vsync") == 0)
+            swapInterval = 0;
+        else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+            targetFrameRate = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--ui-hz") == 0 && i + 1 < argc)
+            uiRate = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--component-hz") == 0 && i + 1 < argc)
+            componentRate = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--min-scale") == 0 && i + 1 < argc)
+            minResolutionScale = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--max-scale") == 0 && i + 1 < argc)
+            maxResolutionScale = static_cast<float>(std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--component-budget") == 0 && i + 1 < argc)
+            componentBudget = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--capture-hz") == 0 && i + 1 < argc)
+            captureRate = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--capture-dir") == 0 && i + 1 < argc)
+            captureDirectory = argv[++i];
+        else if (std::strcmp(argv[i], "--capture-format") == 0 && i + 1 < argc)
+            captureFormat = argv[++i];
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            recordOutput = argv[++i];
+        else if (std::strcmp(argv[i], "--record-fps") == 0 && i + 1 < argc)
+            recordFrameRate = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--record-format") == 0 && i + 1 < argc)
+            recordFormat = argv[++i];
+        else if (std::strcmp(argv[i], "--write-bridge-types") == 0 && i + 1 < argc)
+            bridgeTypesPath = argv[++i];
+        else if (std::strcmp(argv[i], "--bridge-stats") == 0 && i + 1 < argc)
+            bridgeStatsInterval = std::atof(argv[++i]);
+    }
+
     try
     {
         if (!glfwInit())
@@ -129,9 +230,57 @@ int main(void)
 
         Shader textureShader("assets/TextureShader.vert", "assets/TextureShader.frag");
 
+        FrameScheduler scheduler;
+        scheduler.SetMode(continuousRendering ? FrameScheduler::Mode::Continuous : FrameScheduler::Mode::OnDemand);
+        scheduler.SetSwapInterval(swapInterval);
+        scheduler.SetTargetFrameRate(targetFrameRate);
+        scheduler.SetStageRate(FrameScheduler::Stage::Component, componentRate);
+
         UltralightRenderer ultralight;
+        ultralight.EnableGLSurfaces(!useWorkerThread);
+        ultralight.EnableGPURendering(useGPURendering && !useWorkerThread);
+        ultralight.EnableWorkerThread(useWorkerThread);
+        if (!bundlePath.empty() && std::filesystem::exists(bundlePath))
+            ultralight.SetBundlePath(bundlePath);
+        for (const std::string& font : fontDeclarations)
+        {
+            // --font family[:weight[i]][=path]
+            size_t pathSeparator = font.find('=');
+            std::string face = font.substr(0, pathSeparator);
+            std::string path = pathSeparator != std::string::npos ? font.substr(pathSeparator + 1) : "";
+            size_t weightSeparator = face.find(':');
+            int weight = 400;
+            bool italic = false;
+            if (weightSeparator != std::string::npos)
+            {
+                std::string style = face.substr(weightSeparator + 1);
+                italic = !style.empty() && style.back() == 'i';
+                weight = std::atoi(style.c_str());
+                if (weight <= 0)
+                    weight = 400;
+                face.resize(weightSeparator);
+            }
+            ultralight.DeclareFont(face, weight, italic, path);
+        }
+        // Wakes the loop for finished worker frames, bridge calls and async
+        // bridge results
+        ultralight.SetFrameReadyCallback([&scheduler]()
+        {
+            scheduler.RequestFrame();
+        });
+        if (useWorkerThread)
+        {
+            // The worker keeps its own cadence; the main thread only has to
+            // drain bridge calls and pick up finished frames.
+            ultralight.SetWorkerTickRate(uiRate > 0.0 ? uiRate : 60.0);
+        }
+        else
+        {
+            scheduler.SetStageRate(FrameScheduler::Stage::UI, uiRate);
+        }
         InputEventHandler inputHandler;
         Texture ultralightTexture(windowWidth, windowHeight, nullptr, GL_RGBA8, GL_BGRA);
+        ultralightTexture.EnableStreaming(3);
 
         if (!ultralight.Initialize(windowWidth, windowHeight))
         {
@@ -139,73 +288,267 @@ int main(void)
             return -1;
         }
 
+        // Written by the page on every slider tick, read once per wake-up
+        std::shared_ptr<SharedBlock> rotationBlock;
         if (auto* bridge = ultralight.GetJSBridge())
         {
-            bridge->Register("setRotation", [](const JSArgs& args) -> JSValue {
-                auto x = JSBridge::GetArg<float>(args, 0);
-                auto y = JSBridge::GetArg<float>(args, 1);
-                auto z = JSBridge::GetArg<float>(args, 2);
-                
-                if (x && y && z)
-                    g_Rotation = glm::vec3(*x, *y, *z);
-                
-                return nullptr;
+            bridge->SetProfiling(bridgeStatsInterval > 0.0);
+
+            rotationBlock = bridge->CreateSharedBlock("rotation", {
+                { "x", SharedBlock::FieldType::Float32 },
+                { "y", SharedBlock::FieldType::Float32 },
+                { "z", SharedBlock::FieldType::Float32 },
             });
-            
-            bridge->Register("setPrimitive", [](const JSArgs& args) -> JSValue {
-                auto type = JSBridge::GetArg<std::string>(args, 0);
-                
-                if (type)
+
+            bridge->Register("setRotation", [](float x, float y, float z) {
+                g_Rotation = glm::vec3(x, y, z);
+                g_ComponentChanged = true;
+            }, { "x", "y", "z" });
+
+            bridge->Register("setPrimitive", [](const std::string& type) {
+                PrimitiveType newType = StringToPrimitiveType(type);
+                if (newType != g_PrimitiveType)
                 {
-                    PrimitiveType newType = StringToPrimitiveType(*type);
-                    if (newType != g_PrimitiveType)
-                    {
-                        g_PrimitiveType = newType;
-                        g_PrimitiveChanged = true;
-                    }
+                    g_PrimitiveType = newType;
+                    g_PrimitiveChanged = true;
+                    g_ComponentChanged = true;
+                }
+            }, { R"(type: "cube" | "pyramid" | "cylinder" | "cone")" });
+
+            // Custom mesh from JS: a Float32Array of interleaved position,
+            // color and texCoord (8 floats per vertex) and a Uint32Array of
+            // triangle indices. Validated and copied here, uploaded by the
+            // main loop.
+            bridge->Register("setGeometry", [](const JSFloat32Array& vertices, const JSUint32Array& indices) {
+                if (vertices.size % sizeof(Vertex) != 0)
+                    return false;
+
+                size_t vertexCount = vertices.Count<Vertex>();
+                size_t indexCount = indices.Count<uint32_t>();
+                if (vertexCount == 0 || indexCount == 0 || indexCount % 3 != 0 || vertexCount > UINT32_MAX)
+                    return false;
+
+                const uint32_t* indexData = indices.As<uint32_t>();
+                for (size_t i = 0; i < indexCount; i++)
+                {
+                    if (indexData[i] >= vertexCount)
+                        return false;
                 }
-                
-                return nullptr;
-            });
 
-            bridge->Register("print", [](const JSArgs& args) -> JSValue {
-                auto message = JSBridge::GetArg<std::string>(args, 0);
-                if (message)
-                    std::cout << "JS: " << *message << std::endl;
-                return nullptr;
-            });
+                Mesh mesh;
+                mesh.vertices.assign(vertices.As<Vertex>(), vertices.As<Vertex>() + vertexCount);
+                mesh.indices.assign(indexData, indexData + indexCount);
+                std::lock_guard<std::mutex> lock(g_GeometryMutex);
+                g_PendingGeometry = std::move(mesh);
+                return true;
+            }, { "vertices", "indices" });
+
+            bridge->Register("print", [](const std::string& message) {
+                std::cout << "JS: " << message << std::endl;
+            }, { "message" });
+
+            // Reads a file under assets/ off the JS thread
+            bridge->RegisterAsync("readAsset", [](const std::string& name) {
+                std::filesystem::path path = std::filesystem::path(name).lexically_normal();
+                if (path.empty() || path.is_absolute() || *path.begin() == "..")
+                    throw std::runtime_error("Invalid asset path");
+
+                std::ifstream file("assets" / path, std::ios::binary);
+                if (!file)
+                    throw std::runtime_error("Asset not found: " + path.generic_string());
+
+                std::vector<uint8_t> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+                return JSUint8Array::FromVector(std::move(contents));
+            }, { "path" });
+
+            // Declarations for app/src/native; the window closes right away
+            if (!bridgeTypesPath.empty())
+            {
+                if (bridge->WriteTypeScript(bridgeTypesPath))
+                    std::cout << "Wrote bridge types to " << bridgeTypesPath << std::endl;
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+            }
         }
 
         inputHandler.Initialize(window, &ultralight);
         inputHandler.SetViewportRegion(0, 0, windowWidth, windowHeight);
         
-        inputHandler.SetResizeCallback([&ultralightTexture](int width, int height)
+        // Optional transparent page composited over the main UI, e.g. a HUD
+        uint32_t overlayLayer = 0;
+        if (!overlayURL.empty())
+        {
+            overlayLayer = ultralight.CreateLayer("overlay", 0, 0, windowWidth, windowHeight, 1);
+            ultralight.LoadLayerURL(overlayLayer, overlayURL);
+        }
+        LayerCompositor layerCompositor;
+
+        inputHandler.SetResizeCallback([&ultralight, &ultralightTexture, overlayLayer](int width, int height)
         {
             ultralightTexture.Resize(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+            if (overlayLayer)
+                ultralight.SetLayerRect(overlayLayer, 0, 0, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
         });
+        // Refresh, focus and other input may not dirty the page but still
+        // need a frame, so request one along with the UI stage
+        inputHandler.SetActivityCallback([&scheduler]()
+        {
+            scheduler.RequestStage(FrameScheduler::Stage::UI);
+            scheduler.RequestFrame();
+        });
+
+        ultralight.DeclareRoute("main", "file:///app/build/index.html");
+        for (const auto& [route, url] : routes)
+            ultralight.DeclareRoute(route, url);
+        if (viewPoolSize >= 0)
+            ultralight.SetViewPoolSize(static_cast<size_t>(viewPoolSize));
 
         ultralight.LoadURL("file:///app/build/index.html");
+        ultralight.PrewarmRoutes();
 
-        if (auto* view = ultralight.GetView())
-            view->Focus();
+        ultralight.SetFocus(true);
 
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         textureShader.Bind();
         int texLoc = glGetUniformLocation(textureShader.GetID(), "u_Texture");
+        int uvRectLoc = glGetUniformLocation(textureShader.GetID(), "u_UVRect");
 
         uint32_t prevCubeWidth = 0;
         uint32_t prevCubeHeight = 0;
-        constexpr float RESOLUTION_SCALE = 2.0f;
+        // Periodic screenshots, read back asynchronously and encoded off-thread
+        FrameCapture frameCapture;
+        frameCapture.SetRate(captureRate);
+        if (!captureDirectory.empty() && std::filesystem::path(captureDirectory).is_relative())
+            captureDirectory = (startDirectory / captureDirectory).string();
+        frameCapture.SetOutputDirectory(captureDirectory);
+        frameCapture.SetFormat(ImageWriter::FormatFromPath("." + captureFormat));
+        if (frameCapture.IsEnabled())
+        {
+            // Wake often enough to produce a frame for every capture
+            scheduler.SetIdleTimeout(std::min(0.25, frameCapture.GetInterval()));
+            std::cout << "Capturing " << captureRate << " frames per second to " << captureDirectory << std::endl;
+        }
+
+        // Video recording to a file, or "|command" to pipe into an encoder
+        VideoRecorder videoRecorder;
+        if (!recordOutput.empty())
+        {
+            if (recordOutput[0] != '|' && std::filesystem::path(recordOutput).is_relative())
+                recordOutput = (startDirectory / recordOutput).string();
+
+            int recordWidth, recordHeight;
+            glfwGetFramebufferSize(window, &recordWidth, &recordHeight);
+            bool recording = videoRecorder.Start(recordOutput, static_cast<uint32_t>(recordWidth),
+                                                 static_cast<uint32_t>(recordHeight),
+                                                 static_cast<uint32_t>(std::max(recordFrameRate, 1)),
+                                                 VideoRecorder::ContainerFromString(recordFormat));
+            if (recording)
+            {
+                double idleTimeout = std::min(0.25, videoRecorder.GetInterval());
+                if (frameCapture.IsEnabled())
+                    idleTimeout = std::min(idleTimeout, frameCapture.GetInterval());
+                scheduler.SetIdleTimeout(idleTimeout);
+            }
+        }
+
+        DynamicResolution cubeResolution;
+        cubeResolution.SetScaleRange(minResolutionScale, maxResolutionScale);
+        cubeResolution.SetBudget(componentBudget);
+        uint32_t cubeSlotHandle = ultralight.DeclareComponentSlot("cube");
+        uint64_t slotsVersion = 0;
+        bool componentDirty = true;
 
+        double nextBridgeStats = glfwGetTime() + bridgeStatsInterval;
         while (!glfwWindowShouldClose(window))
         {
-            const ComponentSlot* cubeSlot = ultralight.GetComponentSlot("cube");
+            scheduler.WaitForEvents();
+
+            frameCapture.Poll();
+            if (frameCapture.IsDue())
+                scheduler.RequestFrame();
+            videoRecorder.Poll();
+            if (videoRecorder.IsDue())
+                scheduler.RequestFrame();
+
+            // Printed when the loop next wakes, so an idle app reports late
+            if (bridgeStatsInterval > 0.0 && glfwGetTime() >= nextBridgeStats)
+            {
+                nextBridgeStats = glfwGetTime() + bridgeStatsInterval;
+                if (auto* bridge = ultralight.GetJSBridge())
+                    bridge->PrintStats(std::cout);
+            }
+
+            // Ultralight is ticked on every wake-up its cadence allows so JS
+            // timers keep running; a frame is only produced when something
+            // actually changed, reusing the last UI texture otherwise.
+            if (scheduler.StageDue(FrameScheduler::Stage::UI))
+            {
+                ultralight.Update();
+                ultralight.Render();
+            }
+
+            if (ultralight.IsDirty())
+                scheduler.RequestFrame();
+
+            if (rotationBlock && rotationBlock->Poll())
+            {
+                g_Rotation = glm::vec3(rotationBlock->Get<float>(0), rotationBlock->Get<float>(1),
+                                       rotationBlock->Get<float>(2));
+                g_ComponentChanged = true;
+            }
+
+            // Slots can move without the page repainting. A worker's slot
+            // changes arrive with a frame, which IsDirty() already reports.
+            if (ultralight.GetComponentSlots().version != slotsVersion)
+                scheduler.RequestFrame();
+
+            {
+                std::lock_guard<std::mutex> lock(g_GeometryMutex);
+                if (g_PendingGeometry)
+                {
+                    currentMesh = std::move(*g_PendingGeometry);
+                    g_PendingGeometry.reset();
+                    primitiveComponent.SetGeometry(currentMesh.vertices.data(),
+                                                   static_cast<uint32_t>(currentMesh.vertices.size()),
+                                                   currentMesh.indices.data(),
+                                                   static_cast<uint32_t>(currentMesh.indices.size()));
+                    g_ComponentChanged = true;
+                }
+            }
+
+            if (g_ComponentChanged)
+            {
+                g_ComponentChanged = false;
+                componentDirty = true;
+                scheduler.RequestStage(FrameScheduler::Stage::Component);
+            }
+
+            if (cubeResolution.Update())
+            {
+                componentDirty = true;
+                scheduler.RequestStage(FrameScheduler::Stage::Component);
+            }
+
+            if (!scheduler.BeginFrame())
+                continue;
+
+            // Upload first so the slots read below are the ones this UI frame
+            // was laid out with
+            if (!ultralight.IsAccelerated())
+                ultralight.UploadSurface(ultralightTexture);
+
+            // A slot that only moved reuses the last render; a new size
+            // re-renders below
+            const ComponentSlotSnapshot& slots = ultralight.GetComponentSlots();
+            slotsVersion = slots.version;
+            const ComponentSlot* cubeSlot = slots.Get(cubeSlotHandle);
+
             if (cubeSlot && cubeSlot->visible)
             {
-                uint32_t targetWidth = static_cast<uint32_t>(cubeSlot->width * RESOLUTION_SCALE);
-                uint32_t targetHeight = static_cast<uint32_t>(cubeSlot->height * RESOLUTION_SCALE);
+                float resolutionScale = cubeResolution.GetScale();
+                uint32_t targetWidth = static_cast<uint32_t>(cubeSlot->width * resolutionScale);
+                uint32_t targetHeight = static_cast<uint32_t>(cubeSlot->height * resolutionScale);
                 
                 if (targetWidth < 1)
                     targetWidth = 1;
@@ -217,6 +560,7 @@ int main(void)
                     primitiveComponent.Resize(targetWidth, targetHeight);
                     prevCubeWidth = targetWidth;
                     prevCubeHeight = targetHeight;
+                    componentDirty = true;
                 }
             }
             else if (prevCubeWidth > 0 || prevCubeHeight > 0)
@@ -235,33 +579,26 @@ int main(void)
                 g_PrimitiveChanged = false;
             }
 
-            float aspect = static_cast<float>(primitiveComponent.GetWidth()) / static_cast<float>(primitiveComponent.GetHeight());
-            glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
-            glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -3.0f));
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::rotate(model, glm::radians(g_Rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-            model = glm::rotate(model, glm::radians(g_Rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-            model = glm::rotate(model, glm::radians(g_Rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-            glm::mat4 mvp = projection * view * model;
-            primitiveComponent.SetMVP(glm::value_ptr(mvp));
-            primitiveComponent.Render();
-
-            ultralight.Update();
-            ultralight.Render();
-
-            if (ultralight.IsDirty())
+            bool componentWanted = componentDirty || scheduler.GetMode() == FrameScheduler::Mode::Continuous;
+            if (componentWanted && scheduler.StageDue(FrameScheduler::Stage::Component))
             {
-                auto* bitmap = ultralight.GetBitmap();
-                if (bitmap)
-                {
-                    void* pixels = bitmap->LockPixels();
-                    if (pixels)
-                    {
-                        ultralightTexture.UpdateData(pixels, bitmap->width(), bitmap->height());
-                        bitmap->UnlockPixels();
-                        ultralight.ClearDirty();
-                    }
-                }
+                float aspect = static_cast<float>(primitiveComponent.GetWidth()) / static_cast<float>(primitiveComponent.GetHeight());
+                glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+                glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -3.0f));
+                glm::mat4 model = glm::mat4(1.0f);
+                model = glm::rotate(model, glm::radians(g_Rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+                model = glm::rotate(model, glm::radians(g_Rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+                model = glm::rotate(model, glm::radians(g_Rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+                glm::mat4 mvp = projection * view * model;
+                primitiveComponent.SetMVP(glm::value_ptr(mvp));
+                cubeResolution.BeginSample();
+                primitiveComponent.Render();
+                cubeResolution.EndSample();
+                componentDirty = false;
+            }
+            else if (componentDirty)
+            {
+                scheduler.RequestStage(FrameScheduler::Stage::Component);
             }
 
             int currentWidth, currentHeight;
@@ -275,11 +612,22 @@ int main(void)
 
             textureShader.Bind();
 
-            ultralightTexture.Bind(0);
+            UVRect uiRect;
+            if (ultralight.IsAccelerated())
+            {
+                ultralight.BindRenderTarget(0, &uiRect);
+                ultralight.ClearDirty();
+            }
+            else
+            {
+                ultralightTexture.Bind(0);
+            }
             if (texLoc != -1)
                 glUniform1i(texLoc, 0);
+            glUniform4f(uvRectLoc, uiRect.left, uiRect.top, uiRect.right, uiRect.bottom);
             flippedQuadVAO.Bind();
             glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+            glUniform4f(uvRectLoc, 0.0f, 0.0f, 1.0f, 1.0f);
 
             if (cubeSlot && cubeSlot->visible)
             {
@@ -298,10 +646,18 @@ int main(void)
 
             glViewport(0, 0, currentWidth, currentHeight);
 
-            glfwPollEvents();
+            layerCompositor.Composite(ultralight, currentHeight);
+
+            frameCapture.CaptureIfDue(0, currentWidth, currentHeight);
+            videoRecorder.CaptureIfDue(0, currentWidth, currentHeight);
+
             glfwSwapBuffers(window);
+            scheduler.EndFrame();
         }
 
+        frameCapture.Flush();
+        videoRecorder.Stop();
+
         glfwDestroyWindow(window);
         glfwTerminate();
         return 0;